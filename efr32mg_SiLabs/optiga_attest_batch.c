@@ -0,0 +1,438 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file implements the batched attestation of sensor readings (one OPTIGA signature per Merkle root).
+*
+* \ingroup  grPAL
+* @{
+*/
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/* PSA Crypto of the Gecko SDK, used for the host side hashing */
+#include "psa/crypto.h"
+
+/* Optiga based includes */
+#include <trustx/optiga/include/optiga/pal/pal_os_timer.h>
+
+#include "optiga_attest_batch.h"
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/* domain separation of the leaves and the inner nodes, a leaf cannot be passed off as a node */
+#define OPTIGA_ATTEST_LEAF_PREFIX   0x00
+#define OPTIGA_ATTEST_NODE_PREFIX   0x01
+#define OPTIGA_ATTEST_BATCH_PREFIX  0x02
+
+/* batch_id (4 bytes) and leaf_count (2 bytes), big endian */
+#define OPTIGA_ATTEST_BATCH_HEADER_LENGTH   6
+
+#if OPTIGA_ATTEST_BATCH_MAX_LEAVES > (1 << OPTIGA_ATTEST_MAX_PROOF_DEPTH)
+#error "OPTIGA_ATTEST_BATCH_MAX_LEAVES exceeds the inclusion proof depth"
+#endif
+
+/*********************************************************************************************************************
+ * LOCAL DATA
+ *********************************************************************************************************************/
+typedef enum {
+    OPTIGA_ATTEST_CLOSED_EMPTY = 0,
+    OPTIGA_ATTEST_CLOSED_UNSIGNED,
+    OPTIGA_ATTEST_CLOSED_SIGNING,
+    OPTIGA_ATTEST_CLOSED_SIGNED
+} optiga_attest_closed_state_t;
+
+typedef struct {
+    uint32_t batch_id;
+    uint16_t count;
+    /* time of the first reading, the window starts here */
+    uint32_t first_ms;
+    uint8_t leaves[OPTIGA_ATTEST_BATCH_MAX_LEAVES][OPTIGA_ATTEST_HASH_LENGTH];
+} optiga_attest_tree_t;
+
+/* batch accepting readings */
+static optiga_attest_tree_t g_open;
+/* last closed batch, kept for the inclusion proofs */
+static optiga_attest_tree_t g_closed;
+static optiga_attest_closed_state_t g_closed_state = OPTIGA_ATTEST_CLOSED_EMPTY;
+static uint8_t g_closed_root[OPTIGA_ATTEST_HASH_LENGTH];
+
+/* scratch level of the tree, used under the lock */
+static uint8_t g_level[OPTIGA_ATTEST_BATCH_MAX_LEAVES][OPTIGA_ATTEST_HASH_LENGTH];
+
+static optiga_key_id_t g_key_id = OPTIGA_KEY_STORE_ID_E0F0;
+static uint16_t g_max_leaves = OPTIGA_ATTEST_BATCH_MAX_LEAVES;
+static uint32_t g_window_ms = 0;
+static optiga_attest_batch_handler_t g_handler = NULL;
+static void * g_handler_ctx = NULL;
+static optiga_attest_batch_stats_t g_attest_stats;
+
+static SemaphoreHandle_t xAttestMutex = NULL;
+
+/**********************************************************************************************************************
+ * LOCAL ROUTINES
+ *********************************************************************************************************************/
+static pal_status_t optiga_attest_hash(uint8_t prefix, const uint8_t * p_first, uint16_t first_length,
+                                       const uint8_t * p_second, uint16_t second_length,
+                                       uint8_t digest[OPTIGA_ATTEST_HASH_LENGTH])
+{
+    psa_hash_operation_t operation = PSA_HASH_OPERATION_INIT;
+    size_t length;
+
+    if ((psa_hash_setup(&operation, PSA_ALG_SHA_256) != PSA_SUCCESS) ||
+        (psa_hash_update(&operation, &prefix, 1) != PSA_SUCCESS) ||
+        (psa_hash_update(&operation, p_first, first_length) != PSA_SUCCESS) ||
+        ((second_length > 0) && (psa_hash_update(&operation, p_second, second_length) != PSA_SUCCESS)) ||
+        (psa_hash_finish(&operation, digest, OPTIGA_ATTEST_HASH_LENGTH, &length) != PSA_SUCCESS)) {
+        (void)psa_hash_abort(&operation);
+        return PAL_STATUS_FAILURE;
+    }
+    return PAL_STATUS_SUCCESS;
+}
+
+// Reduces the scratch level by one, an odd last node is promoted unchanged
+static pal_status_t optiga_attest_reduce(uint16_t * p_count)
+{
+    uint16_t i;
+
+    for (i = 0; (i + 1) < *p_count; i += 2) {
+        if (optiga_attest_hash(OPTIGA_ATTEST_NODE_PREFIX, g_level[i], OPTIGA_ATTEST_HASH_LENGTH,
+                               g_level[i + 1], OPTIGA_ATTEST_HASH_LENGTH, g_level[i / 2]) != PAL_STATUS_SUCCESS) {
+            return PAL_STATUS_FAILURE;
+        }
+    }
+    if (*p_count & 1) {
+        memcpy(g_level[i / 2], g_level[i], OPTIGA_ATTEST_HASH_LENGTH);
+    }
+    *p_count = (uint16_t)((*p_count + 1) / 2);
+    return PAL_STATUS_SUCCESS;
+}
+
+// Moves the open batch to the closed one and computes its root, called with the lock held
+static pal_status_t optiga_attest_close(void)
+{
+    uint16_t count = g_open.count;
+
+    if ((count == 0) || (g_closed_state == OPTIGA_ATTEST_CLOSED_UNSIGNED) ||
+        (g_closed_state == OPTIGA_ATTEST_CLOSED_SIGNING)) {
+        return PAL_STATUS_FAILURE;
+    }
+
+    memcpy(g_level, g_open.leaves, count * OPTIGA_ATTEST_HASH_LENGTH);
+    while (count > 1) {
+        if (optiga_attest_reduce(&count) != PAL_STATUS_SUCCESS) {
+            return PAL_STATUS_FAILURE;
+        }
+    }
+
+    memcpy(g_closed_root, g_level[0], OPTIGA_ATTEST_HASH_LENGTH);
+    memcpy(&g_closed, &g_open, sizeof(g_closed));
+    g_closed_state = OPTIGA_ATTEST_CLOSED_UNSIGNED;
+
+    g_open.batch_id++;
+    g_open.count = 0;
+    return PAL_STATUS_SUCCESS;
+}
+
+// Closes the open batch if it is full, or its window elapsed if check_window is set; fails if a due batch stays
+// open because the previous one is not signed yet. Called with the lock held
+static pal_status_t optiga_attest_close_due(uint8_t check_window)
+{
+    if ((g_open.count < g_max_leaves) &&
+        (!check_window || (g_open.count == 0) ||
+         ((pal_os_timer_get_time_in_milliseconds() - g_open.first_ms) < g_window_ms))) {
+        return PAL_STATUS_SUCCESS;
+    }
+    return optiga_attest_close();
+}
+
+// Signs the closed batch, the lock is not held during the OPTIGA command so that readings keep coming in
+static pal_status_t optiga_attest_sign_closed(void)
+{
+    optiga_attest_batch_t batch;
+    uint8_t digest[OPTIGA_ATTEST_HASH_LENGTH];
+    optiga_lib_status_t status;
+
+    xSemaphoreTake(xAttestMutex, portMAX_DELAY);
+    if (g_closed_state != OPTIGA_ATTEST_CLOSED_UNSIGNED) {
+        xSemaphoreGive(xAttestMutex);
+        return PAL_STATUS_FAILURE;
+    }
+    g_closed_state = OPTIGA_ATTEST_CLOSED_SIGNING;
+    batch.batch_id = g_closed.batch_id;
+    batch.leaf_count = g_closed.count;
+    memcpy(batch.root, g_closed_root, OPTIGA_ATTEST_HASH_LENGTH);
+    xSemaphoreGive(xAttestMutex);
+
+    batch.signature_length = sizeof(batch.signature);
+    if (optiga_attest_batch_signed_digest(&batch, digest) != PAL_STATUS_SUCCESS) {
+        status = OPTIGA_LIB_ERROR;
+    } else {
+        status = optiga_crypt_ecdsa_sign(digest, OPTIGA_ATTEST_HASH_LENGTH, g_key_id, batch.signature,
+                                         &batch.signature_length);
+    }
+
+    xSemaphoreTake(xAttestMutex, portMAX_DELAY);
+    if (status == OPTIGA_LIB_SUCCESS) {
+        g_closed_state = OPTIGA_ATTEST_CLOSED_SIGNED;
+        g_attest_stats.batches_signed++;
+    } else {
+        /* retried by the next process call */
+        g_closed_state = OPTIGA_ATTEST_CLOSED_UNSIGNED;
+        g_attest_stats.sign_errors++;
+    }
+    xSemaphoreGive(xAttestMutex);
+
+    if (status != OPTIGA_LIB_SUCCESS) {
+        return PAL_STATUS_FAILURE;
+    }
+    if (g_handler != NULL) {
+        g_handler(&batch, g_handler_ctx);
+    }
+    return PAL_STATUS_SUCCESS;
+}
+
+/**********************************************************************************************************************
+ * API IMPLEMENTATION
+ *********************************************************************************************************************/
+pal_status_t optiga_attest_batch_init(optiga_key_id_t key_id, uint16_t max_leaves, uint32_t window_ms,
+                                      optiga_attest_batch_handler_t handler, void * p_ctx)
+{
+    if ((max_leaves == 0) || (max_leaves > OPTIGA_ATTEST_BATCH_MAX_LEAVES)) {
+        return PAL_STATUS_FAILURE;
+    }
+
+    if (xAttestMutex == NULL) {
+        xAttestMutex = xSemaphoreCreateMutex();
+        if (xAttestMutex == NULL) {
+            return PAL_STATUS_FAILURE;
+        }
+    }
+
+    xSemaphoreTake(xAttestMutex, portMAX_DELAY);
+    g_key_id = key_id;
+    g_max_leaves = max_leaves;
+    g_window_ms = window_ms;
+    g_handler = handler;
+    g_handler_ctx = p_ctx;
+    memset(&g_open, 0, sizeof(g_open));
+    memset(&g_attest_stats, 0, sizeof(g_attest_stats));
+    g_closed_state = OPTIGA_ATTEST_CLOSED_EMPTY;
+    xSemaphoreGive(xAttestMutex);
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t optiga_attest_batch_add(const uint8_t * p_reading, uint16_t length, uint32_t * p_batch_id,
+                                     uint16_t * p_leaf_index)
+{
+    uint8_t leaf[OPTIGA_ATTEST_HASH_LENGTH];
+    uint32_t batch_id;
+    uint8_t closed;
+
+    if (optiga_attest_hash(OPTIGA_ATTEST_LEAF_PREFIX, p_reading, length, NULL, 0, leaf) != PAL_STATUS_SUCCESS) {
+        return PAL_STATUS_FAILURE;
+    }
+
+    xSemaphoreTake(xAttestMutex, portMAX_DELAY);
+    batch_id = g_open.batch_id;
+    if (optiga_attest_close_due(0) != PAL_STATUS_SUCCESS) {
+        /* the open batch filled up while the previous one was unsigned, sign it and close the open one now */
+        xSemaphoreGive(xAttestMutex);
+        (void)optiga_attest_sign_closed();
+        xSemaphoreTake(xAttestMutex, portMAX_DELAY);
+        if (optiga_attest_close_due(0) != PAL_STATUS_SUCCESS) {
+            g_attest_stats.readings_rejected++;
+            xSemaphoreGive(xAttestMutex);
+            return PAL_STATUS_FAILURE;
+        }
+    }
+
+    if (g_open.count == 0) {
+        g_open.first_ms = pal_os_timer_get_time_in_milliseconds();
+    }
+    memcpy(g_open.leaves[g_open.count], leaf, OPTIGA_ATTEST_HASH_LENGTH);
+    if (p_batch_id != NULL) {
+        *p_batch_id = g_open.batch_id;
+    }
+    if (p_leaf_index != NULL) {
+        *p_leaf_index = g_open.count;
+    }
+    g_open.count++;
+    g_attest_stats.readings++;
+
+    (void)optiga_attest_close_due(0);
+    /* this call closed a batch, before or after adding the reading */
+    closed = (g_open.batch_id != batch_id);
+    xSemaphoreGive(xAttestMutex);
+
+    if (closed) {
+        (void)optiga_attest_sign_closed();
+    }
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t optiga_attest_batch_process(void)
+{
+    pal_status_t status;
+    pal_status_t closed;
+    uint8_t sign;
+
+    xSemaphoreTake(xAttestMutex, portMAX_DELAY);
+    closed = optiga_attest_close_due(1);
+    xSemaphoreGive(xAttestMutex);
+
+    status = optiga_attest_sign_closed();
+    if ((closed != PAL_STATUS_SUCCESS) && (status == PAL_STATUS_SUCCESS)) {
+        /* the previous batch is signed now, the due one can follow */
+        xSemaphoreTake(xAttestMutex, portMAX_DELAY);
+        closed = optiga_attest_close_due(1);
+        sign = (g_closed_state == OPTIGA_ATTEST_CLOSED_UNSIGNED);
+        xSemaphoreGive(xAttestMutex);
+        if ((closed == PAL_STATUS_SUCCESS) && sign) {
+            status = optiga_attest_sign_closed();
+        }
+    }
+    return status;
+}
+
+pal_status_t optiga_attest_batch_idle_job(void* job_ctx)
+{
+    (void)job_ctx;
+    return optiga_attest_batch_process();
+}
+
+pal_status_t optiga_attest_batch_flush(void)
+{
+    xSemaphoreTake(xAttestMutex, portMAX_DELAY);
+    (void)optiga_attest_close();
+    xSemaphoreGive(xAttestMutex);
+
+    return optiga_attest_sign_closed();
+}
+
+pal_status_t optiga_attest_batch_proof(uint32_t batch_id, uint16_t leaf_index, optiga_attest_proof_t * p_proof)
+{
+    pal_status_t status = PAL_STATUS_SUCCESS;
+    uint16_t count;
+    uint16_t index = leaf_index;
+    uint16_t sibling;
+
+    xSemaphoreTake(xAttestMutex, portMAX_DELAY);
+    if ((g_closed_state == OPTIGA_ATTEST_CLOSED_EMPTY) || (g_closed.batch_id != batch_id) ||
+        (leaf_index >= g_closed.count)) {
+        xSemaphoreGive(xAttestMutex);
+        return PAL_STATUS_FAILURE;
+    }
+
+    p_proof->batch_id = batch_id;
+    p_proof->leaf_index = leaf_index;
+    p_proof->depth = 0;
+    p_proof->left_mask = 0;
+
+    count = g_closed.count;
+    memcpy(g_level, g_closed.leaves, count * OPTIGA_ATTEST_HASH_LENGTH);
+    while ((count > 1) && (status == PAL_STATUS_SUCCESS)) {
+        sibling = index ^ 1;
+        /* a promoted node has no sibling on this level */
+        if (sibling < count) {
+            memcpy(p_proof->siblings[p_proof->depth], g_level[sibling], OPTIGA_ATTEST_HASH_LENGTH);
+            if (sibling < index) {
+                p_proof->left_mask |= (uint8_t)(1 << p_proof->depth);
+            }
+            p_proof->depth++;
+        }
+        status = optiga_attest_reduce(&count);
+        index /= 2;
+    }
+
+    if (status == PAL_STATUS_SUCCESS) {
+        g_attest_stats.proofs++;
+    }
+    xSemaphoreGive(xAttestMutex);
+    return status;
+}
+
+pal_status_t optiga_attest_batch_root_from_proof(const uint8_t * p_reading, uint16_t length,
+                                                 const optiga_attest_proof_t * p_proof,
+                                                 uint8_t root[OPTIGA_ATTEST_HASH_LENGTH])
+{
+    uint8_t node[OPTIGA_ATTEST_HASH_LENGTH];
+    uint8_t i;
+
+    if ((p_proof->depth > OPTIGA_ATTEST_MAX_PROOF_DEPTH) ||
+        (optiga_attest_hash(OPTIGA_ATTEST_LEAF_PREFIX, p_reading, length, NULL, 0, node) != PAL_STATUS_SUCCESS)) {
+        return PAL_STATUS_FAILURE;
+    }
+
+    for (i = 0; i < p_proof->depth; i++) {
+        if (p_proof->left_mask & (1 << i)) {
+            if (optiga_attest_hash(OPTIGA_ATTEST_NODE_PREFIX, p_proof->siblings[i], OPTIGA_ATTEST_HASH_LENGTH,
+                                   node, OPTIGA_ATTEST_HASH_LENGTH, node) != PAL_STATUS_SUCCESS) {
+                return PAL_STATUS_FAILURE;
+            }
+        } else if (optiga_attest_hash(OPTIGA_ATTEST_NODE_PREFIX, node, OPTIGA_ATTEST_HASH_LENGTH,
+                                      p_proof->siblings[i], OPTIGA_ATTEST_HASH_LENGTH, node) != PAL_STATUS_SUCCESS) {
+            return PAL_STATUS_FAILURE;
+        }
+    }
+
+    memcpy(root, node, OPTIGA_ATTEST_HASH_LENGTH);
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t optiga_attest_batch_signed_digest(const optiga_attest_batch_t * p_batch,
+                                               uint8_t digest[OPTIGA_ATTEST_HASH_LENGTH])
+{
+    uint8_t header[OPTIGA_ATTEST_BATCH_HEADER_LENGTH];
+
+    header[0] = (uint8_t)(p_batch->batch_id >> 24);
+    header[1] = (uint8_t)(p_batch->batch_id >> 16);
+    header[2] = (uint8_t)(p_batch->batch_id >> 8);
+    header[3] = (uint8_t)(p_batch->batch_id);
+    header[4] = (uint8_t)(p_batch->leaf_count >> 8);
+    header[5] = (uint8_t)(p_batch->leaf_count);
+
+    return optiga_attest_hash(OPTIGA_ATTEST_BATCH_PREFIX, header, sizeof(header), p_batch->root,
+                              OPTIGA_ATTEST_HASH_LENGTH, digest);
+}
+
+void optiga_attest_batch_get_stats(optiga_attest_batch_stats_t * p_stats)
+{
+    xSemaphoreTake(xAttestMutex, portMAX_DELAY);
+    *p_stats = g_attest_stats;
+    xSemaphoreGive(xAttestMutex);
+}
+
+/**
+* @}
+*/
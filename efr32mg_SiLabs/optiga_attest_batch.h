@@ -0,0 +1,190 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file declares the batched attestation of sensor readings (one OPTIGA signature per Merkle root).
+*
+* \ingroup  grPAL
+* @{
+*/
+
+#ifndef _OPTIGA_ATTEST_BATCH_H_
+#define _OPTIGA_ATTEST_BATCH_H_
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <trustx/optiga/include/optiga/optiga_crypt.h>
+#include <trustx/optiga/include/optiga/pal/pal.h>
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/// Maximum number of readings per batch
+#ifndef OPTIGA_ATTEST_BATCH_MAX_LEAVES
+#define OPTIGA_ATTEST_BATCH_MAX_LEAVES      32
+#endif
+
+/// Length of the tree hashes (SHA-256)
+#define OPTIGA_ATTEST_HASH_LENGTH           32
+
+/// Maximum length of the DER encoded ECDSA signature (NIST P-256)
+#define OPTIGA_ATTEST_SIGNATURE_MAX_LENGTH  72
+
+/// Maximum number of sibling hashes in an inclusion proof
+#define OPTIGA_ATTEST_MAX_PROOF_DEPTH       8
+
+/**********************************************************************************************************************
+ * ENUMS / STRUCTURES
+ *********************************************************************************************************************/
+/**
+ * Signed batch.<br>
+ * The signature covers SHA-256(0x02 || batch_id || leaf_count || root), with batch_id as 4 and leaf_count as 2 bytes
+ * big endian, see #optiga_attest_batch_signed_digest. A verifier thus detects reordered, replayed or truncated batches.
+ * The leaves are SHA-256(0x00 || reading) and the inner nodes SHA-256(0x01 || left || right).
+ */
+typedef struct optiga_attest_batch {
+    /// Sequence number of the batch
+    uint32_t batch_id;
+    /// Number of readings in the batch
+    uint16_t leaf_count;
+    /// Merkle root of the readings
+    uint8_t root[OPTIGA_ATTEST_HASH_LENGTH];
+    /// DER encoded ECDSA signature of the batch digest as returned by OPTIGA
+    uint8_t signature[OPTIGA_ATTEST_SIGNATURE_MAX_LENGTH];
+    uint16_t signature_length;
+} optiga_attest_batch_t;
+
+/// Inclusion proof of a reading
+typedef struct optiga_attest_proof {
+    uint32_t batch_id;
+    uint16_t leaf_index;
+    /// Number of sibling hashes, from the leaf level up
+    uint8_t depth;
+    /// Bit n is set if the sibling at level n is the left operand
+    uint8_t left_mask;
+    uint8_t siblings[OPTIGA_ATTEST_MAX_PROOF_DEPTH][OPTIGA_ATTEST_HASH_LENGTH];
+} optiga_attest_proof_t;
+
+/// Batching statistics
+typedef struct optiga_attest_batch_stats {
+    /// Readings added
+    uint32_t readings;
+    /// Readings rejected because the previous batch could not be signed yet
+    uint32_t readings_rejected;
+    /// Batches signed by OPTIGA
+    uint32_t batches_signed;
+    /// Failed signature attempts, the batch is retried
+    uint32_t sign_errors;
+    /// Inclusion proofs generated
+    uint32_t proofs;
+} optiga_attest_batch_stats_t;
+
+/// Called with each signed batch, from the task closing the batch
+typedef void (*optiga_attest_batch_handler_t)(const optiga_attest_batch_t * p_batch, void * p_ctx);
+
+/**********************************************************************************************************************
+ * API PROTOTYPES
+ *********************************************************************************************************************/
+/**
+ * Initializes the batching pipeline.
+ *
+ * \param[in] key_id        OPTIGA key used to sign the roots
+ * \param[in] max_leaves    Number of readings after which a batch is closed, at most #OPTIGA_ATTEST_BATCH_MAX_LEAVES
+ * \param[in] window_ms     Maximum time a reading waits for its batch to be signed
+ * \param[in] handler       Receives the signed batches
+ * \param[in] p_ctx         Handler argument
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the pipeline is initialized
+ * \retval  #PAL_STATUS_FAILURE  Returns on invalid arguments or when the lock cannot be created
+ */
+pal_status_t optiga_attest_batch_init(optiga_key_id_t key_id, uint16_t max_leaves, uint32_t window_ms,
+                                      optiga_attest_batch_handler_t handler, void * p_ctx);
+
+/**
+ * Hashes a reading into the current batch. The batch is closed and signed when it is full, so the call then issues
+ * an OPTIGA command from the calling task.<br>
+ * The readings added while a batch is being signed go into the next batch. If that one fills up before the previous
+ * batch is signed, the previous batch is signed first and the full one closed; the reading is only rejected if the
+ * previous batch still cannot be signed.
+ *
+ * \param[in]  p_reading        Reading to attest
+ * \param[in]  length           Length of the reading
+ * \param[out] p_batch_id       Batch the reading belongs to, may be NULL
+ * \param[out] p_leaf_index     Position of the reading in the batch, may be NULL
+ */
+pal_status_t optiga_attest_batch_add(const uint8_t * p_reading, uint16_t length, uint32_t * p_batch_id,
+                                     uint16_t * p_leaf_index);
+
+/**
+ * Closes the current batch if it is full or its window has elapsed and signs the closed batch.<br>
+ * Must be called periodically from a task context which is allowed to issue OPTIGA commands.
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when a batch was signed
+ * \retval  #PAL_STATUS_FAILURE  Returns when there was nothing to sign or the signature failed
+ */
+pal_status_t optiga_attest_batch_process(void);
+
+/**
+ * Idle scheduler job calling #optiga_attest_batch_process. See #pal_os_idle_register.
+ */
+pal_status_t optiga_attest_batch_idle_job(void* job_ctx);
+
+/**
+ * Closes and signs the current batch regardless of its window.
+ */
+pal_status_t optiga_attest_batch_flush(void);
+
+/**
+ * Generates the inclusion proof of a reading of the most recently signed batch.
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the proof is generated
+ * \retval  #PAL_STATUS_FAILURE  Returns when the batch is no longer available or the index is out of range
+ */
+pal_status_t optiga_attest_batch_proof(uint32_t batch_id, uint16_t leaf_index, optiga_attest_proof_t * p_proof);
+
+/**
+ * Recomputes the root from a reading and its proof, for the verifying side or for self tests.
+ */
+pal_status_t optiga_attest_batch_root_from_proof(const uint8_t * p_reading, uint16_t length,
+                                                 const optiga_attest_proof_t * p_proof,
+                                                 uint8_t root[OPTIGA_ATTEST_HASH_LENGTH]);
+
+/**
+ * Computes the digest signed for the batch from its batch_id, leaf_count and root, for the verifying side.
+ */
+pal_status_t optiga_attest_batch_signed_digest(const optiga_attest_batch_t * p_batch,
+                                               uint8_t digest[OPTIGA_ATTEST_HASH_LENGTH]);
+
+/**
+ * Returns a snapshot of the batching statistics.
+ */
+void optiga_attest_batch_get_stats(optiga_attest_batch_stats_t * p_stats);
+
+#endif /* _OPTIGA_ATTEST_BATCH_H_ */
+
+/**
+* @}
+*/
@@ -0,0 +1,460 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file implements the RAM cache for read-only OPTIGA data objects and metadata.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/* Optiga based includes */
+#include <trustx/optiga/include/optiga/optiga_util.h>
+
+#include "pal_efr32.h"
+#include "optiga_cache.h"
+#include "optiga_cache_nvm.h"
+#include "optiga_verify_cache.h"
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+#define OPTIGA_CACHE_OID_DEVICE_CERT    0xE0E0
+#define OPTIGA_CACHE_OID_TRUST_ANCHOR   0xE0E8
+#define OPTIGA_CACHE_OID_UID            0xE0C2
+
+/*********************************************************************************************************************
+ * LOCAL DATA
+ *********************************************************************************************************************/
+/* cached object, the data is stored in the arena at offset */
+typedef struct {
+    uint16_t oid;
+    /* OPTIGA_CACHE_DATA or OPTIGA_CACHE_METADATA, 0 for a free slot */
+    uint8_t  kind;
+    uint16_t offset;
+    uint16_t length;
+    uint32_t last_used;
+} optiga_cache_entry_t;
+
+/* cacheability declaration of an OID */
+typedef struct {
+    uint16_t oid;
+    uint8_t  flags;
+} optiga_cache_policy_t;
+
+static uint8_t g_arena[OPTIGA_CACHE_SIZE];
+static uint16_t g_arena_used = 0;
+static optiga_cache_entry_t g_entries[OPTIGA_CACHE_MAX_ENTRIES];
+static optiga_cache_policy_t g_policies[OPTIGA_CACHE_MAX_POLICIES];
+static uint32_t g_use_counter = 0;
+static optiga_cache_stats_t g_stats;
+
+static SemaphoreHandle_t xCacheMutex = NULL;
+
+/* Incremented from the reset listener, the cache is flushed lazily by the next caller */
+static volatile uint32_t g_reset_generation = 0;
+static uint32_t g_cache_generation = 0;
+
+/**********************************************************************************************************************
+ * LOCAL ROUTINES
+ *********************************************************************************************************************/
+// Returns the cacheability flags of the OID
+static uint8_t optiga_cache_policy(uint16_t optiga_oid)
+{
+    uint8_t i;
+
+    for (i = 0; i < OPTIGA_CACHE_MAX_POLICIES; i++) {
+        if ((g_policies[i].flags != 0) && (g_policies[i].oid == optiga_oid)) {
+            return g_policies[i].flags;
+        }
+    }
+    return 0;
+}
+
+static optiga_cache_entry_t * optiga_cache_lookup(uint16_t optiga_oid, uint8_t kind)
+{
+    uint8_t i;
+
+    for (i = 0; i < OPTIGA_CACHE_MAX_ENTRIES; i++) {
+        if ((g_entries[i].kind == kind) && (g_entries[i].oid == optiga_oid)) {
+            return &g_entries[i];
+        }
+    }
+    return NULL;
+}
+
+// Frees the entry and compacts the arena
+static void optiga_cache_remove(optiga_cache_entry_t * p_entry)
+{
+    uint16_t end = p_entry->offset + p_entry->length;
+    uint8_t i;
+
+    memmove(&g_arena[p_entry->offset], &g_arena[end], g_arena_used - end);
+    g_arena_used -= p_entry->length;
+
+    for (i = 0; i < OPTIGA_CACHE_MAX_ENTRIES; i++) {
+        if ((g_entries[i].kind != 0) && (g_entries[i].offset >= end)) {
+            g_entries[i].offset -= p_entry->length;
+        }
+    }
+    p_entry->kind = 0;
+}
+
+static void optiga_cache_evict_lru(void)
+{
+    optiga_cache_entry_t * p_lru = NULL;
+    uint8_t i;
+
+    for (i = 0; i < OPTIGA_CACHE_MAX_ENTRIES; i++) {
+        if ((g_entries[i].kind != 0) && ((p_lru == NULL) || (g_entries[i].last_used < p_lru->last_used))) {
+            p_lru = &g_entries[i];
+        }
+    }
+    if (p_lru != NULL) {
+        optiga_cache_remove(p_lru);
+        g_stats.evictions++;
+    }
+}
+
+// Stores a copy of the object, evicting the least recently used entries if required
+static void optiga_cache_store(uint16_t optiga_oid, uint8_t kind, const uint8_t * p_data, uint16_t length)
+{
+    optiga_cache_entry_t * p_entry;
+    uint8_t i;
+
+    if (length > OPTIGA_CACHE_SIZE) {
+        return;
+    }
+
+    p_entry = optiga_cache_lookup(optiga_oid, kind);
+    if (p_entry != NULL) {
+        optiga_cache_remove(p_entry);
+    }
+
+    while ((OPTIGA_CACHE_SIZE - g_arena_used) < length) {
+        optiga_cache_evict_lru();
+    }
+
+    p_entry = NULL;
+    while (p_entry == NULL) {
+        for (i = 0; i < OPTIGA_CACHE_MAX_ENTRIES; i++) {
+            if (g_entries[i].kind == 0) {
+                p_entry = &g_entries[i];
+                break;
+            }
+        }
+        if (p_entry == NULL) {
+            optiga_cache_evict_lru();
+        }
+    }
+
+    p_entry->oid = optiga_oid;
+    p_entry->kind = kind;
+    p_entry->offset = g_arena_used;
+    p_entry->length = length;
+    p_entry->last_used = ++g_use_counter;
+    memcpy(&g_arena[g_arena_used], p_data, length);
+    g_arena_used += length;
+}
+
+static void optiga_cache_drop(uint16_t optiga_oid)
+{
+    optiga_cache_entry_t * p_entry;
+
+    p_entry = optiga_cache_lookup(optiga_oid, OPTIGA_CACHE_DATA);
+    if (p_entry != NULL) {
+        optiga_cache_remove(p_entry);
+        g_stats.invalidations++;
+    }
+    p_entry = optiga_cache_lookup(optiga_oid, OPTIGA_CACHE_METADATA);
+    if (p_entry != NULL) {
+        optiga_cache_remove(p_entry);
+        g_stats.invalidations++;
+    }
+}
+
+static void optiga_cache_drop_all(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < OPTIGA_CACHE_MAX_ENTRIES; i++) {
+        if (g_entries[i].kind != 0) {
+            g_entries[i].kind = 0;
+            g_stats.invalidations++;
+        }
+    }
+    g_arena_used = 0;
+}
+
+static void optiga_cache_lock(void)
+{
+    xSemaphoreTake(xCacheMutex, portMAX_DELAY);
+    if (g_cache_generation != g_reset_generation) {
+        g_cache_generation = g_reset_generation;
+        optiga_cache_drop_all();
+    }
+}
+
+static void optiga_cache_unlock(void)
+{
+    xSemaphoreGive(xCacheMutex);
+}
+
+// Reset listener, runs in the context driving the reset pin and therefore must not take the cache lock
+static void optiga_cache_on_reset(void* p_ctx)
+{
+    (void)p_ctx;
+    g_reset_generation++;
+}
+
+// Serves a read from a cached entry
+static void optiga_cache_serve(optiga_cache_entry_t * p_entry, uint16_t offset, uint8_t * buffer,
+                               uint16_t * length)
+{
+    uint16_t available = p_entry->length - offset;
+
+    if (*length > available) {
+        *length = available;
+    }
+    memcpy(buffer, &g_arena[p_entry->offset + offset], *length);
+    p_entry->last_used = ++g_use_counter;
+
+    g_stats.hits++;
+    g_stats.bytes_saved += *length;
+}
+
+/**********************************************************************************************************************
+ * API IMPLEMENTATION
+ *********************************************************************************************************************/
+pal_status_t optiga_cache_init(void)
+{
+    if (xCacheMutex == NULL) {
+        xCacheMutex = xSemaphoreCreateMutex();
+        if (xCacheMutex == NULL) {
+            return PAL_STATUS_FAILURE;
+        }
+        if (pal_gpio_register_reset_listener(optiga_cache_on_reset, NULL) != PAL_STATUS_SUCCESS) {
+            return PAL_STATUS_FAILURE;
+        }
+    }
+
+    memset(g_policies, 0, sizeof(g_policies));
+    memset(&g_stats, 0, sizeof(g_stats));
+    optiga_cache_drop_all();
+
+    g_policies[0].oid = OPTIGA_CACHE_OID_DEVICE_CERT;
+    g_policies[0].flags = OPTIGA_CACHE_DATA | OPTIGA_CACHE_METADATA;
+    g_policies[1].oid = OPTIGA_CACHE_OID_TRUST_ANCHOR;
+    g_policies[1].flags = OPTIGA_CACHE_DATA | OPTIGA_CACHE_METADATA;
+    g_policies[2].oid = OPTIGA_CACHE_OID_UID;
+    g_policies[2].flags = OPTIGA_CACHE_DATA | OPTIGA_CACHE_METADATA;
+    g_policies[3].oid = OPTIGA_CACHE_OID_LCSG;
+    g_policies[3].flags = OPTIGA_CACHE_DATA;
+
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t optiga_cache_set_policy(uint16_t optiga_oid, uint8_t flags)
+{
+    pal_status_t status = PAL_STATUS_FAILURE;
+    optiga_cache_policy_t * p_free = NULL;
+    uint8_t i;
+
+    optiga_cache_lock();
+    optiga_cache_drop(optiga_oid);
+
+    for (i = 0; i < OPTIGA_CACHE_MAX_POLICIES; i++) {
+        if ((g_policies[i].flags != 0) && (g_policies[i].oid == optiga_oid)) {
+            g_policies[i].flags = flags;
+            status = PAL_STATUS_SUCCESS;
+            break;
+        }
+        if ((g_policies[i].flags == 0) && (p_free == NULL)) {
+            p_free = &g_policies[i];
+        }
+    }
+
+    if ((status != PAL_STATUS_SUCCESS) && ((flags == 0) || (p_free != NULL))) {
+        if (flags != 0) {
+            p_free->oid = optiga_oid;
+            p_free->flags = flags;
+        }
+        status = PAL_STATUS_SUCCESS;
+    }
+
+    optiga_cache_unlock();
+    return status;
+}
+
+optiga_lib_status_t optiga_cache_read_data(uint16_t optiga_oid, uint16_t offset, uint8_t * buffer, uint16_t * length)
+{
+    optiga_lib_status_t status;
+    optiga_cache_entry_t * p_entry;
+    uint16_t requested = *length;
+
+    optiga_cache_lock();
+
+    if ((optiga_cache_policy(optiga_oid) & OPTIGA_CACHE_DATA) == 0) {
+        optiga_cache_unlock();
+        return optiga_util_read_data(optiga_oid, offset, buffer, length);
+    }
+
+    p_entry = optiga_cache_lookup(optiga_oid, OPTIGA_CACHE_DATA);
+    if ((p_entry != NULL) && (offset < p_entry->length)) {
+        optiga_cache_serve(p_entry, offset, buffer, length);
+        optiga_cache_unlock();
+        return OPTIGA_LIB_SUCCESS;
+    }
+
+    /* The lock is held during the read so that a concurrent write cannot be overtaken by a stale copy */
+    g_stats.misses++;
+    status = optiga_util_read_data(optiga_oid, offset, buffer, length);
+    if ((status == OPTIGA_LIB_SUCCESS) && (offset == 0) && (*length < requested)) {
+        /* the buffer was larger than the object, hence the object is complete */
+        optiga_cache_store(optiga_oid, OPTIGA_CACHE_DATA, buffer, *length);
+    }
+
+    optiga_cache_unlock();
+    return status;
+}
+
+optiga_lib_status_t optiga_cache_read_metadata(uint16_t optiga_oid, uint8_t * buffer, uint16_t * length)
+{
+    optiga_lib_status_t status;
+    optiga_cache_entry_t * p_entry;
+
+    optiga_cache_lock();
+
+    if ((optiga_cache_policy(optiga_oid) & OPTIGA_CACHE_METADATA) == 0) {
+        optiga_cache_unlock();
+        return optiga_util_read_metadata(optiga_oid, buffer, length);
+    }
+
+    p_entry = optiga_cache_lookup(optiga_oid, OPTIGA_CACHE_METADATA);
+    if ((p_entry != NULL) && (*length >= p_entry->length)) {
+        optiga_cache_serve(p_entry, 0, buffer, length);
+        optiga_cache_unlock();
+        return OPTIGA_LIB_SUCCESS;
+    }
+
+    g_stats.misses++;
+    status = optiga_util_read_metadata(optiga_oid, buffer, length);
+    if (status == OPTIGA_LIB_SUCCESS) {
+        optiga_cache_store(optiga_oid, OPTIGA_CACHE_METADATA, buffer, *length);
+    }
+
+    optiga_cache_unlock();
+    return status;
+}
+
+optiga_lib_status_t optiga_cache_write_data(uint16_t optiga_oid, uint8_t write_type, uint16_t offset,
+                                            uint8_t * buffer, uint16_t length)
+{
+    optiga_lib_status_t status;
+
+    optiga_cache_lock();
+    status = optiga_util_write_data(optiga_oid, write_type, offset, buffer, length);
+    /* invalidate even on failure, the object might have been partially written */
+    if (optiga_oid == OPTIGA_CACHE_OID_LCSG) {
+        optiga_cache_drop_all();
+    } else {
+        optiga_cache_drop(optiga_oid);
+    }
+    optiga_cache_unlock();
+
+    /* the flash copy is validated against the metadata only, which an update of the same size keeps */
+    optiga_cache_nvm_invalidate(optiga_oid);
+    /* verifications against a replaced trust anchor must not outlive it */
+    optiga_verify_cache_invalidate_anchor(optiga_oid);
+
+    return status;
+}
+
+optiga_lib_status_t optiga_cache_write_metadata(uint16_t optiga_oid, uint8_t * buffer, uint8_t length)
+{
+    optiga_lib_status_t status;
+
+    optiga_cache_lock();
+    status = optiga_util_write_metadata(optiga_oid, buffer, length);
+    optiga_cache_drop(optiga_oid);
+    optiga_cache_unlock();
+
+    optiga_verify_cache_invalidate_anchor(optiga_oid);
+
+    return status;
+}
+
+pal_status_t optiga_cache_insert(uint16_t optiga_oid, const uint8_t * buffer, uint16_t length)
+{
+    pal_status_t status = PAL_STATUS_FAILURE;
+
+    optiga_cache_lock();
+    if (((optiga_cache_policy(optiga_oid) & OPTIGA_CACHE_DATA) != 0) && (length <= OPTIGA_CACHE_SIZE)) {
+        optiga_cache_store(optiga_oid, OPTIGA_CACHE_DATA, buffer, length);
+        status = PAL_STATUS_SUCCESS;
+    }
+    optiga_cache_unlock();
+
+    return status;
+}
+
+void optiga_cache_invalidate(uint16_t optiga_oid)
+{
+    optiga_cache_lock();
+    optiga_cache_drop(optiga_oid);
+    optiga_cache_unlock();
+}
+
+void optiga_cache_invalidate_all(void)
+{
+    optiga_cache_lock();
+    optiga_cache_drop_all();
+    optiga_cache_unlock();
+}
+
+void optiga_cache_get_stats(optiga_cache_stats_t * p_stats)
+{
+    uint32_t reads;
+
+    optiga_cache_lock();
+    *p_stats = g_stats;
+    optiga_cache_unlock();
+
+    reads = p_stats->hits + p_stats->misses;
+    p_stats->hit_rate_percent = (reads == 0) ? 0 : (uint8_t)((p_stats->hits * 100) / reads);
+}
+
+/**
+* @}
+*/
@@ -0,0 +1,165 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file declares the RAM cache for read-only OPTIGA data objects and metadata.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+#ifndef _OPTIGA_CACHE_H_
+#define _OPTIGA_CACHE_H_
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <trustx/optiga/include/optiga/optiga_util.h>
+#include <trustx/optiga/include/optiga/pal/pal.h>
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/// Size of the cache arena in bytes
+#ifndef OPTIGA_CACHE_SIZE
+#define OPTIGA_CACHE_SIZE               2048
+#endif
+
+/// Maximum number of cached objects (data and metadata entries)
+#ifndef OPTIGA_CACHE_MAX_ENTRIES
+#define OPTIGA_CACHE_MAX_ENTRIES        8
+#endif
+
+/// Maximum number of OIDs with a cacheability declaration
+#define OPTIGA_CACHE_MAX_POLICIES       8
+
+/// The data of the object may be cached
+#define OPTIGA_CACHE_DATA               0x01
+/// The metadata of the object may be cached
+#define OPTIGA_CACHE_METADATA           0x02
+
+/// OID of the global lifecycle state, a write to it invalidates the complete cache
+#define OPTIGA_CACHE_OID_LCSG           0xE0C0
+
+/**********************************************************************************************************************
+ * ENUMS / STRUCTURES
+ *********************************************************************************************************************/
+/// Cache statistics
+typedef struct optiga_cache_stats {
+    /// Reads served from RAM
+    uint32_t hits;
+    /// Reads forwarded to OPTIGA
+    uint32_t misses;
+    /// Bytes which did not have to be transferred over I2C
+    uint32_t bytes_saved;
+    /// Entries dropped to make room for new ones
+    uint32_t evictions;
+    /// Entries dropped due to writes, lifecycle changes or resets
+    uint32_t invalidations;
+    /// hits * 100 / (hits + misses)
+    uint8_t hit_rate_percent;
+} optiga_cache_stats_t;
+
+/**********************************************************************************************************************
+ * API PROTOTYPES
+ *********************************************************************************************************************/
+/**
+ * Initializes the cache with the default cacheability declarations (device certificate, trust anchor, coprocessor
+ * UID and global lifecycle state) and registers for the OPTIGA reset notification.<br>
+ * Must be called once before any other cache API.
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the cache is initialized
+ * \retval  #PAL_STATUS_FAILURE  Returns when the cache lock cannot be created
+ */
+pal_status_t optiga_cache_init(void);
+
+/**
+ * Declares the cacheability of an OID.<br>
+ * Declaring the flags 0 removes the OID from the cache.
+ *
+ * \param[in] optiga_oid    OID of the data object
+ * \param[in] flags         Combination of #OPTIGA_CACHE_DATA and #OPTIGA_CACHE_METADATA
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the declaration is stored
+ * \retval  #PAL_STATUS_FAILURE  Returns when the declaration table is full
+ */
+pal_status_t optiga_cache_set_policy(uint16_t optiga_oid, uint8_t flags);
+
+/**
+ * Cached variant of optiga_util_read_data.<br>
+ * An object is cached once it was read completely from offset 0, i.e. with a buffer larger than the object.
+ */
+optiga_lib_status_t optiga_cache_read_data(uint16_t optiga_oid, uint16_t offset, uint8_t * buffer, uint16_t * length);
+
+/**
+ * Cached variant of optiga_util_read_metadata.
+ */
+optiga_lib_status_t optiga_cache_read_metadata(uint16_t optiga_oid, uint8_t * buffer, uint16_t * length);
+
+/**
+ * optiga_util_write_data which invalidates the cached copies of the object (RAM, flash) and, for a trust anchor,
+ * the verifications against it.
+ */
+optiga_lib_status_t optiga_cache_write_data(uint16_t optiga_oid, uint8_t write_type, uint16_t offset,
+                                            uint8_t * buffer, uint16_t length);
+
+/**
+ * optiga_util_write_metadata which invalidates the cached copies of the object and, for a trust anchor, the
+ * verifications against it.
+ */
+optiga_lib_status_t optiga_cache_write_metadata(uint16_t optiga_oid, uint8_t * buffer, uint8_t length);
+
+/**
+ * Inserts a complete object into the cache without reading it from OPTIGA, e.g. when restored from flash.
+ *
+ * \param[in] optiga_oid    OID of the data object
+ * \param[in] buffer        Object data
+ * \param[in] length        Object length
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the object is cached
+ * \retval  #PAL_STATUS_FAILURE  Returns when the OID is not cacheable or the object does not fit the cache
+ */
+pal_status_t optiga_cache_insert(uint16_t optiga_oid, const uint8_t * buffer, uint16_t length);
+
+/**
+ * Drops the cached data and metadata of the OID.
+ */
+void optiga_cache_invalidate(uint16_t optiga_oid);
+
+/**
+ * Drops all cached entries.
+ */
+void optiga_cache_invalidate_all(void);
+
+/**
+ * Returns a snapshot of the cache statistics.
+ */
+void optiga_cache_get_stats(optiga_cache_stats_t * p_stats);
+
+#endif /* _OPTIGA_CACHE_H_ */
+
+/**
+* @}
+*/
@@ -0,0 +1,338 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file implements the NVM3 backed persistence of the OPTIGA public data cache.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <string.h>
+
+#include "nvm3_default.h"
+#include "nvm3_default_config.h"
+
+/* Optiga based includes */
+#include <trustx/optiga/include/optiga/optiga_util.h>
+#include <trustx/optiga/include/optiga/pal/pal_os_timer.h>
+
+#include "optiga_cache.h"
+#include "optiga_cache_nvm.h"
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+#define OPTIGA_CACHE_OID_DEVICE_CERT    0xE0E0
+#define OPTIGA_CACHE_OID_TRUST_ANCHOR   0xE0E8
+#define OPTIGA_CACHE_OID_UID            0xE0C2
+
+/* size of the NVM3 objects a record is split into */
+#ifndef OPTIGA_CACHE_NVM_CHUNK_SIZE
+#define OPTIGA_CACHE_NVM_CHUNK_SIZE     NVM3_DEFAULT_MAX_OBJECT_SIZE
+#endif
+
+/* upper bound of the record header, see optiga_cache_nvm_record_t */
+#define OPTIGA_CACHE_NVM_HEADER_SIZE_MAX    (OPTIGA_CACHE_NVM_MAX_METADATA_SIZE + 8)
+
+#if (OPTIGA_CACHE_NVM_CHUNK_SIZE > NVM3_DEFAULT_MAX_OBJECT_SIZE)
+#error "OPTIGA_CACHE_NVM_CHUNK_SIZE exceeds the largest object of the NVM3 instance"
+#endif
+#if (OPTIGA_CACHE_NVM_CHUNK_SIZE < OPTIGA_CACHE_NVM_HEADER_SIZE_MAX)
+#error "The record header must fit into the first NVM3 object of the record"
+#endif
+#if (((OPTIGA_CACHE_NVM_HEADER_SIZE_MAX + OPTIGA_CACHE_NVM_MAX_OBJECT_SIZE + OPTIGA_CACHE_NVM_CHUNK_SIZE - 1) / \
+      OPTIGA_CACHE_NVM_CHUNK_SIZE) > OPTIGA_CACHE_NVM_KEYS_PER_OBJECT)
+#error "OPTIGA_CACHE_NVM_MAX_OBJECT_SIZE needs more NVM3 keys than OPTIGA_CACHE_NVM_KEYS_PER_OBJECT"
+#endif
+
+/* NVM3 key of a chunk of the record of the n-th persisted OID */
+#define OPTIGA_CACHE_NVM_KEY(index, chunk)  \
+    (OPTIGA_CACHE_NVM_KEY_BASE + ((nvm3_ObjectKey_t)(index) * OPTIGA_CACHE_NVM_KEYS_PER_OBJECT) + (chunk))
+
+/*********************************************************************************************************************
+ * LOCAL DATA
+ *********************************************************************************************************************/
+/* header of a persisted object, followed by the object data; the record is stored in chunks, the first is written
+ * last so that a record whose first chunk is present is complete */
+typedef struct {
+    uint16_t oid;
+    uint16_t length;
+    /* time the object took to read from OPTIGA */
+    uint16_t read_time_ms;
+    uint8_t  metadata_length;
+    uint8_t  metadata[OPTIGA_CACHE_NVM_MAX_METADATA_SIZE];
+} optiga_cache_nvm_record_t;
+
+typedef struct {
+    optiga_cache_nvm_record_t header;
+    uint8_t data[OPTIGA_CACHE_NVM_MAX_OBJECT_SIZE];
+} optiga_cache_nvm_object_t;
+
+static uint16_t g_nvm_oids[OPTIGA_CACHE_NVM_MAX_OBJECTS] = {
+    OPTIGA_CACHE_OID_DEVICE_CERT,
+    OPTIGA_CACHE_OID_TRUST_ANCHOR,
+    OPTIGA_CACHE_OID_UID,
+    0
+};
+
+/* scratch record, only used during restore */
+static optiga_cache_nvm_object_t g_nvm_object;
+static optiga_cache_nvm_stats_t g_nvm_stats;
+
+/**********************************************************************************************************************
+ * LOCAL ROUTINES
+ *********************************************************************************************************************/
+// Reads the chunk of the record at the offset, the chunk must have the expected length
+static pal_status_t optiga_cache_nvm_read_chunk(uint8_t index, size_t offset, size_t length)
+{
+    nvm3_ObjectKey_t key = OPTIGA_CACHE_NVM_KEY(index, offset / OPTIGA_CACHE_NVM_CHUNK_SIZE);
+    uint32_t type;
+    size_t chunk_length;
+
+    if ((nvm3_getObjectInfo(nvm3_defaultHandle, key, &type, &chunk_length) != ECODE_NVM3_OK) ||
+        (type != NVM3_OBJECTTYPE_DATA) || (chunk_length != length) ||
+        (nvm3_readData(nvm3_defaultHandle, key, (uint8_t *)&g_nvm_object + offset, length) != ECODE_NVM3_OK)) {
+        return PAL_STATUS_FAILURE;
+    }
+    return PAL_STATUS_SUCCESS;
+}
+
+// Reads the flash copy and validates it against the current metadata of the object
+static pal_status_t optiga_cache_nvm_load(uint8_t index, uint16_t optiga_oid,
+                                          const uint8_t * p_metadata, uint16_t metadata_length)
+{
+    uint32_t type;
+    size_t length;
+    size_t offset;
+    size_t chunk_length;
+
+    /* the first chunk holds the header, hence the length of the record */
+    if (nvm3_getObjectInfo(nvm3_defaultHandle, OPTIGA_CACHE_NVM_KEY(index, 0), &type, &chunk_length) !=
+        ECODE_NVM3_OK) {
+        return PAL_STATUS_FAILURE;
+    }
+    if ((chunk_length < sizeof(optiga_cache_nvm_record_t)) || (chunk_length > OPTIGA_CACHE_NVM_CHUNK_SIZE) ||
+        (optiga_cache_nvm_read_chunk(index, 0, chunk_length) != PAL_STATUS_SUCCESS)) {
+        return PAL_STATUS_FAILURE;
+    }
+    length = sizeof(optiga_cache_nvm_record_t) + g_nvm_object.header.length;
+    if ((length > sizeof(g_nvm_object)) ||
+        (chunk_length != ((length < OPTIGA_CACHE_NVM_CHUNK_SIZE) ? length : OPTIGA_CACHE_NVM_CHUNK_SIZE))) {
+        return PAL_STATUS_FAILURE;
+    }
+    for (offset = OPTIGA_CACHE_NVM_CHUNK_SIZE; offset < length; offset += OPTIGA_CACHE_NVM_CHUNK_SIZE) {
+        chunk_length = length - offset;
+        if (chunk_length > OPTIGA_CACHE_NVM_CHUNK_SIZE) {
+            chunk_length = OPTIGA_CACHE_NVM_CHUNK_SIZE;
+        }
+        if (optiga_cache_nvm_read_chunk(index, offset, chunk_length) != PAL_STATUS_SUCCESS) {
+            return PAL_STATUS_FAILURE;
+        }
+    }
+
+    if ((g_nvm_object.header.oid != optiga_oid) ||
+        (g_nvm_object.header.metadata_length != metadata_length) ||
+        (memcmp(g_nvm_object.header.metadata, p_metadata, metadata_length) != 0)) {
+        return PAL_STATUS_FAILURE;
+    }
+    return PAL_STATUS_SUCCESS;
+}
+
+// Writes the record of the scratch object, the first chunk last
+static pal_status_t optiga_cache_nvm_store(uint8_t index)
+{
+    size_t length = sizeof(optiga_cache_nvm_record_t) + g_nvm_object.header.length;
+    size_t offset;
+    size_t chunk_length;
+
+    /* the record is invalid until its first chunk is written again */
+    (void)nvm3_deleteObject(nvm3_defaultHandle, OPTIGA_CACHE_NVM_KEY(index, 0));
+
+    offset = ((length - 1) / OPTIGA_CACHE_NVM_CHUNK_SIZE) * OPTIGA_CACHE_NVM_CHUNK_SIZE;
+    for (;;) {
+        chunk_length = length - offset;
+        if (chunk_length > OPTIGA_CACHE_NVM_CHUNK_SIZE) {
+            chunk_length = OPTIGA_CACHE_NVM_CHUNK_SIZE;
+        }
+        if (nvm3_writeData(nvm3_defaultHandle, OPTIGA_CACHE_NVM_KEY(index, offset / OPTIGA_CACHE_NVM_CHUNK_SIZE),
+                           (uint8_t *)&g_nvm_object + offset, chunk_length) != ECODE_NVM3_OK) {
+            return PAL_STATUS_FAILURE;
+        }
+        if (offset == 0) {
+            return PAL_STATUS_SUCCESS;
+        }
+        offset -= OPTIGA_CACHE_NVM_CHUNK_SIZE;
+    }
+}
+
+// Drops the flash copies if they were read from another chip than the one answering, e.g. after a board repair
+static pal_status_t optiga_cache_nvm_check_chip(void)
+{
+    uint8_t uid[OPTIGA_CACHE_NVM_UID_SIZE];
+    uint8_t stored_uid[OPTIGA_CACHE_NVM_UID_SIZE];
+    uint16_t length = sizeof(uid);
+    uint32_t type;
+    size_t stored_length;
+    uint8_t i;
+    uint8_t chunk;
+
+    /* straight from OPTIGA, the RAM cache might hold the UID of the flash copy */
+    if (optiga_util_read_data(OPTIGA_CACHE_OID_UID, 0, uid, &length) != OPTIGA_LIB_SUCCESS) {
+        return PAL_STATUS_FAILURE;
+    }
+    if ((nvm3_getObjectInfo(nvm3_defaultHandle, OPTIGA_CACHE_NVM_UID_KEY, &type, &stored_length) == ECODE_NVM3_OK) &&
+        (type == NVM3_OBJECTTYPE_DATA) && (stored_length == length) &&
+        (nvm3_readData(nvm3_defaultHandle, OPTIGA_CACHE_NVM_UID_KEY, stored_uid, length) == ECODE_NVM3_OK) &&
+        (memcmp(stored_uid, uid, length) == 0)) {
+        return PAL_STATUS_SUCCESS;
+    }
+
+    /* the records go before the UID is written, so that a reset in between cannot bind them to the new chip */
+    for (i = 0; i < OPTIGA_CACHE_NVM_MAX_OBJECTS; i++) {
+        for (chunk = 0; chunk < OPTIGA_CACHE_NVM_KEYS_PER_OBJECT; chunk++) {
+            (void)nvm3_deleteObject(nvm3_defaultHandle, OPTIGA_CACHE_NVM_KEY(i, chunk));
+        }
+    }
+    g_nvm_stats.chip_changes++;
+    if (nvm3_writeData(nvm3_defaultHandle, OPTIGA_CACHE_NVM_UID_KEY, uid, length) != ECODE_NVM3_OK) {
+        g_nvm_stats.write_errors++;
+    }
+    return PAL_STATUS_SUCCESS;
+}
+
+// Reads the object from OPTIGA (through the RAM cache) and writes the flash copy
+static pal_status_t optiga_cache_nvm_refresh(uint8_t index, uint16_t optiga_oid,
+                                             const uint8_t * p_metadata, uint16_t metadata_length)
+{
+    uint16_t length = sizeof(g_nvm_object.data);
+    uint32_t start = pal_os_timer_get_time_in_milliseconds();
+
+    if (optiga_cache_read_data(optiga_oid, 0, g_nvm_object.data, &length) != OPTIGA_LIB_SUCCESS) {
+        return PAL_STATUS_FAILURE;
+    }
+    if (length == sizeof(g_nvm_object.data)) {
+        /* the object might be larger than the record, it stays cached in RAM only */
+        return PAL_STATUS_SUCCESS;
+    }
+
+    g_nvm_object.header.oid = optiga_oid;
+    g_nvm_object.header.length = length;
+    g_nvm_object.header.read_time_ms = (uint16_t)(pal_os_timer_get_time_in_milliseconds() - start);
+    g_nvm_object.header.metadata_length = (uint8_t)metadata_length;
+    memcpy(g_nvm_object.header.metadata, p_metadata, metadata_length);
+
+    /* a failing flash write only costs the next boot a re-read */
+    if (optiga_cache_nvm_store(index) != PAL_STATUS_SUCCESS) {
+        g_nvm_stats.write_errors++;
+    }
+    return PAL_STATUS_SUCCESS;
+}
+
+/**********************************************************************************************************************
+ * API IMPLEMENTATION
+ *********************************************************************************************************************/
+pal_status_t optiga_cache_nvm_add(uint16_t optiga_oid)
+{
+    uint8_t i;
+
+    for (i = 0; i < OPTIGA_CACHE_NVM_MAX_OBJECTS; i++) {
+        if ((g_nvm_oids[i] == optiga_oid) || (g_nvm_oids[i] == 0)) {
+            g_nvm_oids[i] = optiga_oid;
+            return PAL_STATUS_SUCCESS;
+        }
+    }
+    return PAL_STATUS_FAILURE;
+}
+
+pal_status_t optiga_cache_nvm_restore(void)
+{
+    pal_status_t status = PAL_STATUS_SUCCESS;
+    uint8_t metadata[OPTIGA_CACHE_NVM_MAX_METADATA_SIZE];
+    uint16_t metadata_length;
+    uint32_t start = pal_os_timer_get_time_in_milliseconds();
+    uint8_t i;
+
+    memset(&g_nvm_stats, 0, sizeof(g_nvm_stats));
+
+    if (optiga_cache_nvm_check_chip() != PAL_STATUS_SUCCESS) {
+        /* the flash copies cannot be trusted, the objects are read from OPTIGA on demand */
+        g_nvm_stats.restore_time_ms = pal_os_timer_get_time_in_milliseconds() - start;
+        return PAL_STATUS_FAILURE;
+    }
+
+    for (i = 0; i < OPTIGA_CACHE_NVM_MAX_OBJECTS; i++) {
+        if (g_nvm_oids[i] == 0) {
+            continue;
+        }
+        /* The metadata is a single short frame and carries the used size and version of the object */
+        metadata_length = sizeof(metadata);
+        if (optiga_cache_read_metadata(g_nvm_oids[i], metadata, &metadata_length) != OPTIGA_LIB_SUCCESS) {
+            status = PAL_STATUS_FAILURE;
+            continue;
+        }
+
+        if ((optiga_cache_nvm_load(i, g_nvm_oids[i], metadata, metadata_length) == PAL_STATUS_SUCCESS) &&
+            (optiga_cache_insert(g_nvm_oids[i], g_nvm_object.data, g_nvm_object.header.length) ==
+             PAL_STATUS_SUCCESS)) {
+            g_nvm_stats.restored++;
+            g_nvm_stats.bytes_restored += g_nvm_object.header.length;
+            g_nvm_stats.saved_time_ms += g_nvm_object.header.read_time_ms;
+        } else if (optiga_cache_nvm_refresh(i, g_nvm_oids[i], metadata, metadata_length) == PAL_STATUS_SUCCESS) {
+            g_nvm_stats.refreshed++;
+        } else {
+            status = PAL_STATUS_FAILURE;
+        }
+    }
+
+    g_nvm_stats.restore_time_ms = pal_os_timer_get_time_in_milliseconds() - start;
+    return status;
+}
+
+void optiga_cache_nvm_invalidate(uint16_t optiga_oid)
+{
+    uint8_t i;
+    uint8_t chunk;
+
+    for (i = 0; i < OPTIGA_CACHE_NVM_MAX_OBJECTS; i++) {
+        if (g_nvm_oids[i] == optiga_oid) {
+            for (chunk = 0; chunk < OPTIGA_CACHE_NVM_KEYS_PER_OBJECT; chunk++) {
+                (void)nvm3_deleteObject(nvm3_defaultHandle, OPTIGA_CACHE_NVM_KEY(i, chunk));
+            }
+        }
+    }
+}
+
+void optiga_cache_nvm_get_stats(optiga_cache_nvm_stats_t * p_stats)
+{
+    *p_stats = g_nvm_stats;
+}
+
+/**
+* @}
+*/
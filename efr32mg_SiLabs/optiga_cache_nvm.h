@@ -0,0 +1,128 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file declares the NVM3 backed persistence of the OPTIGA public data cache.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+#ifndef _OPTIGA_CACHE_NVM_H_
+#define _OPTIGA_CACHE_NVM_H_
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <trustx/optiga/include/optiga/pal/pal.h>
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/// First NVM3 key used for the persisted objects, #OPTIGA_CACHE_NVM_KEYS_PER_OBJECT keys per persisted OID
+#ifndef OPTIGA_CACHE_NVM_KEY_BASE
+#define OPTIGA_CACHE_NVM_KEY_BASE           0x87100
+#endif
+
+/// NVM3 keys reserved per persisted OID, a record is split into NVM3 objects of at most NVM3_DEFAULT_MAX_OBJECT_SIZE
+#define OPTIGA_CACHE_NVM_KEYS_PER_OBJECT    8
+
+/// Maximum number of persisted OIDs
+#define OPTIGA_CACHE_NVM_MAX_OBJECTS        4
+
+/// Largest object which can be persisted (the device certificate typically is 500 - 800 bytes)
+#ifndef OPTIGA_CACHE_NVM_MAX_OBJECT_SIZE
+#define OPTIGA_CACHE_NVM_MAX_OBJECT_SIZE    1024
+#endif
+
+/// Size of the metadata stored as fingerprint of the object
+#define OPTIGA_CACHE_NVM_MAX_METADATA_SIZE  44
+
+/// Size of the coprocessor UID the persisted objects are bound to
+#define OPTIGA_CACHE_NVM_UID_SIZE           27
+
+/// NVM3 key of the UID of the chip the persisted objects were read from, after the keys of the objects
+#define OPTIGA_CACHE_NVM_UID_KEY            (OPTIGA_CACHE_NVM_KEY_BASE + \
+                                             (OPTIGA_CACHE_NVM_MAX_OBJECTS * OPTIGA_CACHE_NVM_KEYS_PER_OBJECT))
+
+/**********************************************************************************************************************
+ * ENUMS / STRUCTURES
+ *********************************************************************************************************************/
+/// Boot time restore statistics
+typedef struct optiga_cache_nvm_stats {
+    /// Objects restored from flash after a successful fingerprint check
+    uint32_t restored;
+    /// Objects read from OPTIGA because the flash copy was missing or stale
+    uint32_t refreshed;
+    /// Bytes restored from flash instead of being read over I2C
+    uint32_t bytes_restored;
+    /// Time spent in the last restore in milliseconds
+    uint32_t restore_time_ms;
+    /// Time the restored objects took to read from OPTIGA when they were persisted, in milliseconds
+    uint32_t saved_time_ms;
+    /// Objects which could not be written to flash, they are read from OPTIGA again on the next boot
+    uint32_t write_errors;
+    /// Restores which dropped all flash copies because they were read from another OPTIGA
+    uint32_t chip_changes;
+} optiga_cache_nvm_stats_t;
+
+/**********************************************************************************************************************
+ * API PROTOTYPES
+ *********************************************************************************************************************/
+/**
+ * Declares an OID to be persisted. The device certificate, trust anchor and coprocessor UID are declared by default.
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the OID is declared
+ * \retval  #PAL_STATUS_FAILURE  Returns when the table is full
+ */
+pal_status_t optiga_cache_nvm_add(uint16_t optiga_oid);
+
+/**
+ * Restores the persisted objects into the RAM cache.<br>
+ * The flash copies are bound to the coprocessor UID, all of them are dropped if the UID read from OPTIGA differs,
+ * e.g. on a board with a replaced or re-provisioned OPTIGA. Each entry is then validated against the object
+ * metadata read from OPTIGA. Stale or missing entries are read from OPTIGA and written to flash. Must be called
+ * after optiga_cache_init and the OPTIGA application is opened.
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when all declared objects are cached
+ * \retval  #PAL_STATUS_FAILURE  Returns when at least one object could not be read
+ */
+pal_status_t optiga_cache_nvm_restore(void);
+
+/**
+ * Drops the flash copy of the OID, e.g. after the object was updated. Called by #optiga_cache_write_data.
+ */
+void optiga_cache_nvm_invalidate(uint16_t optiga_oid);
+
+/**
+ * Returns the statistics of the last restore.
+ */
+void optiga_cache_nvm_get_stats(optiga_cache_nvm_stats_t * p_stats);
+
+#endif /* _OPTIGA_CACHE_NVM_H_ */
+
+/**
+* @}
+*/
@@ -0,0 +1,267 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file implements the dispatcher of stateless operations across several OPTIGA chips.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/* Optiga based includes */
+#include <trustx/optiga/include/optiga/pal/pal_os_timer.h>
+
+#include "optiga_dispatch.h"
+#include "optiga_i2c_addr.h"
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/* weight of a new sample in the average duration, 1/2^n */
+#define OPTIGA_DISPATCH_EWMA_SHIFT      3
+
+/* duration assumed for a chip without samples, in milliseconds */
+#define OPTIGA_DISPATCH_DEFAULT_LATENCY_MS  50
+
+/*********************************************************************************************************************
+ * LOCAL DATA
+ *********************************************************************************************************************/
+static optiga_dispatch_stats_t g_dispatch_stats;
+static uint8_t g_consecutive_failures[PAL_OPTIGA_CHIP_COUNT];
+static uint32_t g_drained_ms[PAL_OPTIGA_CHIP_COUNT];
+
+static SemaphoreHandle_t xDispatchMutex = NULL;
+/* held while a chip is selected, pal_os_lock_select_chip serves one task at a time */
+static SemaphoreHandle_t xDispatchBusMutex = NULL;
+
+/**********************************************************************************************************************
+ * LOCAL ROUTINES
+ *********************************************************************************************************************/
+// Returns the work queued on a chip in milliseconds; called with the lock held
+static uint32_t optiga_dispatch_work(const optiga_dispatch_chip_stats_t * p_chip)
+{
+    uint32_t latency_ms = (p_chip->latency_ms != 0) ? p_chip->latency_ms : OPTIGA_DISPATCH_DEFAULT_LATENCY_MS;
+
+    /* the new operation included, so that a fast busy chip can win over a slow idle one */
+    return (p_chip->outstanding + 1) * latency_ms;
+}
+
+// Chooses the healthy chip with the least work, PAL_OPTIGA_CHIP_COUNT if all are drained; called with the lock held
+static uint8_t optiga_dispatch_choose(void)
+{
+    optiga_dispatch_chip_stats_t * p_chip;
+    uint8_t chosen = PAL_OPTIGA_CHIP_COUNT;
+    uint32_t chosen_work = 0;
+    uint32_t work;
+    uint8_t i;
+
+    for (i = 0; i < PAL_OPTIGA_CHIP_COUNT; i++) {
+        p_chip = &g_dispatch_stats.chips[i];
+        if (p_chip->health != OPTIGA_DISPATCH_HEALTHY) {
+            continue;
+        }
+        work = optiga_dispatch_work(p_chip);
+        if ((chosen == PAL_OPTIGA_CHIP_COUNT) || (work < chosen_work)) {
+            chosen = i;
+            chosen_work = work;
+        }
+    }
+    return chosen;
+}
+
+// Returns a drained chip which rested long enough for a probe, or PAL_OPTIGA_CHIP_COUNT; called with the lock held
+static uint8_t optiga_dispatch_probe(uint32_t now)
+{
+    uint8_t i;
+
+    for (i = 0; i < PAL_OPTIGA_CHIP_COUNT; i++) {
+        if ((g_dispatch_stats.chips[i].health == OPTIGA_DISPATCH_DRAINED) &&
+            ((now - g_drained_ms[i]) >= OPTIGA_DISPATCH_PROBE_DELAY_MS)) {
+            g_dispatch_stats.chips[i].health = OPTIGA_DISPATCH_PROBING;
+            return i;
+        }
+    }
+    return PAL_OPTIGA_CHIP_COUNT;
+}
+
+// Opens the IFX I2C session of each chip, the chips failing to open are drained; called with the bus lock held
+static void optiga_dispatch_open_all(void)
+{
+    optiga_lib_status_t status;
+    uint8_t i;
+
+    for (i = 0; i < PAL_OPTIGA_CHIP_COUNT; i++) {
+        pal_os_lock_select_chip(i);
+        status = optiga_util_open_application(optiga_comms_table[i]);
+        pal_os_lock_select_chip(0);
+
+        xSemaphoreTake(xDispatchMutex, portMAX_DELAY);
+        if (status == OPTIGA_LIB_SUCCESS) {
+            g_dispatch_stats.chips[i].health = OPTIGA_DISPATCH_HEALTHY;
+            g_consecutive_failures[i] = 0;
+        } else {
+            /* probed once it rested, as after repeated failures */
+            g_dispatch_stats.chips[i].health = OPTIGA_DISPATCH_DRAINED;
+            g_dispatch_stats.chips[i].failures++;
+            g_drained_ms[i] = pal_os_timer_get_time_in_milliseconds();
+        }
+        xSemaphoreGive(xDispatchMutex);
+    }
+}
+
+/**********************************************************************************************************************
+ * API IMPLEMENTATION
+ *********************************************************************************************************************/
+pal_status_t optiga_dispatch_init(void)
+{
+    if (xDispatchMutex == NULL) {
+        xDispatchMutex = xSemaphoreCreateMutex();
+        xDispatchBusMutex = xSemaphoreCreateMutex();
+        if ((xDispatchMutex == NULL) || (xDispatchBusMutex == NULL)) {
+            return PAL_STATUS_FAILURE;
+        }
+    }
+
+    memset(&g_dispatch_stats, 0, sizeof(g_dispatch_stats));
+    memset(g_consecutive_failures, 0, sizeof(g_consecutive_failures));
+
+    xSemaphoreTake(xDispatchBusMutex, portMAX_DELAY);
+    optiga_dispatch_open_all();
+    xSemaphoreGive(xDispatchBusMutex);
+    return PAL_STATUS_SUCCESS;
+}
+
+optiga_lib_status_t optiga_dispatch_run(optiga_dispatch_op_t operation, void * p_args)
+{
+    optiga_dispatch_chip_stats_t * p_chip;
+    optiga_lib_status_t status;
+    uint32_t start_ms;
+    uint32_t duration;
+    uint8_t chip;
+
+    xSemaphoreTake(xDispatchMutex, portMAX_DELAY);
+    start_ms = pal_os_timer_get_time_in_milliseconds();
+    chip = optiga_dispatch_probe(start_ms);
+    if (chip == PAL_OPTIGA_CHIP_COUNT) {
+        chip = optiga_dispatch_choose();
+    }
+    if (chip == PAL_OPTIGA_CHIP_COUNT) {
+        g_dispatch_stats.rejected++;
+        xSemaphoreGive(xDispatchMutex);
+        return OPTIGA_LIB_ERROR;
+    }
+    p_chip = &g_dispatch_stats.chips[chip];
+    p_chip->outstanding++;
+    xSemaphoreGive(xDispatchMutex);
+
+    /* the operations waiting for the bus are the outstanding work of their chip */
+    xSemaphoreTake(xDispatchBusMutex, portMAX_DELAY);
+    start_ms = pal_os_timer_get_time_in_milliseconds();
+    pal_os_lock_select_chip(chip);
+    status = operation(chip, p_args);
+    pal_os_lock_select_chip(0);
+    xSemaphoreGive(xDispatchBusMutex);
+
+    xSemaphoreTake(xDispatchMutex, portMAX_DELAY);
+    p_chip->outstanding--;
+    if (status == OPTIGA_LIB_SUCCESS) {
+        duration = pal_os_timer_get_time_in_milliseconds() - start_ms;
+        if (p_chip->latency_ms == 0) {
+            p_chip->latency_ms = duration;
+        } else {
+            p_chip->latency_ms = (uint32_t)((int32_t)p_chip->latency_ms +
+                (((int32_t)duration - (int32_t)p_chip->latency_ms) >> OPTIGA_DISPATCH_EWMA_SHIFT));
+        }
+        p_chip->operations++;
+        p_chip->health = OPTIGA_DISPATCH_HEALTHY;
+        g_consecutive_failures[chip] = 0;
+    } else {
+        p_chip->failures++;
+        if (g_consecutive_failures[chip] < 0xFF) {
+            g_consecutive_failures[chip]++;
+        }
+        if ((p_chip->health == OPTIGA_DISPATCH_PROBING) ||
+            ((p_chip->health == OPTIGA_DISPATCH_HEALTHY) &&
+             (g_consecutive_failures[chip] >= OPTIGA_DISPATCH_DRAIN_THRESHOLD))) {
+            if (p_chip->health == OPTIGA_DISPATCH_HEALTHY) {
+                p_chip->drains++;
+            }
+            p_chip->health = OPTIGA_DISPATCH_DRAINED;
+            g_drained_ms[chip] = pal_os_timer_get_time_in_milliseconds();
+        }
+    }
+    xSemaphoreGive(xDispatchMutex);
+    return status;
+}
+
+void optiga_dispatch_reset_all(void)
+{
+    uint32_t now;
+    uint8_t i;
+
+    xSemaphoreTake(xDispatchBusMutex, portMAX_DELAY);
+    /* no work for the chips until their session is re-opened */
+    xSemaphoreTake(xDispatchMutex, portMAX_DELAY);
+    now = pal_os_timer_get_time_in_milliseconds();
+    for (i = 0; i < PAL_OPTIGA_CHIP_COUNT; i++) {
+        g_dispatch_stats.chips[i].health = OPTIGA_DISPATCH_DRAINED;
+        g_drained_ms[i] = now;
+    }
+    g_dispatch_stats.resets++;
+    xSemaphoreGive(xDispatchMutex);
+
+    if (optiga_i2c_addr_is_volatile()) {
+        /* released all at once the chips would come up on the default address together, a chip failing to get
+         * its address again is held in reset and fails to open */
+        (void)optiga_i2c_addr_restore();
+    } else {
+        pal_gpio_set_bulk(optiga_reset_table, PAL_OPTIGA_CHIP_COUNT, 0);
+        pal_os_timer_delay_in_milliseconds(OPTIGA_DISPATCH_RESET_LOW_TIME_MS);
+        pal_gpio_set_bulk(optiga_reset_table, PAL_OPTIGA_CHIP_COUNT, 1);
+    }
+
+    optiga_dispatch_open_all();
+    xSemaphoreGive(xDispatchBusMutex);
+}
+
+void optiga_dispatch_get_stats(optiga_dispatch_stats_t * p_stats)
+{
+    xSemaphoreTake(xDispatchMutex, portMAX_DELAY);
+    *p_stats = g_dispatch_stats;
+    xSemaphoreGive(xDispatchMutex);
+}
+
+/**
+* @}
+*/
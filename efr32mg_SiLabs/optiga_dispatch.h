@@ -0,0 +1,151 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file declares the dispatcher of stateless operations across several OPTIGA chips.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+#ifndef _OPTIGA_DISPATCH_H_
+#define _OPTIGA_DISPATCH_H_
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <trustx/optiga/include/optiga/optiga_util.h>
+#include <trustx/optiga/include/optiga/pal/pal.h>
+
+#include "pal_efr32.h"
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/// Consecutive failures after which a chip is drained
+#define OPTIGA_DISPATCH_DRAIN_THRESHOLD     3
+
+/// Time a drained chip gets no work before a single probe operation is sent to it, in milliseconds
+#ifndef OPTIGA_DISPATCH_PROBE_DELAY_MS
+#define OPTIGA_DISPATCH_PROBE_DELAY_MS      5000
+#endif
+
+/// Low time of the reset pins in #optiga_dispatch_reset_all, in milliseconds
+#define OPTIGA_DISPATCH_RESET_LOW_TIME_MS   1
+
+/**********************************************************************************************************************
+ * ENUMS / STRUCTURES
+ *********************************************************************************************************************/
+/// Health of a chip
+typedef enum optiga_dispatch_health {
+    /// The chip gets work
+    OPTIGA_DISPATCH_HEALTHY = 0,
+    /// The chip failed repeatedly and gets no work
+    OPTIGA_DISPATCH_DRAINED,
+    /// A single operation checks whether a drained chip recovered
+    OPTIGA_DISPATCH_PROBING
+} optiga_dispatch_health_t;
+
+/**
+ * Operation executed on the chosen chip, e.g. a signature with a key replicated on all chips, a random draw or a
+ * hash. The operation must not depend on state left on a chip by a previous operation.
+ */
+typedef optiga_lib_status_t (*optiga_dispatch_op_t)(uint8_t chip, void * p_args);
+
+/// Statistics of a chip
+typedef struct optiga_dispatch_chip_stats {
+    optiga_dispatch_health_t health;
+    /// Operations in progress on the chip
+    uint8_t outstanding;
+    /// Operations completed
+    uint32_t operations;
+    /// Operations failed
+    uint32_t failures;
+    /// Times the chip was drained
+    uint32_t drains;
+    /// Average duration of an operation in milliseconds
+    uint32_t latency_ms;
+} optiga_dispatch_chip_stats_t;
+
+/// Dispatcher statistics
+typedef struct optiga_dispatch_stats {
+    optiga_dispatch_chip_stats_t chips[PAL_OPTIGA_CHIP_COUNT];
+    /// Operations rejected because all chips were drained
+    uint32_t rejected;
+    /// Bulk resets
+    uint32_t resets;
+} optiga_dispatch_stats_t;
+
+/**********************************************************************************************************************
+ * API PROTOTYPES
+ *********************************************************************************************************************/
+/**
+ * Initializes the dispatcher for the chips of the chip tables and opens the IFX I2C session of each chip with its
+ * context of #optiga_comms_table. Chips whose session is opened are healthy, the others are drained and probed later.
+ * <br>Called instead of optiga_util_open_application by the application, after #optiga_i2c_addr_provision.
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the dispatcher is initialized
+ * \retval  #PAL_STATUS_FAILURE  Returns when the locks cannot be created
+ */
+pal_status_t optiga_dispatch_init(void);
+
+/**
+ * Runs an operation on the healthy chip with the least outstanding work, i.e. the smallest number of operations in
+ * progress weighted by the average duration of an operation on the chip.<br>
+ * Several tasks may dispatch concurrently, the operation runs in the calling task with the chip selected through
+ * pal_os_lock_select_chip: its commands use the comms context of the chip. The commands of tasks not dispatching go
+ * to chip 0.<br>
+ * The host library has a single active comms context and all commands are serialized by the single PAL lock
+ * (pal_os_lock_acquire), hence the dispatched operations run one after another. The dispatcher spreads the load and
+ * routes around failed chips, it does not increase the throughput over a single chip.
+ *
+ * \param[in] operation     Operation to execute
+ * \param[in] p_args        Argument of the operation
+ *
+ * \retval  #OPTIGA_LIB_SUCCESS  Returns when the operation succeeded
+ * \retval  #OPTIGA_LIB_ERROR    Returns when the operation failed or all chips are drained
+ */
+optiga_lib_status_t optiga_dispatch_run(optiga_dispatch_op_t operation, void * p_args);
+
+/**
+ * Resets all chips at once through their reset pins (one write per GPIO port), then re-opens the session of each
+ * chip.<br>
+ * With volatile addresses the chips are released one at a time and given their address again, see
+ * #optiga_i2c_addr_restore.<br>
+ * Chips whose session is re-opened are healthy, the others are drained and probed later. Waits for the dispatched
+ * operation in progress.
+ */
+void optiga_dispatch_reset_all(void);
+
+/**
+ * Returns a snapshot of the dispatcher statistics.
+ */
+void optiga_dispatch_get_stats(optiga_dispatch_stats_t * p_stats);
+
+#endif /* _OPTIGA_DISPATCH_H_ */
+
+/**
+* @}
+*/
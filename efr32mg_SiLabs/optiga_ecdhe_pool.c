@@ -0,0 +1,293 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file implements the pool of pre-generated ephemeral ECC keypairs held in OPTIGA session contexts.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/* Optiga based includes */
+#include <trustx/optiga/include/optiga/optiga_crypt.h>
+#include <trustx/optiga/include/optiga/pal/pal_os_timer.h>
+
+#include "pal_efr32.h"
+#include "optiga_ecdhe_pool.h"
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+#define OPTIGA_ECDHE_SLOT_EMPTY         0
+#define OPTIGA_ECDHE_SLOT_GENERATING    1
+#define OPTIGA_ECDHE_SLOT_READY         2
+#define OPTIGA_ECDHE_SLOT_IN_USE        3
+
+/*********************************************************************************************************************
+ * LOCAL DATA
+ *********************************************************************************************************************/
+/* session context managed by the pool */
+typedef struct {
+    uint8_t  state;
+    /* reset generation the keypair was generated in */
+    uint32_t generation;
+    /* lease of the keypair handed out, and when it was handed out */
+    uint16_t lease;
+    uint32_t acquired_ms;
+    uint16_t public_key_length;
+    uint8_t  public_key[OPTIGA_ECDHE_POOL_PUBLIC_KEY_SIZE];
+} optiga_ecdhe_slot_t;
+
+static optiga_ecdhe_slot_t g_ecdhe_slots[OPTIGA_ECDHE_POOL_SESSIONS];
+static optiga_ecdhe_pool_stats_t g_ecdhe_stats;
+
+static SemaphoreHandle_t xEcdhePoolMutex = NULL;
+
+static volatile uint32_t g_reset_generation = 0;
+static uint16_t g_next_lease = 0;
+
+/**********************************************************************************************************************
+ * LOCAL ROUTINES
+ *********************************************************************************************************************/
+// Takes the pool lock, drops the keypairs generated before the last OPTIGA reset and takes back expired leases
+static void optiga_ecdhe_pool_lock(void)
+{
+    uint32_t now;
+    uint8_t i;
+
+    xSemaphoreTake(xEcdhePoolMutex, portMAX_DELAY);
+    now = pal_os_timer_get_time_in_milliseconds();
+    for (i = 0; i < OPTIGA_ECDHE_POOL_SESSIONS; i++) {
+        if ((g_ecdhe_slots[i].state == OPTIGA_ECDHE_SLOT_READY) &&
+            (g_ecdhe_slots[i].generation != g_reset_generation)) {
+            g_ecdhe_slots[i].state = OPTIGA_ECDHE_SLOT_EMPTY;
+            g_ecdhe_stats.discarded++;
+        } else if ((g_ecdhe_slots[i].state == OPTIGA_ECDHE_SLOT_IN_USE) &&
+                   ((now - g_ecdhe_slots[i].acquired_ms) >= OPTIGA_ECDHE_POOL_LEASE_TIMEOUT_MS)) {
+            /* the owner is gone (aborted handshake), the key is replaced before the context is handed out again */
+            g_ecdhe_slots[i].state = OPTIGA_ECDHE_SLOT_EMPTY;
+            g_ecdhe_stats.reclaimed++;
+            g_ecdhe_stats.in_use--;
+        }
+    }
+}
+
+static void optiga_ecdhe_pool_unlock(void)
+{
+    xSemaphoreGive(xEcdhePoolMutex);
+}
+
+// Reset listener, runs in the context driving the reset pin and therefore must not take the pool lock
+static void optiga_ecdhe_pool_on_reset(void* p_ctx)
+{
+    (void)p_ctx;
+    g_reset_generation++;
+}
+
+// Generates a keypair into the session context of the slot, the slot must be in the generating state
+static optiga_lib_status_t optiga_ecdhe_pool_generate(uint8_t index)
+{
+    optiga_ecdhe_slot_t * p_slot = &g_ecdhe_slots[index];
+    optiga_key_id_t key_id = (optiga_key_id_t)(OPTIGA_SESSION_ID_E100 + index);
+    uint32_t generation = g_reset_generation;
+    optiga_lib_status_t status;
+
+    p_slot->public_key_length = sizeof(p_slot->public_key);
+    status = optiga_crypt_ecc_generate_keypair(OPTIGA_ECDHE_POOL_CURVE, (uint8_t)OPTIGA_KEY_USAGE_KEY_AGREEMENT,
+                                               FALSE, &key_id, p_slot->public_key, &p_slot->public_key_length);
+    p_slot->generation = generation;
+    return status;
+}
+
+/**********************************************************************************************************************
+ * API IMPLEMENTATION
+ *********************************************************************************************************************/
+pal_status_t optiga_ecdhe_pool_init(void)
+{
+    if (xEcdhePoolMutex == NULL) {
+        xEcdhePoolMutex = xSemaphoreCreateMutex();
+        if (xEcdhePoolMutex == NULL) {
+            return PAL_STATUS_FAILURE;
+        }
+        if (pal_gpio_register_reset_listener(optiga_ecdhe_pool_on_reset, NULL) != PAL_STATUS_SUCCESS) {
+            return PAL_STATUS_FAILURE;
+        }
+    }
+
+    memset(g_ecdhe_slots, 0, sizeof(g_ecdhe_slots));
+    memset(&g_ecdhe_stats, 0, sizeof(g_ecdhe_stats));
+    return PAL_STATUS_SUCCESS;
+}
+
+optiga_lib_status_t optiga_ecdhe_pool_acquire(optiga_key_id_t * p_key_id, uint16_t * p_lease, uint8_t * public_key,
+                                              uint16_t * public_key_length)
+{
+    optiga_lib_status_t status = OPTIGA_LIB_SUCCESS;
+    int8_t ready = -1;
+    int8_t empty = -1;
+    uint8_t i;
+
+    optiga_ecdhe_pool_lock();
+    for (i = 0; i < OPTIGA_ECDHE_POOL_SESSIONS; i++) {
+        if ((g_ecdhe_slots[i].state == OPTIGA_ECDHE_SLOT_READY) && (ready < 0)) {
+            ready = (int8_t)i;
+        } else if ((g_ecdhe_slots[i].state == OPTIGA_ECDHE_SLOT_EMPTY) && (empty < 0)) {
+            empty = (int8_t)i;
+        }
+    }
+
+    if (ready >= 0) {
+        i = (uint8_t)ready;
+        g_ecdhe_stats.hits++;
+    } else if (empty >= 0) {
+        i = (uint8_t)empty;
+        g_ecdhe_stats.misses++;
+        g_ecdhe_slots[i].state = OPTIGA_ECDHE_SLOT_GENERATING;
+        optiga_ecdhe_pool_unlock();
+
+        status = optiga_ecdhe_pool_generate(i);
+
+        optiga_ecdhe_pool_lock();
+        if (status != OPTIGA_LIB_SUCCESS) {
+            g_ecdhe_slots[i].state = OPTIGA_ECDHE_SLOT_EMPTY;
+        }
+    } else {
+        /* all session contexts are in use */
+        status = OPTIGA_LIB_ERROR;
+    }
+
+    if (status == OPTIGA_LIB_SUCCESS) {
+        if (*public_key_length < g_ecdhe_slots[i].public_key_length) {
+            /* keep the keypair pooled for a caller with a large enough buffer */
+            g_ecdhe_slots[i].state = OPTIGA_ECDHE_SLOT_READY;
+            status = OPTIGA_LIB_ERROR;
+        } else {
+            g_ecdhe_slots[i].state = OPTIGA_ECDHE_SLOT_IN_USE;
+            g_ecdhe_slots[i].lease = ++g_next_lease;
+            g_ecdhe_slots[i].acquired_ms = pal_os_timer_get_time_in_milliseconds();
+            g_ecdhe_stats.in_use++;
+            *p_key_id = (optiga_key_id_t)(OPTIGA_SESSION_ID_E100 + i);
+            *p_lease = g_ecdhe_slots[i].lease;
+            *public_key_length = g_ecdhe_slots[i].public_key_length;
+            memcpy(public_key, g_ecdhe_slots[i].public_key, *public_key_length);
+        }
+    }
+    optiga_ecdhe_pool_unlock();
+
+    return status;
+}
+
+void optiga_ecdhe_pool_release(optiga_key_id_t key_id, uint16_t lease)
+{
+    uint8_t index = (uint8_t)(key_id - OPTIGA_SESSION_ID_E100);
+
+    if (index >= OPTIGA_ECDHE_POOL_SESSIONS) {
+        return;
+    }
+
+    optiga_ecdhe_pool_lock();
+    if ((g_ecdhe_slots[index].state == OPTIGA_ECDHE_SLOT_IN_USE) && (g_ecdhe_slots[index].lease == lease)) {
+        g_ecdhe_slots[index].state = OPTIGA_ECDHE_SLOT_EMPTY;
+        g_ecdhe_stats.in_use--;
+    }
+    optiga_ecdhe_pool_unlock();
+}
+
+uint8_t optiga_ecdhe_pool_refill(uint8_t max_commands)
+{
+    optiga_lib_status_t status;
+    uint8_t added = 0;
+    uint8_t i;
+
+    for (i = 0; (i < OPTIGA_ECDHE_POOL_SESSIONS) && (max_commands > 0); i++) {
+        optiga_ecdhe_pool_lock();
+        if (g_ecdhe_slots[i].state != OPTIGA_ECDHE_SLOT_EMPTY) {
+            optiga_ecdhe_pool_unlock();
+            continue;
+        }
+        g_ecdhe_slots[i].state = OPTIGA_ECDHE_SLOT_GENERATING;
+        optiga_ecdhe_pool_unlock();
+
+        max_commands--;
+        status = optiga_ecdhe_pool_generate(i);
+
+        optiga_ecdhe_pool_lock();
+        if (status == OPTIGA_LIB_SUCCESS) {
+            g_ecdhe_slots[i].state = OPTIGA_ECDHE_SLOT_READY;
+            g_ecdhe_stats.pregenerated++;
+            added++;
+        } else {
+            g_ecdhe_slots[i].state = OPTIGA_ECDHE_SLOT_EMPTY;
+        }
+        optiga_ecdhe_pool_unlock();
+    }
+    return added;
+}
+
+uint8_t optiga_ecdhe_pool_deficit(void)
+{
+    uint8_t deficit = 0;
+    uint8_t i;
+
+    optiga_ecdhe_pool_lock();
+    for (i = 0; i < OPTIGA_ECDHE_POOL_SESSIONS; i++) {
+        if (g_ecdhe_slots[i].state == OPTIGA_ECDHE_SLOT_EMPTY) {
+            deficit++;
+        }
+    }
+    optiga_ecdhe_pool_unlock();
+
+    return deficit;
+}
+
+pal_status_t optiga_ecdhe_pool_idle_job(void* job_ctx)
+{
+    (void)job_ctx;
+
+    if (optiga_ecdhe_pool_deficit() == 0) {
+        return PAL_STATUS_FAILURE;
+    }
+    return (optiga_ecdhe_pool_refill(1) > 0) ? PAL_STATUS_SUCCESS : PAL_STATUS_FAILURE;
+}
+
+void optiga_ecdhe_pool_get_stats(optiga_ecdhe_pool_stats_t * p_stats)
+{
+    optiga_ecdhe_pool_lock();
+    *p_stats = g_ecdhe_stats;
+    optiga_ecdhe_pool_unlock();
+}
+
+/**
+* @}
+*/
@@ -0,0 +1,141 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file declares the pool of pre-generated ephemeral ECC keypairs held in OPTIGA session contexts.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+#ifndef _OPTIGA_ECDHE_POOL_H_
+#define _OPTIGA_ECDHE_POOL_H_
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <trustx/optiga/include/optiga/optiga_crypt.h>
+#include <trustx/optiga/include/optiga/pal/pal.h>
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/// Number of session contexts (starting at OPTIGA_SESSION_ID_E100) managed by the pool, at most 4
+#ifndef OPTIGA_ECDHE_POOL_SESSIONS
+#define OPTIGA_ECDHE_POOL_SESSIONS          2
+#endif
+
+/// Curve of the pooled keypairs
+#ifndef OPTIGA_ECDHE_POOL_CURVE
+#define OPTIGA_ECDHE_POOL_CURVE             OPTIGA_ECC_NIST_P_256
+#endif
+
+/// Size of the public key buffer (DER encoded BIT STRING, large enough for NIST P-384)
+#define OPTIGA_ECDHE_POOL_PUBLIC_KEY_SIZE   100
+
+/// Time after which a keypair handed out and never released is taken back, e.g. after an aborted handshake
+#ifndef OPTIGA_ECDHE_POOL_LEASE_TIMEOUT_MS
+#define OPTIGA_ECDHE_POOL_LEASE_TIMEOUT_MS  60000
+#endif
+
+/**********************************************************************************************************************
+ * ENUMS / STRUCTURES
+ *********************************************************************************************************************/
+/// Ephemeral keypair pool statistics
+typedef struct optiga_ecdhe_pool_stats {
+    /// Keypairs handed out pre-generated
+    uint32_t hits;
+    /// Keypairs generated in the caller's path
+    uint32_t misses;
+    /// Keypairs generated in the background
+    uint32_t pregenerated;
+    /// Pre-generated keypairs lost due to an OPTIGA reset
+    uint32_t discarded;
+    /// Keypairs taken back after #OPTIGA_ECDHE_POOL_LEASE_TIMEOUT_MS without a release
+    uint32_t reclaimed;
+    /// Keypairs currently handed out
+    uint8_t in_use;
+} optiga_ecdhe_pool_stats_t;
+
+/**********************************************************************************************************************
+ * API PROTOTYPES
+ *********************************************************************************************************************/
+/**
+ * Initializes the pool and registers for the OPTIGA reset notification, which drops the pre-generated keys since
+ * the session contexts do not survive a reset.
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the pool is initialized
+ * \retval  #PAL_STATUS_FAILURE  Returns when the pool lock cannot be created
+ */
+pal_status_t optiga_ecdhe_pool_init(void);
+
+/**
+ * Hands out an ephemeral keypair. If no pre-generated keypair is available one is generated in a free session.<br>
+ * The keypair is leased: if it is not released within #OPTIGA_ECDHE_POOL_LEASE_TIMEOUT_MS, the session context is
+ * taken back and its key replaced.
+ *
+ * \param[out]    p_key_id              Session context holding the private key
+ * \param[out]    p_lease               Lease of the keypair, to be passed to #optiga_ecdhe_pool_release
+ * \param[out]    public_key            Buffer for the DER encoded public key
+ * \param[in,out] public_key_length     Size of the buffer / length of the public key
+ */
+optiga_lib_status_t optiga_ecdhe_pool_acquire(optiga_key_id_t * p_key_id, uint16_t * p_lease, uint8_t * public_key,
+                                              uint16_t * public_key_length);
+
+/**
+ * Returns the session context to the pool once the shared secret is derived, or the key is destroyed unused.<br>
+ * A lease which expired is ignored, the session context may already be handed out again.
+ */
+void optiga_ecdhe_pool_release(optiga_key_id_t key_id, uint16_t lease);
+
+/**
+ * Generates keypairs into free session contexts and returns the number of keypairs added.<br>
+ * Must be called from a task context which is allowed to issue OPTIGA commands (typically the idle scheduler).
+ *
+ * \param[in] max_commands  Maximum number of keypair generations issued by this call
+ */
+uint8_t optiga_ecdhe_pool_refill(uint8_t max_commands);
+
+/**
+ * Returns the number of session contexts which can be filled.
+ */
+uint8_t optiga_ecdhe_pool_deficit(void);
+
+/**
+ * Idle scheduler job generating one keypair if a session context is empty. Fails if no keypair was generated, so
+ * that a failing OPTIGA is retried on the next period only. See #pal_os_idle_register.
+ */
+pal_status_t optiga_ecdhe_pool_idle_job(void* job_ctx);
+
+/**
+ * Returns a snapshot of the pool statistics.
+ */
+void optiga_ecdhe_pool_get_stats(optiga_ecdhe_pool_stats_t * p_stats);
+
+#endif /* _OPTIGA_ECDHE_POOL_H_ */
+
+/**
+* @}
+*/
@@ -0,0 +1,254 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file implements the OPTIGA performance/power governor (current limitation and sleep activation delay).
+*
+* \ingroup  grPAL
+* @{
+*/
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Optiga based includes */
+#include <trustx/optiga/include/optiga/optiga_util.h>
+#include <trustx/optiga/include/optiga/pal/pal_os_timer.h>
+
+#include "pal_efr32.h"
+#include "optiga_governor.h"
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/* weight of a new sample in the average inter-arrival time, 1/2^n */
+#define OPTIGA_GOVERNOR_EWMA_SHIFT      3
+
+/* period of the write budget */
+#define OPTIGA_GOVERNOR_DAY_MS          (24UL * 60 * 60 * 1000)
+
+/*********************************************************************************************************************
+ * LOCAL DATA
+ *********************************************************************************************************************/
+static optiga_governor_config_t g_config = {
+    OPTIGA_GOVERNOR_CURRENT_MIN_MA, /* low current */
+    OPTIGA_GOVERNOR_CURRENT_MAX_MA, /* high current */
+    200,                            /* burst interval */
+    10000                           /* idle time */
+};
+
+static optiga_governor_stats_t g_gov_stats;
+static volatile uint32_t g_last_request_ms = 0;
+static volatile uint8_t g_on_battery = 0;
+/* settings read back from OPTIGA at the first run */
+static uint8_t g_applied_known = 0;
+static uint32_t g_last_write_ms[2];
+/* write budget of each setting for the current day */
+static uint32_t g_budget_start_ms[2];
+static uint8_t g_budget_writes[2];
+static uint8_t g_observer_registered = 0;
+
+/**********************************************************************************************************************
+ * LOCAL ROUTINES
+ *********************************************************************************************************************/
+// Lock observer, tracks the request inter-arrival time
+static void optiga_governor_on_command(uint32_t acquired_ms, uint32_t hold_time_ms)
+{
+    uint32_t interval = acquired_ms - g_last_request_ms;
+
+    (void)hold_time_ms;
+
+    /* only the application load counts, not the background jobs (including the governor itself) */
+    if (pal_os_idle_in_background()) {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    if (g_gov_stats.inter_arrival_ms == 0) {
+        g_gov_stats.inter_arrival_ms = interval;
+    } else {
+        g_gov_stats.inter_arrival_ms = (uint32_t)((int32_t)g_gov_stats.inter_arrival_ms +
+            (((int32_t)interval - (int32_t)g_gov_stats.inter_arrival_ms) >> OPTIGA_GOVERNOR_EWMA_SHIFT));
+    }
+    g_last_request_ms = acquired_ms;
+    taskEXIT_CRITICAL();
+}
+
+// Writes one setting if it changed and the write interval allows it
+static pal_status_t optiga_governor_apply(uint8_t index, uint16_t optiga_oid, uint8_t * p_applied, uint8_t target)
+{
+    uint32_t now = pal_os_timer_get_time_in_milliseconds();
+
+    if ((target == *p_applied) || ((now - g_last_write_ms[index]) < OPTIGA_GOVERNOR_MIN_WRITE_INTERVAL_MS)) {
+        return PAL_STATUS_FAILURE;
+    }
+
+    if ((now - g_budget_start_ms[index]) >= OPTIGA_GOVERNOR_DAY_MS) {
+        g_budget_start_ms[index] = now;
+        g_budget_writes[index] = 0;
+    }
+    if (g_budget_writes[index] >= OPTIGA_GOVERNOR_MAX_WRITES_PER_DAY) {
+        g_gov_stats.budget_denials++;
+        return PAL_STATUS_FAILURE;
+    }
+
+    g_last_write_ms[index] = now;
+    g_budget_writes[index]++;
+    if (optiga_util_write_data(optiga_oid, OPTIGA_UTIL_ERASE_AND_WRITE, 0, &target, 1) == OPTIGA_LIB_SUCCESS) {
+        *p_applied = target;
+        g_gov_stats.writes++;
+    }
+    return PAL_STATUS_SUCCESS;
+}
+
+/**********************************************************************************************************************
+ * API IMPLEMENTATION
+ *********************************************************************************************************************/
+pal_status_t optiga_governor_init(const optiga_governor_config_t * p_config)
+{
+    if (!g_observer_registered) {
+        if (pal_os_lock_register_observer(optiga_governor_on_command) != PAL_STATUS_SUCCESS) {
+            return PAL_STATUS_FAILURE;
+        }
+        g_observer_registered = 1;
+    }
+
+    if (p_config != NULL) {
+        g_config = *p_config;
+    }
+    memset(&g_gov_stats, 0, sizeof(g_gov_stats));
+    g_applied_known = 0;
+    /* allow the first correction right away */
+    g_last_write_ms[0] = pal_os_timer_get_time_in_milliseconds() - OPTIGA_GOVERNOR_MIN_WRITE_INTERVAL_MS;
+    g_last_write_ms[1] = g_last_write_ms[0];
+    g_budget_start_ms[0] = pal_os_timer_get_time_in_milliseconds();
+    g_budget_start_ms[1] = g_budget_start_ms[0];
+    g_budget_writes[0] = 0;
+    g_budget_writes[1] = 0;
+    g_last_request_ms = pal_os_timer_get_time_in_milliseconds();
+    return PAL_STATUS_SUCCESS;
+}
+
+void optiga_governor_set_battery(uint8_t on_battery)
+{
+    g_on_battery = on_battery;
+}
+
+void optiga_governor_decide(const optiga_governor_config_t * p_config, const optiga_governor_input_t * p_input,
+                            optiga_governor_output_t * p_output)
+{
+    uint32_t sleep_delay;
+    uint32_t burst_interval = p_config->burst_interval_ms;
+
+    /* current limitation: fast under bursts, low when idle or on battery */
+    if (p_input->applied.current_ma == p_config->high_current_ma) {
+        burst_interval *= OPTIGA_GOVERNOR_BURST_HYSTERESIS;
+    }
+    if (p_input->on_battery || (p_input->since_last_request_ms >= p_config->idle_time_ms)) {
+        p_output->current_ma = p_config->low_current_ma;
+    } else if (p_input->inter_arrival_ms <= burst_interval) {
+        p_output->current_ma = p_config->high_current_ma;
+    } else {
+        p_output->current_ma = p_config->low_current_ma;
+    }
+
+    /* sleep activation delay: stay awake across the typical gap between requests, unless the gaps are longer than
+     * the maximum delay anyway, then go to sleep as early as possible */
+    if ((p_input->inter_arrival_ms == 0) || (p_input->inter_arrival_ms > OPTIGA_GOVERNOR_SLEEP_MAX_MS) ||
+        p_input->on_battery) {
+        sleep_delay = OPTIGA_GOVERNOR_SLEEP_MIN_MS;
+    } else {
+        sleep_delay = p_input->inter_arrival_ms + (p_input->inter_arrival_ms / 4);
+    }
+    if (sleep_delay < OPTIGA_GOVERNOR_SLEEP_MIN_MS) {
+        sleep_delay = OPTIGA_GOVERNOR_SLEEP_MIN_MS;
+    } else if (sleep_delay > OPTIGA_GOVERNOR_SLEEP_MAX_MS) {
+        sleep_delay = OPTIGA_GOVERNOR_SLEEP_MAX_MS;
+    }
+    /* small changes are not worth a write, except going to sleep early on battery */
+    if (!p_input->on_battery && (p_input->applied.sleep_delay_ms >= OPTIGA_GOVERNOR_SLEEP_MIN_MS) &&
+        (sleep_delay < ((uint32_t)p_input->applied.sleep_delay_ms + OPTIGA_GOVERNOR_SLEEP_HYSTERESIS_MS)) &&
+        ((sleep_delay + OPTIGA_GOVERNOR_SLEEP_HYSTERESIS_MS) > p_input->applied.sleep_delay_ms)) {
+        sleep_delay = p_input->applied.sleep_delay_ms;
+    }
+    p_output->sleep_delay_ms = (uint8_t)sleep_delay;
+}
+
+pal_status_t optiga_governor_idle_job(void* job_ctx)
+{
+    optiga_governor_input_t input;
+    optiga_governor_output_t target;
+    uint16_t length;
+
+    (void)job_ctx;
+
+    if (!g_applied_known) {
+        length = 1;
+        if (optiga_util_read_data(OPTIGA_GOVERNOR_OID_CURRENT_LIMIT, 0, &g_gov_stats.applied.current_ma,
+                                  &length) != OPTIGA_LIB_SUCCESS) {
+            return PAL_STATUS_FAILURE;
+        }
+        length = 1;
+        if (optiga_util_read_data(OPTIGA_GOVERNOR_OID_SLEEP_DELAY, 0, &g_gov_stats.applied.sleep_delay_ms,
+                                  &length) != OPTIGA_LIB_SUCCESS) {
+            return PAL_STATUS_FAILURE;
+        }
+        g_applied_known = 1;
+        return PAL_STATUS_SUCCESS;
+    }
+
+    taskENTER_CRITICAL();
+    input.inter_arrival_ms = g_gov_stats.inter_arrival_ms;
+    input.since_last_request_ms = pal_os_timer_get_time_in_milliseconds() - g_last_request_ms;
+    input.on_battery = g_on_battery;
+    input.applied = g_gov_stats.applied;
+    taskEXIT_CRITICAL();
+
+    optiga_governor_decide(&g_config, &input, &target);
+
+    if (optiga_governor_apply(0, OPTIGA_GOVERNOR_OID_CURRENT_LIMIT, &g_gov_stats.applied.current_ma,
+                              target.current_ma) == PAL_STATUS_SUCCESS) {
+        return PAL_STATUS_SUCCESS;
+    }
+    return optiga_governor_apply(1, OPTIGA_GOVERNOR_OID_SLEEP_DELAY, &g_gov_stats.applied.sleep_delay_ms,
+                                 target.sleep_delay_ms);
+}
+
+void optiga_governor_get_stats(optiga_governor_stats_t * p_stats)
+{
+    taskENTER_CRITICAL();
+    *p_stats = g_gov_stats;
+    taskEXIT_CRITICAL();
+}
+
+/**
+* @}
+*/
@@ -0,0 +1,159 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file declares the OPTIGA performance/power governor (current limitation and sleep activation delay).
+*
+* \ingroup  grPAL
+* @{
+*/
+
+#ifndef _OPTIGA_GOVERNOR_H_
+#define _OPTIGA_GOVERNOR_H_
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <trustx/optiga/include/optiga/pal/pal.h>
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/// OID of the current limitation in mA
+#define OPTIGA_GOVERNOR_OID_CURRENT_LIMIT   0xE0C4
+/// OID of the sleep mode activation delay in ms
+#define OPTIGA_GOVERNOR_OID_SLEEP_DELAY     0xE0C3
+
+/// Range of the current limitation supported by OPTIGA Trust X, in mA
+#define OPTIGA_GOVERNOR_CURRENT_MIN_MA      6
+#define OPTIGA_GOVERNOR_CURRENT_MAX_MA      15
+
+/// Range of the sleep mode activation delay supported by OPTIGA Trust X, in ms
+#define OPTIGA_GOVERNOR_SLEEP_MIN_MS        20
+#define OPTIGA_GOVERNOR_SLEEP_MAX_MS        255
+
+/// Minimum time between two writes of a setting, limits the NVM wear on OPTIGA
+#ifndef OPTIGA_GOVERNOR_MIN_WRITE_INTERVAL_MS
+#define OPTIGA_GOVERNOR_MIN_WRITE_INTERVAL_MS   60000
+#endif
+
+/// Writes of each setting allowed per day, further changes are held back until the next day
+#ifndef OPTIGA_GOVERNOR_MAX_WRITES_PER_DAY
+#define OPTIGA_GOVERNOR_MAX_WRITES_PER_DAY      24
+#endif
+
+/// The high current is kept until the inter-arrival time exceeds this multiple of the burst interval
+#define OPTIGA_GOVERNOR_BURST_HYSTERESIS        2
+
+/// Smallest change of the sleep mode activation delay worth a write, in ms
+#define OPTIGA_GOVERNOR_SLEEP_HYSTERESIS_MS     32
+
+/**********************************************************************************************************************
+ * ENUMS / STRUCTURES
+ *********************************************************************************************************************/
+/// Governor policy configuration
+typedef struct optiga_governor_config {
+    /// Current limitation while idle or on battery, in mA
+    uint8_t low_current_ma;
+    /// Current limitation under bursty load, in mA
+    uint8_t high_current_ma;
+    /// Average request inter-arrival time below which the load is considered bursty, in ms
+    uint32_t burst_interval_ms;
+    /// Time without requests after which the governor falls back to the low current, in ms
+    uint32_t idle_time_ms;
+} optiga_governor_config_t;
+
+/// Outputs of the policy
+typedef struct optiga_governor_output {
+    uint8_t current_ma;
+    uint8_t sleep_delay_ms;
+} optiga_governor_output_t;
+
+/// Inputs of the policy
+typedef struct optiga_governor_input {
+    /// Average request inter-arrival time in ms
+    uint32_t inter_arrival_ms;
+    /// Time since the last request in ms
+    uint32_t since_last_request_ms;
+    /// Non zero when running on battery
+    uint8_t on_battery;
+    /// Settings currently applied, the policy only moves away from them beyond the hysteresis
+    optiga_governor_output_t applied;
+} optiga_governor_input_t;
+
+/// Governor statistics
+typedef struct optiga_governor_stats {
+    /// Settings currently applied
+    optiga_governor_output_t applied;
+    /// Average request inter-arrival time in ms
+    uint32_t inter_arrival_ms;
+    /// Setting writes issued to OPTIGA
+    uint32_t writes;
+    /// Idle job runs which held back a setting change because the daily write budget was used up
+    uint32_t budget_denials;
+} optiga_governor_stats_t;
+
+/**********************************************************************************************************************
+ * API PROTOTYPES
+ *********************************************************************************************************************/
+/**
+ * Initializes the governor and registers it as observer of the OPTIGA lock to measure the request inter-arrival
+ * time. Passing NULL uses the default configuration.
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the governor is initialized
+ * \retval  #PAL_STATUS_FAILURE  Returns when the lock observer cannot be registered
+ */
+pal_status_t optiga_governor_init(const optiga_governor_config_t * p_config);
+
+/**
+ * Informs the governor about the power source.
+ */
+void optiga_governor_set_battery(uint8_t on_battery);
+
+/**
+ * Computes the settings for the given inputs. The policy has no side effects and can be exercised on the host.<br>
+ * The high current is kept up to #OPTIGA_GOVERNOR_BURST_HYSTERESIS times the burst interval, and the sleep delay
+ * only changes by at least #OPTIGA_GOVERNOR_SLEEP_HYSTERESIS_MS, so that an oscillating load does not wear the NVM.
+ */
+void optiga_governor_decide(const optiga_governor_config_t * p_config, const optiga_governor_input_t * p_input,
+                            optiga_governor_output_t * p_output);
+
+/**
+ * Idle scheduler job applying the policy, writes at most one setting per call. See #pal_os_idle_register.<br>
+ * Each setting is written at most #OPTIGA_GOVERNOR_MAX_WRITES_PER_DAY times a day, changes beyond the budget are
+ * counted in the budget_denials statistic.
+ */
+pal_status_t optiga_governor_idle_job(void* job_ctx);
+
+/**
+ * Returns a snapshot of the governor statistics.
+ */
+void optiga_governor_get_stats(optiga_governor_stats_t * p_stats);
+
+#endif /* _OPTIGA_GOVERNOR_H_ */
+
+/**
+* @}
+*/
@@ -0,0 +1,223 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file implements the provisioning of unique I2C addresses to the OPTIGA chips sharing a bus.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <string.h>
+
+/* Optiga based includes */
+#include <trustx/optiga/include/optiga/pal/pal_i2c.h>
+#include <trustx/optiga/include/optiga/pal/pal_os_timer.h>
+
+#include "optiga_i2c_addr.h"
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/* IFX I2C registers */
+#define OPTIGA_I2C_ADDR_STATE_REG       0x82
+#define OPTIGA_I2C_ADDR_BASE_ADDR_REG   0x83
+/* persistence byte written before the address to the 2 byte base address register, as by the physical layer */
+#define OPTIGA_I2C_ADDR_BASE_ADDR_PERSISTENT    0x80
+#define OPTIGA_I2C_ADDR_BASE_ADDR_VOLATILE      0x00
+
+/* length of the I2C_STATE register */
+#define OPTIGA_I2C_ADDR_STATE_LENGTH    4
+
+/* time a transfer may take when its completion is reported from the event handler task, in milliseconds */
+#define OPTIGA_I2C_ADDR_TRANSFER_TIMEOUT_MS 50
+
+/* no event reported yet */
+#define OPTIGA_I2C_ADDR_EVENT_PENDING   0xFFFF
+
+/*********************************************************************************************************************
+ * LOCAL DATA
+ *********************************************************************************************************************/
+/* static, a completion reported after the timeout must not reach a stale stack frame */
+static pal_i2c_t g_i2c_context;
+static volatile uint16_t g_event;
+
+/* addresses of the last provisioning, assigned again after a reset drops volatile addresses */
+static uint8_t g_addresses[PAL_OPTIGA_CHIP_COUNT];
+static uint8_t g_mode = OPTIGA_I2C_ADDR_PERSISTENT;
+/* chip keeping the default address, released last; the last chip if none keeps it */
+static uint8_t g_default_chip = PAL_OPTIGA_CHIP_COUNT - 1;
+static uint8_t g_provisioned = 0;
+
+/**********************************************************************************************************************
+ * LOCAL ROUTINES
+ *********************************************************************************************************************/
+static void optiga_i2c_addr_event_handler(void* p_ctx, uint16_t event)
+{
+    *(volatile uint16_t *)p_ctx = event;
+}
+
+// Performs a transfer to the given address outside of an IFX I2C session and waits for its completion
+static pal_status_t optiga_i2c_addr_transfer(uint8_t chip, uint8_t address, uint8_t is_read, uint8_t * p_data,
+                                             uint16_t length)
+{
+    uint32_t start_ms;
+    pal_status_t status;
+
+    g_event = OPTIGA_I2C_ADDR_EVENT_PENDING;
+    g_i2c_context = *optiga_pal_i2c_table[chip];
+    g_i2c_context.slave_address = address;
+    g_i2c_context.upper_layer_ctx = (void *)&g_event;
+    g_i2c_context.upper_layer_event_handler = (void *)optiga_i2c_addr_event_handler;
+
+    status = is_read ? pal_i2c_read(&g_i2c_context, p_data, length) :
+                       pal_i2c_write(&g_i2c_context, p_data, length);
+    if (status != PAL_STATUS_SUCCESS) {
+        return PAL_STATUS_FAILURE;
+    }
+
+    /* with the pipelined or deferred transfers the completion is reported from the event handler task */
+    start_ms = pal_os_timer_get_time_in_milliseconds();
+    while (g_event == OPTIGA_I2C_ADDR_EVENT_PENDING) {
+        if ((pal_os_timer_get_time_in_milliseconds() - start_ms) >= OPTIGA_I2C_ADDR_TRANSFER_TIMEOUT_MS) {
+            return PAL_STATUS_FAILURE;
+        }
+        pal_os_timer_delay_in_milliseconds(1);
+    }
+    return (g_event == PAL_I2C_EVENT_SUCCESS) ? PAL_STATUS_SUCCESS : PAL_STATUS_FAILURE;
+}
+
+// Returns success if the chip answers on the address, by reading its I2C_STATE register
+static pal_status_t optiga_i2c_addr_probe(uint8_t chip, uint8_t address)
+{
+    uint8_t state[OPTIGA_I2C_ADDR_STATE_LENGTH];
+
+    state[0] = OPTIGA_I2C_ADDR_STATE_REG;
+    if (optiga_i2c_addr_transfer(chip, address, 0, state, 1) != PAL_STATUS_SUCCESS) {
+        return PAL_STATUS_FAILURE;
+    }
+    return optiga_i2c_addr_transfer(chip, address, 1, state, sizeof(state));
+}
+
+// Gives the chip its address once it is the only one out of reset on the default address
+static pal_status_t optiga_i2c_addr_assign(uint8_t chip, uint8_t address, uint8_t mode)
+{
+    /* register, persistence, address */
+    uint8_t base_address[3];
+
+    if ((address != OPTIGA_I2C_ADDR_DEFAULT) && (optiga_i2c_addr_probe(chip, address) != PAL_STATUS_SUCCESS)) {
+        base_address[0] = OPTIGA_I2C_ADDR_BASE_ADDR_REG;
+        base_address[1] = (mode == OPTIGA_I2C_ADDR_PERSISTENT) ? OPTIGA_I2C_ADDR_BASE_ADDR_PERSISTENT :
+                                                                 OPTIGA_I2C_ADDR_BASE_ADDR_VOLATILE;
+        base_address[2] = address;
+        if (optiga_i2c_addr_transfer(chip, OPTIGA_I2C_ADDR_DEFAULT, 0, base_address,
+                                     sizeof(base_address)) != PAL_STATUS_SUCCESS) {
+            return PAL_STATUS_FAILURE;
+        }
+    }
+    return optiga_i2c_addr_probe(chip, address);
+}
+
+// Releases the chips from reset one at a time and assigns their addresses
+static pal_status_t optiga_i2c_addr_assign_all(void)
+{
+    pal_status_t status = PAL_STATUS_SUCCESS;
+    uint8_t chip;
+    uint8_t i;
+
+    /* a chip out of reset is the only one on the default address, the others already have their own */
+    pal_gpio_set_bulk(optiga_reset_table, PAL_OPTIGA_CHIP_COUNT, 0);
+    for (i = 0; i < PAL_OPTIGA_CHIP_COUNT; i++) {
+        /* the chip keeping the default address comes last, the next chip would come up on its address */
+        chip = (uint8_t)((i + g_default_chip + 1) % PAL_OPTIGA_CHIP_COUNT);
+        pal_gpio_set_high(optiga_reset_table[chip]);
+        pal_os_timer_delay_in_milliseconds(OPTIGA_I2C_ADDR_STARTUP_TIME_MS);
+
+        if (optiga_i2c_addr_assign(chip, g_addresses[chip], g_mode) != PAL_STATUS_SUCCESS) {
+            /* held in reset, it would answer on the default address together with the next chip */
+            pal_gpio_set_low(optiga_reset_table[chip]);
+            status = PAL_STATUS_FAILURE;
+            continue;
+        }
+        optiga_pal_i2c_table[chip]->slave_address = g_addresses[chip];
+        optiga_ifx_i2c_table[chip]->slave_address = g_addresses[chip];
+    }
+    return status;
+}
+
+/**********************************************************************************************************************
+ * API IMPLEMENTATION
+ *********************************************************************************************************************/
+pal_status_t optiga_i2c_addr_provision(const uint8_t * p_addresses, uint8_t mode)
+{
+    uint8_t chip;
+    uint8_t i;
+
+    /* the host library context of the first chip resets it when its session is opened */
+    if ((mode != OPTIGA_I2C_ADDR_PERSISTENT) && (p_addresses[0] != OPTIGA_I2C_ADDR_DEFAULT)) {
+        return PAL_STATUS_FAILURE;
+    }
+    for (chip = 0; chip < PAL_OPTIGA_CHIP_COUNT; chip++) {
+        if (p_addresses[chip] > 0x7F) {
+            return PAL_STATUS_FAILURE;
+        }
+        for (i = 0; i < chip; i++) {
+            if (p_addresses[i] == p_addresses[chip]) {
+                return PAL_STATUS_FAILURE;
+            }
+        }
+    }
+
+    memcpy(g_addresses, p_addresses, sizeof(g_addresses));
+    g_mode = mode;
+    g_default_chip = PAL_OPTIGA_CHIP_COUNT - 1;
+    for (chip = 0; chip < PAL_OPTIGA_CHIP_COUNT; chip++) {
+        if (p_addresses[chip] == OPTIGA_I2C_ADDR_DEFAULT) {
+            g_default_chip = chip;
+        }
+    }
+    g_provisioned = 1;
+    return optiga_i2c_addr_assign_all();
+}
+
+uint8_t optiga_i2c_addr_is_volatile(void)
+{
+    return (g_provisioned && (g_mode != OPTIGA_I2C_ADDR_PERSISTENT));
+}
+
+pal_status_t optiga_i2c_addr_restore(void)
+{
+    if (!g_provisioned) {
+        return PAL_STATUS_FAILURE;
+    }
+    return optiga_i2c_addr_assign_all();
+}
+
+/**
+* @}
+*/
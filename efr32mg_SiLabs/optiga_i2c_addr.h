@@ -0,0 +1,103 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file declares the provisioning of unique I2C addresses to the OPTIGA chips sharing a bus.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+#ifndef _OPTIGA_I2C_ADDR_H_
+#define _OPTIGA_I2C_ADDR_H_
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <trustx/optiga/include/optiga/pal/pal.h>
+
+#include "pal_efr32.h"
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/// I2C address of an OPTIGA after delivery (or after a reset, for volatile addresses)
+#define OPTIGA_I2C_ADDR_DEFAULT         0x30
+
+/// The address is kept until the next reset
+#define OPTIGA_I2C_ADDR_VOLATILE        0
+/// The address is stored in the OPTIGA and kept across resets
+#define OPTIGA_I2C_ADDR_PERSISTENT      1
+
+/// Time from releasing the reset of an OPTIGA until it answers on the bus, in milliseconds
+#ifndef OPTIGA_I2C_ADDR_STARTUP_TIME_MS
+#define OPTIGA_I2C_ADDR_STARTUP_TIME_MS 15
+#endif
+
+/**********************************************************************************************************************
+ * API PROTOTYPES
+ *********************************************************************************************************************/
+/**
+ * Assigns a unique I2C address to each OPTIGA of the chip tables.<br>
+ * All chips are held in reset, then released one at a time: the released chip is the only one answering on the
+ * default address, it is given its address and checked to answer on it. The chip keeping the default address is
+ * released last. The slave address of the I2C context of
+ * each chip in #optiga_pal_i2c_table and #optiga_ifx_i2c_table is updated, the IFX I2C sessions can be opened
+ * afterwards.<br>
+ * A chip already answering on its address (persistent address from an earlier provisioning) is left as is. A chip
+ * which does not answer on its address is held in reset and the others are provisioned nonetheless.
+ *
+ *<b>Notes:</b><br>
+ *  - To be called from an application task before the IFX I2C sessions are opened, not from the event handler task.
+ *  - Volatile addresses are lost when a chip is reset, #optiga_i2c_addr_restore repeats the provisioning. The first
+ *    chip keeps the default address in volatile mode, as the host library resets it when its session is opened.
+ *
+ * \param[in] p_addresses   7 bit address of each chip, #PAL_OPTIGA_CHIP_COUNT entries
+ * \param[in] mode          #OPTIGA_I2C_ADDR_VOLATILE or #OPTIGA_I2C_ADDR_PERSISTENT
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when all chips answer on their address
+ * \retval  #PAL_STATUS_FAILURE  Returns when the addresses are invalid or a chip does not answer
+ */
+pal_status_t optiga_i2c_addr_provision(const uint8_t * p_addresses, uint8_t mode);
+
+/**
+ * Returns non zero if the chips were provisioned with volatile addresses.
+ */
+uint8_t optiga_i2c_addr_is_volatile(void);
+
+/**
+ * Repeats the last provisioning, e.g. after the chips were reset: the chips are held in reset and released one at
+ * a time as by #optiga_i2c_addr_provision.
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when all chips answer on their address
+ * \retval  #PAL_STATUS_FAILURE  Returns when the chips were never provisioned or a chip does not answer
+ */
+pal_status_t optiga_i2c_addr_restore(void);
+
+#endif /* _OPTIGA_I2C_ADDR_H_ */
+
+/**
+* @}
+*/
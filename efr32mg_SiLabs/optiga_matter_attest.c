@@ -0,0 +1,261 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file implements the Matter device attestation provider backed by OPTIGA Trust X.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/* PSA Crypto of the Gecko SDK, used for the host side hashing */
+#include "psa/crypto.h"
+
+/* Optiga based includes */
+#include <trustx/optiga/include/optiga/pal/pal_os_timer.h>
+
+#include "pal_efr32.h"
+#include "optiga_cache.h"
+#include "optiga_cache_nvm.h"
+#include "optiga_psa_driver.h"
+#include "optiga_matter_attest.h"
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/* two DER INTEGERs of up to 33 bytes, optionally in a SEQUENCE */
+#define OPTIGA_MATTER_ATTEST_DER_SIGNATURE_SIZE     72
+
+/*********************************************************************************************************************
+ * LOCAL DATA
+ *********************************************************************************************************************/
+typedef enum {
+    OPTIGA_MATTER_SIGN_IDLE = 0,
+    OPTIGA_MATTER_SIGN_PENDING,
+    OPTIGA_MATTER_SIGN_BUSY
+} optiga_matter_sign_state_t;
+
+static optiga_matter_attest_config_t g_config = {
+    0xE0E0,                     /* DAC */
+    0xE0E1,                     /* PAI */
+    OPTIGA_KEY_STORE_ID_E0F0    /* device attestation key */
+};
+
+/* queued signature */
+static optiga_matter_sign_state_t g_sign_state = OPTIGA_MATTER_SIGN_IDLE;
+static uint8_t g_sign_digest[32];
+static uint32_t g_sign_requested_ms;
+static optiga_matter_attest_handler_t g_sign_handler;
+static void * g_sign_ctx;
+
+static optiga_matter_attest_stats_t g_matter_stats;
+
+static SemaphoreHandle_t xMatterMutex = NULL;
+
+/**********************************************************************************************************************
+ * LOCAL ROUTINES
+ *********************************************************************************************************************/
+static pal_status_t optiga_matter_attest_sign_digest(uint8_t * p_digest, uint8_t * p_signature)
+{
+    uint8_t der_signature[OPTIGA_MATTER_ATTEST_DER_SIGNATURE_SIZE];
+    uint16_t der_signature_length = sizeof(der_signature);
+
+    if ((optiga_crypt_ecdsa_sign(p_digest, 32, g_config.dac_key_id, der_signature, &der_signature_length) !=
+         OPTIGA_LIB_SUCCESS) ||
+        (optiga_psa_signature_to_raw(der_signature, der_signature_length, 32, p_signature) != PSA_SUCCESS)) {
+        return PAL_STATUS_FAILURE;
+    }
+    return PAL_STATUS_SUCCESS;
+}
+
+static pal_status_t optiga_matter_attest_digest(const uint8_t * p_message, uint32_t message_length,
+                                                uint8_t * p_digest)
+{
+    size_t length;
+
+    return (psa_hash_compute(PSA_ALG_SHA_256, p_message, message_length, p_digest, 32, &length) == PSA_SUCCESS) ?
+           PAL_STATUS_SUCCESS : PAL_STATUS_FAILURE;
+}
+
+// Restores the certificates from flash (or reads them from OPTIGA), the validation also brings up the I2C link
+static pal_status_t optiga_matter_attest_prewarm(void)
+{
+    uint32_t start_ms = pal_os_timer_get_time_in_milliseconds();
+    pal_status_t status;
+
+    status = optiga_cache_nvm_restore();
+
+    xSemaphoreTake(xMatterMutex, portMAX_DELAY);
+    if (status == PAL_STATUS_SUCCESS) {
+        g_matter_stats.prewarm_time_ms = pal_os_timer_get_time_in_milliseconds() - start_ms;
+        g_matter_stats.prewarmed = 1;
+    }
+    xSemaphoreGive(xMatterMutex);
+    return status;
+}
+
+/**********************************************************************************************************************
+ * API IMPLEMENTATION
+ *********************************************************************************************************************/
+pal_status_t optiga_matter_attest_init(const optiga_matter_attest_config_t * p_config)
+{
+    if (xMatterMutex == NULL) {
+        xMatterMutex = xSemaphoreCreateMutex();
+        if (xMatterMutex == NULL) {
+            return PAL_STATUS_FAILURE;
+        }
+    }
+
+    if (p_config != NULL) {
+        g_config = *p_config;
+    }
+    memset(&g_matter_stats, 0, sizeof(g_matter_stats));
+    g_sign_state = OPTIGA_MATTER_SIGN_IDLE;
+
+    if ((optiga_cache_set_policy(g_config.dac_oid, OPTIGA_CACHE_DATA | OPTIGA_CACHE_METADATA) != PAL_STATUS_SUCCESS) ||
+        (optiga_cache_set_policy(g_config.pai_oid, OPTIGA_CACHE_DATA | OPTIGA_CACHE_METADATA) != PAL_STATUS_SUCCESS) ||
+        (optiga_cache_nvm_add(g_config.dac_oid) != PAL_STATUS_SUCCESS) ||
+        (optiga_cache_nvm_add(g_config.pai_oid) != PAL_STATUS_SUCCESS)) {
+        return PAL_STATUS_FAILURE;
+    }
+    return PAL_STATUS_SUCCESS;
+}
+
+optiga_lib_status_t optiga_matter_attest_get_dac(uint8_t * p_buffer, uint16_t * p_length)
+{
+    return optiga_cache_read_data(g_config.dac_oid, 0, p_buffer, p_length);
+}
+
+optiga_lib_status_t optiga_matter_attest_get_pai(uint8_t * p_buffer, uint16_t * p_length)
+{
+    return optiga_cache_read_data(g_config.pai_oid, 0, p_buffer, p_length);
+}
+
+pal_status_t optiga_matter_attest_sign(const uint8_t * p_message, uint32_t message_length, uint8_t * p_signature)
+{
+    uint8_t digest[32];
+    uint32_t start_ms = pal_os_timer_get_time_in_milliseconds();
+    pal_status_t status;
+
+    status = optiga_matter_attest_digest(p_message, message_length, digest);
+    if (status == PAL_STATUS_SUCCESS) {
+        status = optiga_matter_attest_sign_digest(digest, p_signature);
+    }
+
+    xSemaphoreTake(xMatterMutex, portMAX_DELAY);
+    if (status == PAL_STATUS_SUCCESS) {
+        g_matter_stats.signatures++;
+        g_matter_stats.last_sign_time_ms = pal_os_timer_get_time_in_milliseconds() - start_ms;
+    } else {
+        g_matter_stats.errors++;
+    }
+    xSemaphoreGive(xMatterMutex);
+    return status;
+}
+
+pal_status_t optiga_matter_attest_sign_async(const uint8_t * p_message, uint32_t message_length,
+                                             optiga_matter_attest_handler_t handler, void * p_ctx)
+{
+    uint8_t digest[32];
+
+    if (optiga_matter_attest_digest(p_message, message_length, digest) != PAL_STATUS_SUCCESS) {
+        return PAL_STATUS_FAILURE;
+    }
+
+    xSemaphoreTake(xMatterMutex, portMAX_DELAY);
+    if (g_sign_state != OPTIGA_MATTER_SIGN_IDLE) {
+        xSemaphoreGive(xMatterMutex);
+        return PAL_STATUS_FAILURE;
+    }
+    memcpy(g_sign_digest, digest, sizeof(g_sign_digest));
+    g_sign_handler = handler;
+    g_sign_ctx = p_ctx;
+    g_sign_requested_ms = pal_os_timer_get_time_in_milliseconds();
+    g_sign_state = OPTIGA_MATTER_SIGN_PENDING;
+    xSemaphoreGive(xMatterMutex);
+
+    pal_os_idle_trigger(optiga_matter_attest_idle_job);
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t optiga_matter_attest_idle_job(void* job_ctx)
+{
+    uint8_t signature[OPTIGA_MATTER_ATTEST_SIGNATURE_LENGTH];
+    optiga_matter_attest_handler_t handler;
+    void * p_handler_ctx;
+    pal_status_t status;
+    uint8_t prewarmed;
+
+    (void)job_ctx;
+
+    xSemaphoreTake(xMatterMutex, portMAX_DELAY);
+    if (g_sign_state != OPTIGA_MATTER_SIGN_PENDING) {
+        prewarmed = g_matter_stats.prewarmed;
+        xSemaphoreGive(xMatterMutex);
+        /* done once at boot, before a commissioner asks for the credentials */
+        return prewarmed ? PAL_STATUS_FAILURE : optiga_matter_attest_prewarm();
+    }
+    g_sign_state = OPTIGA_MATTER_SIGN_BUSY;
+    xSemaphoreGive(xMatterMutex);
+
+    status = optiga_matter_attest_sign_digest(g_sign_digest, signature);
+
+    xSemaphoreTake(xMatterMutex, portMAX_DELAY);
+    if (status == PAL_STATUS_SUCCESS) {
+        g_matter_stats.signatures++;
+        g_matter_stats.last_sign_time_ms = pal_os_timer_get_time_in_milliseconds() - g_sign_requested_ms;
+    } else {
+        g_matter_stats.errors++;
+    }
+    handler = g_sign_handler;
+    p_handler_ctx = g_sign_ctx;
+    g_sign_state = OPTIGA_MATTER_SIGN_IDLE;
+    xSemaphoreGive(xMatterMutex);
+
+    if (handler != NULL) {
+        handler((status == PAL_STATUS_SUCCESS) ? signature : NULL, p_handler_ctx);
+    }
+    return PAL_STATUS_SUCCESS;
+}
+
+void optiga_matter_attest_get_stats(optiga_matter_attest_stats_t * p_stats)
+{
+    xSemaphoreTake(xMatterMutex, portMAX_DELAY);
+    *p_stats = g_matter_stats;
+    xSemaphoreGive(xMatterMutex);
+}
+
+/**
+* @}
+*/
@@ -0,0 +1,138 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file declares the Matter device attestation provider backed by OPTIGA Trust X.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+#ifndef _OPTIGA_MATTER_ATTEST_H_
+#define _OPTIGA_MATTER_ATTEST_H_
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <trustx/optiga/include/optiga/optiga_crypt.h>
+#include <trustx/optiga/include/optiga/pal/pal.h>
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/// Length of the raw attestation signature (r||s on NIST P-256)
+#define OPTIGA_MATTER_ATTEST_SIGNATURE_LENGTH   64
+
+/**********************************************************************************************************************
+ * ENUMS / STRUCTURES
+ *********************************************************************************************************************/
+/// Location of the attestation credentials in OPTIGA
+typedef struct optiga_matter_attest_config {
+    /// OID of the device attestation certificate
+    uint16_t dac_oid;
+    /// OID of the product attestation intermediate certificate
+    uint16_t pai_oid;
+    /// Key store holding the device attestation key
+    optiga_key_id_t dac_key_id;
+} optiga_matter_attest_config_t;
+
+/// Called with the attestation signature from the idle scheduler task, p_signature is NULL on failure
+typedef void (*optiga_matter_attest_handler_t)(const uint8_t * p_signature, void * p_ctx);
+
+/// Attestation statistics
+typedef struct optiga_matter_attest_stats {
+    /// Non zero once the credentials are cached and the link to OPTIGA is up
+    uint8_t prewarmed;
+    /// Duration of the pre-warming in milliseconds
+    uint32_t prewarm_time_ms;
+    /// Attestation signatures computed
+    uint32_t signatures;
+    /// Duration of the last signature from request to result in milliseconds
+    uint32_t last_sign_time_ms;
+    /// Failed signatures
+    uint32_t errors;
+} optiga_matter_attest_stats_t;
+
+/**********************************************************************************************************************
+ * API PROTOTYPES
+ *********************************************************************************************************************/
+/**
+ * Initializes the provider and declares the DAC and PAI as cacheable and persisted in flash. The pre-warming is
+ * done by #optiga_matter_attest_idle_job, which has to be registered with the idle scheduler.<br>
+ * Passing NULL uses the DAC in 0xE0E0, the PAI in 0xE0E1 and the key in 0xE0F0.
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the provider is initialized
+ * \retval  #PAL_STATUS_FAILURE  Returns when the lock cannot be created or the cache tables are full
+ */
+pal_status_t optiga_matter_attest_init(const optiga_matter_attest_config_t * p_config);
+
+/**
+ * Copies the device attestation certificate, served from the RAM cache once pre-warmed.
+ *
+ * \param[out]    p_buffer      Buffer for the certificate
+ * \param[in,out] p_length      Size of the buffer / length of the certificate
+ */
+optiga_lib_status_t optiga_matter_attest_get_dac(uint8_t * p_buffer, uint16_t * p_length);
+
+/**
+ * Copies the product attestation intermediate certificate, served from the RAM cache once pre-warmed.
+ */
+optiga_lib_status_t optiga_matter_attest_get_pai(uint8_t * p_buffer, uint16_t * p_length);
+
+/**
+ * Signs a message with the device attestation key (ECDSA with SHA-256), blocking.
+ *
+ * \param[in]  p_message        Message to sign
+ * \param[in]  message_length   Length of the message
+ * \param[out] p_signature      Raw signature of #OPTIGA_MATTER_ATTEST_SIGNATURE_LENGTH bytes
+ */
+pal_status_t optiga_matter_attest_sign(const uint8_t * p_message, uint32_t message_length, uint8_t * p_signature);
+
+/**
+ * Hashes the message and queues its signature, which is computed by #optiga_matter_attest_idle_job as soon as the
+ * CPU is idle.
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the signature is queued
+ * \retval  #PAL_STATUS_FAILURE  Returns when a signature is already pending or the hash failed
+ */
+pal_status_t optiga_matter_attest_sign_async(const uint8_t * p_message, uint32_t message_length,
+                                             optiga_matter_attest_handler_t handler, void * p_ctx);
+
+/**
+ * Idle scheduler job pre-warming the provider once and then computing the queued signatures.
+ * See #pal_os_idle_register.
+ */
+pal_status_t optiga_matter_attest_idle_job(void* job_ctx);
+
+/**
+ * Returns a snapshot of the attestation statistics.
+ */
+void optiga_matter_attest_get_stats(optiga_matter_attest_stats_t * p_stats);
+
+#endif /* _OPTIGA_MATTER_ATTEST_H_ */
+
+/**
+* @}
+*/
@@ -0,0 +1,263 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file implements the streaming hash-then-verify of firmware image signatures.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/* PSA Crypto of the Gecko SDK, used for the host side hashing */
+#include "psa/crypto.h"
+
+/* Optiga based includes */
+#include <trustx/optiga/include/optiga/pal/pal_os_timer.h>
+
+#include "pal_efr32.h"
+#include "optiga_ota_verify.h"
+
+/*********************************************************************************************************************
+ * LOCAL DATA
+ *********************************************************************************************************************/
+typedef enum {
+    OPTIGA_OTA_CONTEXT_FREE = 0,
+    OPTIGA_OTA_CONTEXT_HASHING,
+    OPTIGA_OTA_CONTEXT_PENDING,
+    OPTIGA_OTA_CONTEXT_VERIFYING
+} optiga_ota_context_state_t;
+
+typedef struct {
+    optiga_ota_context_state_t state;
+    /* the verification was aborted while OPTIGA was verifying */
+    uint8_t aborted;
+    uint16_t anchor_oid;
+    psa_hash_operation_t hash_operation;
+    uint8_t digest[32];
+    uint8_t signature[OPTIGA_OTA_VERIFY_SIGNATURE_MAX_LENGTH];
+    uint16_t signature_length;
+    /* time the last chunk was hashed */
+    uint32_t finished_ms;
+    optiga_ota_verify_handler_t handler;
+    void * handler_ctx;
+} optiga_ota_context_t;
+
+static optiga_ota_context_t g_contexts[OPTIGA_OTA_VERIFY_MAX_CONTEXTS];
+static optiga_ota_verify_stats_t g_ota_stats;
+
+static SemaphoreHandle_t xOtaMutex = NULL;
+
+/**********************************************************************************************************************
+ * LOCAL ROUTINES
+ *********************************************************************************************************************/
+static optiga_ota_context_t * optiga_ota_context(optiga_ota_verify_handle_t handle,
+                                                 optiga_ota_context_state_t state)
+{
+    if ((handle >= OPTIGA_OTA_VERIFY_MAX_CONTEXTS) || (g_contexts[handle].state != state)) {
+        return NULL;
+    }
+    return &g_contexts[handle];
+}
+
+/**********************************************************************************************************************
+ * API IMPLEMENTATION
+ *********************************************************************************************************************/
+pal_status_t optiga_ota_verify_init(void)
+{
+    if (xOtaMutex == NULL) {
+        xOtaMutex = xSemaphoreCreateMutex();
+        if (xOtaMutex == NULL) {
+            return PAL_STATUS_FAILURE;
+        }
+    }
+
+    memset(g_contexts, 0, sizeof(g_contexts));
+    memset(&g_ota_stats, 0, sizeof(g_ota_stats));
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t optiga_ota_verify_start(uint16_t anchor_oid, optiga_ota_verify_handle_t * p_handle)
+{
+    optiga_ota_context_t * p_context;
+    psa_hash_operation_t operation = PSA_HASH_OPERATION_INIT;
+    uint8_t i;
+
+    *p_handle = OPTIGA_OTA_VERIFY_INVALID_HANDLE;
+
+    xSemaphoreTake(xOtaMutex, portMAX_DELAY);
+    for (i = 0; i < OPTIGA_OTA_VERIFY_MAX_CONTEXTS; i++) {
+        if (g_contexts[i].state == OPTIGA_OTA_CONTEXT_FREE) {
+            break;
+        }
+    }
+    if (i == OPTIGA_OTA_VERIFY_MAX_CONTEXTS) {
+        g_ota_stats.pool_exhausted++;
+        xSemaphoreGive(xOtaMutex);
+        return PAL_STATUS_FAILURE;
+    }
+
+    p_context = &g_contexts[i];
+    p_context->hash_operation = operation;
+    if (psa_hash_setup(&p_context->hash_operation, PSA_ALG_SHA_256) != PSA_SUCCESS) {
+        xSemaphoreGive(xOtaMutex);
+        return PAL_STATUS_FAILURE;
+    }
+    p_context->state = OPTIGA_OTA_CONTEXT_HASHING;
+    p_context->aborted = 0;
+    p_context->anchor_oid = anchor_oid;
+    xSemaphoreGive(xOtaMutex);
+
+    *p_handle = i;
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t optiga_ota_verify_update(optiga_ota_verify_handle_t handle, const uint8_t * p_chunk, uint32_t length)
+{
+    optiga_ota_context_t * p_context = optiga_ota_context(handle, OPTIGA_OTA_CONTEXT_HASHING);
+
+    /* the context belongs to the downloading task until it is finished, no lock needed */
+    if ((p_context == NULL) || (psa_hash_update(&p_context->hash_operation, p_chunk, length) != PSA_SUCCESS)) {
+        return PAL_STATUS_FAILURE;
+    }
+    g_ota_stats.bytes_hashed += length;
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t optiga_ota_verify_finish(optiga_ota_verify_handle_t handle, const uint8_t * p_signature,
+                                      uint16_t signature_length, optiga_ota_verify_handler_t handler, void * p_ctx)
+{
+    optiga_ota_context_t * p_context = optiga_ota_context(handle, OPTIGA_OTA_CONTEXT_HASHING);
+    size_t digest_length;
+
+    if ((p_context == NULL) || (signature_length > OPTIGA_OTA_VERIFY_SIGNATURE_MAX_LENGTH)) {
+        return PAL_STATUS_FAILURE;
+    }
+    if (psa_hash_finish(&p_context->hash_operation, p_context->digest, sizeof(p_context->digest),
+                        &digest_length) != PSA_SUCCESS) {
+        optiga_ota_verify_abort(handle);
+        return PAL_STATUS_FAILURE;
+    }
+
+    memcpy(p_context->signature, p_signature, signature_length);
+    p_context->signature_length = signature_length;
+    p_context->handler = handler;
+    p_context->handler_ctx = p_ctx;
+    p_context->finished_ms = pal_os_timer_get_time_in_milliseconds();
+
+    xSemaphoreTake(xOtaMutex, portMAX_DELAY);
+    p_context->state = OPTIGA_OTA_CONTEXT_PENDING;
+    xSemaphoreGive(xOtaMutex);
+
+    /* issue the verification as soon as the CPU is idle */
+    pal_os_idle_trigger(optiga_ota_verify_idle_job);
+    return PAL_STATUS_SUCCESS;
+}
+
+void optiga_ota_verify_abort(optiga_ota_verify_handle_t handle)
+{
+    if (handle >= OPTIGA_OTA_VERIFY_MAX_CONTEXTS) {
+        return;
+    }
+
+    xSemaphoreTake(xOtaMutex, portMAX_DELAY);
+    if (g_contexts[handle].state == OPTIGA_OTA_CONTEXT_VERIFYING) {
+        /* released by the idle job once OPTIGA returns */
+        g_contexts[handle].aborted = 1;
+    } else if (g_contexts[handle].state != OPTIGA_OTA_CONTEXT_FREE) {
+        (void)psa_hash_abort(&g_contexts[handle].hash_operation);
+        g_contexts[handle].state = OPTIGA_OTA_CONTEXT_FREE;
+    }
+    xSemaphoreGive(xOtaMutex);
+}
+
+pal_status_t optiga_ota_verify_idle_job(void* job_ctx)
+{
+    optiga_ota_context_t * p_context = NULL;
+    optiga_ota_verify_handler_t handler;
+    void * p_handler_ctx;
+    optiga_lib_status_t status;
+    pal_status_t result;
+    uint16_t anchor_oid;
+    uint8_t i;
+
+    (void)job_ctx;
+
+    xSemaphoreTake(xOtaMutex, portMAX_DELAY);
+    for (i = 0; i < OPTIGA_OTA_VERIFY_MAX_CONTEXTS; i++) {
+        if (g_contexts[i].state == OPTIGA_OTA_CONTEXT_PENDING) {
+            p_context = &g_contexts[i];
+            p_context->state = OPTIGA_OTA_CONTEXT_VERIFYING;
+            break;
+        }
+    }
+    xSemaphoreGive(xOtaMutex);
+
+    if (p_context == NULL) {
+        return PAL_STATUS_FAILURE;
+    }
+
+    /* OPTIGA takes the public key from the certificate object */
+    anchor_oid = p_context->anchor_oid;
+    status = optiga_crypt_ecdsa_verify(p_context->digest, sizeof(p_context->digest), p_context->signature,
+                                       p_context->signature_length, OPTIGA_CRYPT_OID_DATA, &anchor_oid);
+    result = (status == OPTIGA_LIB_SUCCESS) ? PAL_STATUS_SUCCESS : PAL_STATUS_FAILURE;
+
+    xSemaphoreTake(xOtaMutex, portMAX_DELAY);
+    if (result == PAL_STATUS_SUCCESS) {
+        g_ota_stats.verified++;
+    } else {
+        g_ota_stats.rejected++;
+    }
+    g_ota_stats.last_verify_time_ms = pal_os_timer_get_time_in_milliseconds() - p_context->finished_ms;
+    handler = p_context->aborted ? NULL : p_context->handler;
+    p_handler_ctx = p_context->handler_ctx;
+    p_context->state = OPTIGA_OTA_CONTEXT_FREE;
+    xSemaphoreGive(xOtaMutex);
+
+    if (handler != NULL) {
+        handler(i, result, p_handler_ctx);
+    }
+    return PAL_STATUS_SUCCESS;
+}
+
+void optiga_ota_verify_get_stats(optiga_ota_verify_stats_t * p_stats)
+{
+    xSemaphoreTake(xOtaMutex, portMAX_DELAY);
+    *p_stats = g_ota_stats;
+    xSemaphoreGive(xOtaMutex);
+}
+
+/**
+* @}
+*/
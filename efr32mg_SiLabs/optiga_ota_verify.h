@@ -0,0 +1,142 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file declares the streaming hash-then-verify of firmware image signatures.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+#ifndef _OPTIGA_OTA_VERIFY_H_
+#define _OPTIGA_OTA_VERIFY_H_
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <trustx/optiga/include/optiga/optiga_crypt.h>
+#include <trustx/optiga/include/optiga/pal/pal.h>
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/// Number of images which can be verified concurrently
+#ifndef OPTIGA_OTA_VERIFY_MAX_CONTEXTS
+#define OPTIGA_OTA_VERIFY_MAX_CONTEXTS      2
+#endif
+
+/// Maximum length of the DER encoded image signature
+#define OPTIGA_OTA_VERIFY_SIGNATURE_MAX_LENGTH  72
+
+/// Invalid handle
+#define OPTIGA_OTA_VERIFY_INVALID_HANDLE    0xFF
+
+/**********************************************************************************************************************
+ * ENUMS / STRUCTURES
+ *********************************************************************************************************************/
+/// Handle of an image verification
+typedef uint8_t optiga_ota_verify_handle_t;
+
+/**
+ * Called with the verification result from the idle scheduler task.<br>
+ * #PAL_STATUS_SUCCESS if the signature is valid, #PAL_STATUS_FAILURE otherwise.
+ */
+typedef void (*optiga_ota_verify_handler_t)(optiga_ota_verify_handle_t handle, pal_status_t result, void * p_ctx);
+
+/// Verification statistics
+typedef struct optiga_ota_verify_stats {
+    /// Images with a valid signature
+    uint32_t verified;
+    /// Images with an invalid signature or a failed verification
+    uint32_t rejected;
+    /// Bytes hashed on the host
+    uint32_t bytes_hashed;
+    /// Starts failing because all contexts were in use
+    uint32_t pool_exhausted;
+    /// Time from the last chunk to the result of the last verification, in milliseconds
+    uint32_t last_verify_time_ms;
+} optiga_ota_verify_stats_t;
+
+/**********************************************************************************************************************
+ * API PROTOTYPES
+ *********************************************************************************************************************/
+/**
+ * Initializes the context pool.
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the pool is initialized
+ * \retval  #PAL_STATUS_FAILURE  Returns when the pool lock cannot be created
+ */
+pal_status_t optiga_ota_verify_init(void);
+
+/**
+ * Starts the verification of an image.
+ *
+ * \param[in]  anchor_oid   OID of the certificate whose public key signed the image, OPTIGA reads the key itself
+ * \param[out] p_handle     Handle of the verification
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when a context is allocated
+ * \retval  #PAL_STATUS_FAILURE  Returns when all contexts are in use
+ */
+pal_status_t optiga_ota_verify_start(uint16_t anchor_oid, optiga_ota_verify_handle_t * p_handle);
+
+/**
+ * Hashes the next chunk of the image, to be called as the chunks arrive.
+ */
+pal_status_t optiga_ota_verify_update(optiga_ota_verify_handle_t handle, const uint8_t * p_chunk, uint32_t length);
+
+/**
+ * Completes the hash and queues the signature verification, which is issued by #optiga_ota_verify_idle_job.<br>
+ * The verification thus starts once the CPU is idle and #PAL_OS_IDLE_QUIET_TIME_MS after the last foreground OPTIGA
+ * command, not within this call.
+ *
+ * \param[in] handle            Handle of the verification
+ * \param[in] p_signature       DER encoded ECDSA signature of the image
+ * \param[in] signature_length  Length of the signature
+ * \param[in] handler           Receives the result
+ * \param[in] p_ctx             Handler argument
+ */
+pal_status_t optiga_ota_verify_finish(optiga_ota_verify_handle_t handle, const uint8_t * p_signature,
+                                      uint16_t signature_length, optiga_ota_verify_handler_t handler, void * p_ctx);
+
+/**
+ * Drops a verification, e.g. when the download is aborted.
+ */
+void optiga_ota_verify_abort(optiga_ota_verify_handle_t handle);
+
+/**
+ * Idle scheduler job issuing one pending verification per call. See #pal_os_idle_register.
+ */
+pal_status_t optiga_ota_verify_idle_job(void* job_ctx);
+
+/**
+ * Returns a snapshot of the verification statistics.
+ */
+void optiga_ota_verify_get_stats(optiga_ota_verify_stats_t * p_stats);
+
+#endif /* _OPTIGA_OTA_VERIFY_H_ */
+
+/**
+* @}
+*/
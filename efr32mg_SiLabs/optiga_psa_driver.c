@@ -0,0 +1,410 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file implements the PSA Crypto opaque driver for the keys stored in OPTIGA Trust X.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "optiga_cache.h"
+#include "optiga_ecdhe_pool.h"
+#include "optiga_psa_driver.h"
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/// Size of the built-in keys in bits
+#ifndef OPTIGA_PSA_BUILTIN_KEY_BITS
+#define OPTIGA_PSA_BUILTIN_KEY_BITS     256
+#endif
+
+/* largest certificate searched for the public key */
+#define OPTIGA_PSA_CERTIFICATE_MAX_SIZE 1024
+
+/* largest digest accepted by OPTIGA */
+#define OPTIGA_PSA_DIGEST_MAX_LENGTH    64
+
+/* two DER INTEGERs of up to 49 bytes, optionally in a SEQUENCE */
+#define OPTIGA_PSA_DER_SIGNATURE_SIZE   104
+
+/*********************************************************************************************************************
+ * LOCAL DATA
+ *********************************************************************************************************************/
+/* id-ecPublicKey, starts the subjectPublicKeyInfo algorithm of the certificate */
+static const uint8_t g_ec_public_key_oid[] = {0x06, 0x07, 0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x02, 0x01};
+
+/* certificate buffer, searched under the lock */
+static uint8_t g_certificate[OPTIGA_PSA_CERTIFICATE_MAX_SIZE];
+
+static optiga_psa_stats_t g_psa_stats;
+
+static SemaphoreHandle_t xPsaMutex = NULL;
+
+/**********************************************************************************************************************
+ * LOCAL ROUTINES
+ *********************************************************************************************************************/
+static void optiga_psa_count(uint32_t * p_counter)
+{
+    taskENTER_CRITICAL();
+    (*p_counter)++;
+    taskEXIT_CRITICAL();
+}
+
+static uint8_t optiga_psa_coordinate_size(size_t bits)
+{
+    return (uint8_t)((bits + 7) / 8);
+}
+
+// Reads the public key of the built-in key from the certificate, which is normally served by the cache
+static psa_status_t optiga_psa_certificate_public_key(uint8_t coordinate_size, uint8_t * p_public_key,
+                                                      uint8_t * p_public_key_length)
+{
+    uint16_t length = sizeof(g_certificate);
+    uint8_t key_length = (uint8_t)(1 + 2 * coordinate_size);
+    psa_status_t status = PSA_ERROR_DOES_NOT_EXIST;
+    uint16_t i;
+
+    xSemaphoreTake(xPsaMutex, portMAX_DELAY);
+    if (optiga_cache_read_data(OPTIGA_PSA_CERTIFICATE_OID, 0, g_certificate, &length) != OPTIGA_LIB_SUCCESS) {
+        xSemaphoreGive(xPsaMutex);
+        return PSA_ERROR_HARDWARE_FAILURE;
+    }
+
+    for (i = 0; (i + sizeof(g_ec_public_key_oid)) <= length; i++) {
+        if (memcmp(&g_certificate[i], g_ec_public_key_oid, sizeof(g_ec_public_key_oid)) == 0) {
+            break;
+        }
+    }
+
+    /* BIT STRING with no unused bits holding the uncompressed point, after the curve OID */
+    for (; (i + 3 + key_length) <= length; i++) {
+        if ((g_certificate[i] == 0x03) && (g_certificate[i + 1] == (key_length + 1)) &&
+            (g_certificate[i + 2] == 0x00) && (g_certificate[i + 3] == 0x04)) {
+            memcpy(p_public_key, &g_certificate[i + 3], key_length);
+            *p_public_key_length = key_length;
+            status = PSA_SUCCESS;
+            break;
+        }
+    }
+    xSemaphoreGive(xPsaMutex);
+    return status;
+}
+
+static psa_status_t optiga_psa_check_key(const psa_key_attributes_t * attributes, const uint8_t * key_buffer,
+                                         size_t key_buffer_size, const optiga_psa_key_t ** pp_key)
+{
+    if ((key_buffer_size < sizeof(optiga_psa_key_t)) ||
+        !PSA_KEY_TYPE_IS_ECC_KEY_PAIR(psa_get_key_type(attributes)) ||
+        (PSA_KEY_TYPE_ECC_GET_FAMILY(psa_get_key_type(attributes)) != PSA_ECC_FAMILY_SECP_R1)) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+    *pp_key = (const optiga_psa_key_t *)key_buffer;
+    return PSA_SUCCESS;
+}
+
+// Ephemeral keys are single use, their session context goes back to the pool to be refilled whatever the outcome
+static void optiga_psa_release_ephemeral(const uint8_t * key_buffer, size_t key_buffer_size)
+{
+    const optiga_psa_key_t * p_key = (const optiga_psa_key_t *)key_buffer;
+
+    if ((key_buffer_size >= sizeof(optiga_psa_key_t)) && (p_key->key_oid >= OPTIGA_SESSION_ID_E100)) {
+        optiga_ecdhe_pool_release((optiga_key_id_t)p_key->key_oid, p_key->lease);
+    }
+}
+
+/**********************************************************************************************************************
+ * API IMPLEMENTATION
+ *********************************************************************************************************************/
+psa_status_t optiga_psa_opaque_init(void)
+{
+    if (xPsaMutex == NULL) {
+        xPsaMutex = xSemaphoreCreateMutex();
+        if (xPsaMutex == NULL) {
+            return PSA_ERROR_INSUFFICIENT_MEMORY;
+        }
+    }
+    memset(&g_psa_stats, 0, sizeof(g_psa_stats));
+    return PSA_SUCCESS;
+}
+
+psa_status_t optiga_psa_opaque_get_builtin_key(psa_drv_slot_number_t slot_number, psa_key_attributes_t * attributes,
+                                               uint8_t * key_buffer, size_t key_buffer_size,
+                                               size_t * key_buffer_length)
+{
+    optiga_psa_key_t * p_key = (optiga_psa_key_t *)key_buffer;
+
+    if (slot_number > OPTIGA_PSA_SLOT_E0F3) {
+        return PSA_ERROR_DOES_NOT_EXIST;
+    }
+    if (key_buffer_size < sizeof(optiga_psa_key_t)) {
+        return PSA_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    psa_set_key_type(attributes, PSA_KEY_TYPE_ECC_KEY_PAIR(PSA_ECC_FAMILY_SECP_R1));
+    psa_set_key_bits(attributes, OPTIGA_PSA_BUILTIN_KEY_BITS);
+    psa_set_key_lifetime(attributes, PSA_KEY_LIFETIME_FROM_PERSISTENCE_AND_LOCATION(PSA_KEY_PERSISTENCE_READ_ONLY,
+                                                                                    OPTIGA_PSA_KEY_LOCATION));
+    psa_set_key_usage_flags(attributes, PSA_KEY_USAGE_SIGN_HASH | PSA_KEY_USAGE_DERIVE);
+    psa_set_key_algorithm(attributes, PSA_ALG_ECDSA(PSA_ALG_ANY_HASH));
+
+    memset(p_key, 0, sizeof(optiga_psa_key_t));
+    p_key->key_oid = (uint16_t)(OPTIGA_KEY_STORE_ID_E0F0 + slot_number);
+    p_key->coordinate_size = optiga_psa_coordinate_size(OPTIGA_PSA_BUILTIN_KEY_BITS);
+    *key_buffer_length = sizeof(optiga_psa_key_t);
+    return PSA_SUCCESS;
+}
+
+psa_status_t optiga_psa_opaque_generate_key(const psa_key_attributes_t * attributes, uint8_t * key_buffer,
+                                            size_t key_buffer_size, size_t * key_buffer_length)
+{
+    optiga_psa_key_t * p_key = (optiga_psa_key_t *)key_buffer;
+    uint8_t public_key[OPTIGA_ECDHE_POOL_PUBLIC_KEY_SIZE];
+    uint16_t public_key_length = sizeof(public_key);
+    optiga_key_id_t key_id;
+    uint16_t lease;
+    uint8_t coordinate_size = optiga_psa_coordinate_size(psa_get_key_bits(attributes));
+
+    if (!PSA_KEY_TYPE_IS_ECC_KEY_PAIR(psa_get_key_type(attributes)) ||
+        (PSA_KEY_TYPE_ECC_GET_FAMILY(psa_get_key_type(attributes)) != PSA_ECC_FAMILY_SECP_R1)) {
+        return PSA_ERROR_NOT_SUPPORTED;
+    }
+    if (key_buffer_size < sizeof(optiga_psa_key_t)) {
+        return PSA_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    if (optiga_ecdhe_pool_acquire(&key_id, &lease, public_key, &public_key_length) != OPTIGA_LIB_SUCCESS) {
+        optiga_psa_count(&g_psa_stats.errors);
+        return PSA_ERROR_HARDWARE_FAILURE;
+    }
+
+    /* BIT STRING (03 len 00) wrapping the uncompressed point, the pool curve has to match the request */
+    if ((public_key_length < 4) || (public_key[0] != 0x03) || (public_key[2] != 0x00) ||
+        ((uint16_t)(public_key[1] - 1) != (uint16_t)(1 + 2 * coordinate_size)) ||
+        ((uint16_t)(public_key[1] + 2) > public_key_length)) {
+        optiga_ecdhe_pool_release(key_id, lease);
+        return PSA_ERROR_NOT_SUPPORTED;
+    }
+
+    memset(p_key, 0, sizeof(optiga_psa_key_t));
+    p_key->key_oid = (uint16_t)key_id;
+    p_key->lease = lease;
+    p_key->coordinate_size = coordinate_size;
+    p_key->public_key_length = (uint8_t)(public_key[1] - 1);
+    memcpy(p_key->public_key, &public_key[3], p_key->public_key_length);
+    *key_buffer_length = sizeof(optiga_psa_key_t);
+
+    optiga_psa_count(&g_psa_stats.ephemeral_keys);
+    return PSA_SUCCESS;
+}
+
+psa_status_t optiga_psa_opaque_destroy_key(const psa_key_attributes_t * attributes, const uint8_t * key_buffer,
+                                           size_t key_buffer_size)
+{
+    (void)attributes;
+
+    /* a lease already released by the key agreement is ignored by the pool */
+    optiga_psa_release_ephemeral(key_buffer, key_buffer_size);
+    return PSA_SUCCESS;
+}
+
+psa_status_t optiga_psa_opaque_export_public_key(const psa_key_attributes_t * attributes, const uint8_t * key_buffer,
+                                                 size_t key_buffer_size, uint8_t * data, size_t data_size,
+                                                 size_t * data_length)
+{
+    const optiga_psa_key_t * p_key;
+    uint8_t public_key[OPTIGA_PSA_PUBLIC_KEY_MAX_LENGTH];
+    uint8_t public_key_length;
+    psa_status_t status;
+
+    status = optiga_psa_check_key(attributes, key_buffer, key_buffer_size, &p_key);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    if (p_key->public_key_length != 0) {
+        public_key_length = p_key->public_key_length;
+        memcpy(public_key, p_key->public_key, public_key_length);
+    } else if (p_key->key_oid == OPTIGA_KEY_STORE_ID_E0F0) {
+        status = optiga_psa_certificate_public_key(p_key->coordinate_size, public_key, &public_key_length);
+        if (status != PSA_SUCCESS) {
+            return status;
+        }
+    } else {
+        /* no certificate is associated with the other key store slots */
+        return PSA_ERROR_NOT_SUPPORTED;
+    }
+
+    if (data_size < public_key_length) {
+        return PSA_ERROR_BUFFER_TOO_SMALL;
+    }
+    memcpy(data, public_key, public_key_length);
+    *data_length = public_key_length;
+    return PSA_SUCCESS;
+}
+
+psa_status_t optiga_psa_opaque_sign_hash(const psa_key_attributes_t * attributes, const uint8_t * key_buffer,
+                                         size_t key_buffer_size, psa_algorithm_t alg, const uint8_t * hash,
+                                         size_t hash_length, uint8_t * signature, size_t signature_size,
+                                         size_t * signature_length)
+{
+    const optiga_psa_key_t * p_key;
+    uint8_t digest[OPTIGA_PSA_DIGEST_MAX_LENGTH];
+    uint8_t der_signature[OPTIGA_PSA_DER_SIGNATURE_SIZE];
+    uint16_t der_signature_length = sizeof(der_signature);
+    psa_status_t status;
+
+    status = optiga_psa_check_key(attributes, key_buffer, key_buffer_size, &p_key);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+    if (!PSA_ALG_IS_ECDSA(alg) || (hash_length > sizeof(digest))) {
+        return PSA_ERROR_NOT_SUPPORTED;
+    }
+    if (signature_size < (size_t)(2 * p_key->coordinate_size)) {
+        return PSA_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    /* the host library takes a non-const digest */
+    memcpy(digest, hash, hash_length);
+    if (optiga_crypt_ecdsa_sign(digest, (uint8_t)hash_length, (optiga_key_id_t)p_key->key_oid, der_signature,
+                                &der_signature_length) != OPTIGA_LIB_SUCCESS) {
+        optiga_psa_count(&g_psa_stats.errors);
+        return PSA_ERROR_HARDWARE_FAILURE;
+    }
+
+    status = optiga_psa_signature_to_raw(der_signature, der_signature_length, p_key->coordinate_size, signature);
+    if (status == PSA_SUCCESS) {
+        *signature_length = 2 * p_key->coordinate_size;
+        optiga_psa_count(&g_psa_stats.signatures);
+    }
+    return status;
+}
+
+psa_status_t optiga_psa_opaque_key_agreement(const psa_key_attributes_t * attributes, const uint8_t * key_buffer,
+                                             size_t key_buffer_size, psa_algorithm_t alg, const uint8_t * peer_key,
+                                             size_t peer_key_length, uint8_t * shared_secret,
+                                             size_t shared_secret_size, size_t * shared_secret_length)
+{
+    const optiga_psa_key_t * p_key;
+    uint8_t peer_public_key[3 + OPTIGA_PSA_PUBLIC_KEY_MAX_LENGTH];
+    public_key_from_host_t public_key;
+    optiga_lib_status_t optiga_status;
+    psa_status_t status;
+
+    status = optiga_psa_check_key(attributes, key_buffer, key_buffer_size, &p_key);
+    if (status == PSA_SUCCESS) {
+        if (!PSA_ALG_IS_ECDH(alg)) {
+            status = PSA_ERROR_NOT_SUPPORTED;
+        } else if ((peer_key_length != (size_t)(1 + 2 * p_key->coordinate_size)) || (peer_key[0] != 0x04)) {
+            status = PSA_ERROR_INVALID_ARGUMENT;
+        } else if (shared_secret_size < p_key->coordinate_size) {
+            status = PSA_ERROR_BUFFER_TOO_SMALL;
+        }
+    }
+    if (status != PSA_SUCCESS) {
+        optiga_psa_release_ephemeral(key_buffer, key_buffer_size);
+        return status;
+    }
+
+    /* OPTIGA takes the peer key as BIT STRING */
+    peer_public_key[0] = 0x03;
+    peer_public_key[1] = (uint8_t)(peer_key_length + 1);
+    peer_public_key[2] = 0x00;
+    memcpy(&peer_public_key[3], peer_key, peer_key_length);
+    public_key.public_key = peer_public_key;
+    public_key.length = (uint16_t)(peer_key_length + 3);
+    public_key.curve = (p_key->coordinate_size == 32) ? OPTIGA_ECC_NIST_P_256 : OPTIGA_ECC_NIST_P_384;
+
+    optiga_status = optiga_crypt_ecdh((optiga_key_id_t)p_key->key_oid, &public_key, TRUE, shared_secret);
+
+    optiga_psa_release_ephemeral(key_buffer, key_buffer_size);
+
+    if (optiga_status != OPTIGA_LIB_SUCCESS) {
+        optiga_psa_count(&g_psa_stats.errors);
+        return PSA_ERROR_HARDWARE_FAILURE;
+    }
+    *shared_secret_length = p_key->coordinate_size;
+    optiga_psa_count(&g_psa_stats.key_agreements);
+    return PSA_SUCCESS;
+}
+
+psa_status_t optiga_psa_signature_to_raw(const uint8_t * p_der, uint16_t der_length, uint8_t coordinate_size,
+                                         uint8_t * p_raw)
+{
+    uint16_t offset = 0;
+    uint8_t length;
+    const uint8_t * p_value;
+    uint8_t i;
+
+    if ((der_length > 2) && (p_der[0] == 0x30)) {
+        offset = 2;
+    }
+
+    for (i = 0; i < 2; i++) {
+        if (((offset + 2) > der_length) || (p_der[offset] != 0x02) ||
+            ((offset + 2 + p_der[offset + 1]) > der_length)) {
+            return PSA_ERROR_HARDWARE_FAILURE;
+        }
+        length = p_der[offset + 1];
+        p_value = &p_der[offset + 2];
+        offset += 2 + length;
+
+        /* strip the sign padding */
+        while ((length > coordinate_size) && (*p_value == 0)) {
+            p_value++;
+            length--;
+        }
+        if (length > coordinate_size) {
+            return PSA_ERROR_HARDWARE_FAILURE;
+        }
+        memset(p_raw, 0, coordinate_size - length);
+        memcpy(p_raw + coordinate_size - length, p_value, length);
+        p_raw += coordinate_size;
+    }
+    return PSA_SUCCESS;
+}
+
+void optiga_psa_get_stats(optiga_psa_stats_t * p_stats)
+{
+    taskENTER_CRITICAL();
+    *p_stats = g_psa_stats;
+    taskEXIT_CRITICAL();
+}
+
+/**
+* @}
+*/
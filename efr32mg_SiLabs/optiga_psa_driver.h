@@ -0,0 +1,171 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file declares the PSA Crypto opaque driver for the keys stored in OPTIGA Trust X.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+#ifndef _OPTIGA_PSA_DRIVER_H_
+#define _OPTIGA_PSA_DRIVER_H_
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include "psa/crypto.h"
+
+#include <trustx/optiga/include/optiga/optiga_crypt.h>
+#include <trustx/optiga/include/optiga/pal/pal.h>
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/// PSA key location of the OPTIGA keys (vendor range)
+#ifndef OPTIGA_PSA_KEY_LOCATION
+#define OPTIGA_PSA_KEY_LOCATION             ((psa_key_location_t)0x800001)
+#endif
+
+/// OID of the certificate holding the public key of the built-in keys
+#ifndef OPTIGA_PSA_CERTIFICATE_OID
+#define OPTIGA_PSA_CERTIFICATE_OID          0xE0E0
+#endif
+
+/// Maximum length of an uncompressed public key (NIST P-384)
+#define OPTIGA_PSA_PUBLIC_KEY_MAX_LENGTH    97
+
+/// Built-in key slots, mapped to the OPTIGA key store
+#define OPTIGA_PSA_SLOT_E0F0                0
+#define OPTIGA_PSA_SLOT_E0F1                1
+#define OPTIGA_PSA_SLOT_E0F2                2
+#define OPTIGA_PSA_SLOT_E0F3                3
+
+/**********************************************************************************************************************
+ * ENUMS / STRUCTURES
+ *********************************************************************************************************************/
+/// Key buffer of the opaque keys, only references the key inside OPTIGA
+typedef struct optiga_psa_key {
+    /// Key store or session context OID
+    uint16_t key_oid;
+    /// Lease of the session context from the ephemeral pool, unused for the built-in keys
+    uint16_t lease;
+    /// Size of a coordinate (and of the private key) in bytes
+    uint8_t coordinate_size;
+    /// Length of the uncompressed public key, 0 if it has to be taken from the certificate
+    uint8_t public_key_length;
+    uint8_t public_key[OPTIGA_PSA_PUBLIC_KEY_MAX_LENGTH];
+} optiga_psa_key_t;
+
+/// Driver statistics
+typedef struct optiga_psa_stats {
+    /// Signatures computed by OPTIGA
+    uint32_t signatures;
+    /// Key agreements computed by OPTIGA
+    uint32_t key_agreements;
+    /// Ephemeral keys generated, including the ones taken from the pool
+    uint32_t ephemeral_keys;
+    /// Failed OPTIGA operations
+    uint32_t errors;
+} optiga_psa_stats_t;
+
+/**********************************************************************************************************************
+ * API PROTOTYPES
+ *********************************************************************************************************************/
+/**
+ * PSA driver entry point, initializes the driver. The OPTIGA host library, the cache and the ephemeral pool have to
+ * be initialized before.<br>
+ * The entry points are synchronous: the OPTIGA lock is only held for each command, so other handshakes can run
+ * their host side computation while OPTIGA is busy.
+ */
+psa_status_t optiga_psa_opaque_init(void);
+
+/**
+ * PSA driver entry point, describes a built-in key. The slot numbers are the OPTIGA_PSA_SLOT_* values.
+ */
+psa_status_t optiga_psa_opaque_get_builtin_key(psa_drv_slot_number_t slot_number, psa_key_attributes_t * attributes,
+                                               uint8_t * key_buffer, size_t key_buffer_size,
+                                               size_t * key_buffer_length);
+
+/**
+ * PSA driver entry point, generates an ephemeral ECC key in a session context. Pre-generated keypairs of the
+ * ephemeral pool are used when available. The session context is returned to the pool by the key agreement or
+ * #optiga_psa_opaque_destroy_key, and taken back by the pool after OPTIGA_ECDHE_POOL_LEASE_TIMEOUT_MS otherwise.
+ */
+psa_status_t optiga_psa_opaque_generate_key(const psa_key_attributes_t * attributes, uint8_t * key_buffer,
+                                            size_t key_buffer_size, size_t * key_buffer_length);
+
+/**
+ * PSA driver entry point, destroys a key. The session context of an ephemeral key which was not used for a key
+ * agreement, e.g. after an aborted handshake, goes back to the ephemeral pool. The built-in keys are left as is.
+ */
+psa_status_t optiga_psa_opaque_destroy_key(const psa_key_attributes_t * attributes, const uint8_t * key_buffer,
+                                           size_t key_buffer_size);
+
+/**
+ * PSA driver entry point, exports the public key. The public key of the built-in keys is taken from the (cached)
+ * device certificate.
+ */
+psa_status_t optiga_psa_opaque_export_public_key(const psa_key_attributes_t * attributes, const uint8_t * key_buffer,
+                                                 size_t key_buffer_size, uint8_t * data, size_t data_size,
+                                                 size_t * data_length);
+
+/**
+ * PSA driver entry point, signs a hash with ECDSA. The signature is returned in the raw r||s format of PSA.
+ */
+psa_status_t optiga_psa_opaque_sign_hash(const psa_key_attributes_t * attributes, const uint8_t * key_buffer,
+                                         size_t key_buffer_size, psa_algorithm_t alg, const uint8_t * hash,
+                                         size_t hash_length, uint8_t * signature, size_t signature_size,
+                                         size_t * signature_length);
+
+/**
+ * PSA driver entry point, computes the ECDH shared secret with an uncompressed peer public key.
+ */
+psa_status_t optiga_psa_opaque_key_agreement(const psa_key_attributes_t * attributes, const uint8_t * key_buffer,
+                                             size_t key_buffer_size, psa_algorithm_t alg, const uint8_t * peer_key,
+                                             size_t peer_key_length, uint8_t * shared_secret,
+                                             size_t shared_secret_size, size_t * shared_secret_length);
+
+/**
+ * Converts the INTEGER pair of an OPTIGA signature (with or without SEQUENCE header) to the raw r||s format.
+ *
+ * \param[in]  p_der            Signature returned by OPTIGA
+ * \param[in]  der_length       Length of the signature
+ * \param[in]  coordinate_size  Size of r and s in bytes
+ * \param[out] p_raw            Buffer of 2 * coordinate_size bytes
+ */
+psa_status_t optiga_psa_signature_to_raw(const uint8_t * p_der, uint16_t der_length, uint8_t coordinate_size,
+                                         uint8_t * p_raw);
+
+/**
+ * Returns a snapshot of the driver statistics.
+ */
+void optiga_psa_get_stats(optiga_psa_stats_t * p_stats);
+
+#endif /* _OPTIGA_PSA_DRIVER_H_ */
+
+/**
+* @}
+*/
@@ -0,0 +1,244 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file implements the prefetched pool of OPTIGA TRNG output.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/* Optiga based includes */
+#include <trustx/optiga/include/optiga/optiga_crypt.h>
+#include <trustx/optiga/include/optiga/pal/pal_os_timer.h>
+
+#include "pal_efr32.h"
+#include "optiga_rng_pool.h"
+
+/*********************************************************************************************************************
+ * LOCAL DATA
+ *********************************************************************************************************************/
+static uint8_t g_pool[OPTIGA_RNG_POOL_SIZE];
+/* index of the next byte to serve and number of pooled bytes */
+static uint16_t g_pool_head = 0;
+static uint16_t g_pool_count = 0;
+/* time the oldest pooled bytes were fetched */
+static uint32_t g_pool_oldest_ms = 0;
+static uint32_t g_max_age_ms = OPTIGA_RNG_POOL_DEFAULT_MAX_AGE_MS;
+static optiga_rng_pool_stats_t g_rng_stats;
+
+static SemaphoreHandle_t xRngPoolMutex = NULL;
+
+/* Incremented from the reset listener, the pool is wiped by the next caller */
+static volatile uint32_t g_reset_generation = 0;
+static uint32_t g_pool_generation = 0;
+
+/**********************************************************************************************************************
+ * LOCAL ROUTINES
+ *********************************************************************************************************************/
+static void optiga_rng_pool_wipe(void)
+{
+    memset(g_pool, 0, sizeof(g_pool));
+    g_rng_stats.bytes_discarded += g_pool_count;
+    g_pool_head = 0;
+    g_pool_count = 0;
+}
+
+// Takes the pool lock and applies the reset and age policy
+static void optiga_rng_pool_lock(void)
+{
+    xSemaphoreTake(xRngPoolMutex, portMAX_DELAY);
+
+    if (g_pool_generation != g_reset_generation) {
+        g_pool_generation = g_reset_generation;
+        optiga_rng_pool_wipe();
+    }
+    if ((g_pool_count != 0) && (g_max_age_ms != 0) &&
+        ((pal_os_timer_get_time_in_milliseconds() - g_pool_oldest_ms) >= g_max_age_ms)) {
+        optiga_rng_pool_wipe();
+    }
+}
+
+static void optiga_rng_pool_unlock(void)
+{
+    xSemaphoreGive(xRngPoolMutex);
+}
+
+// Reset listener, runs in the context driving the reset pin and therefore must not take the pool lock
+static void optiga_rng_pool_on_reset(void* p_ctx)
+{
+    (void)p_ctx;
+    g_reset_generation++;
+}
+
+/**********************************************************************************************************************
+ * API IMPLEMENTATION
+ *********************************************************************************************************************/
+pal_status_t optiga_rng_pool_init(uint32_t max_age_ms)
+{
+    if (xRngPoolMutex == NULL) {
+        xRngPoolMutex = xSemaphoreCreateMutex();
+        if (xRngPoolMutex == NULL) {
+            return PAL_STATUS_FAILURE;
+        }
+        if (pal_gpio_register_reset_listener(optiga_rng_pool_on_reset, NULL) != PAL_STATUS_SUCCESS) {
+            return PAL_STATUS_FAILURE;
+        }
+    }
+
+    g_max_age_ms = max_age_ms;
+    memset(g_pool, 0, sizeof(g_pool));
+    g_pool_head = 0;
+    g_pool_count = 0;
+    memset(&g_rng_stats, 0, sizeof(g_rng_stats));
+    return PAL_STATUS_SUCCESS;
+}
+
+optiga_lib_status_t optiga_rng_pool_get(uint8_t * random_data, uint16_t random_data_length)
+{
+    uint8_t chunk[OPTIGA_RNG_MIN_REQUEST_SIZE];
+    optiga_lib_status_t status;
+    uint16_t part;
+
+    optiga_rng_pool_lock();
+    if (g_pool_count >= random_data_length) {
+        while (random_data_length > 0) {
+            part = OPTIGA_RNG_POOL_SIZE - g_pool_head;
+            if (part > random_data_length) {
+                part = random_data_length;
+            }
+            memcpy(random_data, &g_pool[g_pool_head], part);
+            memset(&g_pool[g_pool_head], 0, part);
+
+            g_pool_head = (uint16_t)((g_pool_head + part) % OPTIGA_RNG_POOL_SIZE);
+            g_pool_count -= part;
+            random_data += part;
+            random_data_length -= part;
+        }
+        g_rng_stats.hits++;
+        optiga_rng_pool_unlock();
+        return OPTIGA_LIB_SUCCESS;
+    }
+    g_rng_stats.misses++;
+    optiga_rng_pool_unlock();
+
+    if (random_data_length >= OPTIGA_RNG_MIN_REQUEST_SIZE) {
+        return optiga_crypt_random(OPTIGA_RNG_TYPE_TRNG, random_data, random_data_length);
+    }
+
+    status = optiga_crypt_random(OPTIGA_RNG_TYPE_TRNG, chunk, sizeof(chunk));
+    if (status == OPTIGA_LIB_SUCCESS) {
+        memcpy(random_data, chunk, random_data_length);
+    }
+    memset(chunk, 0, sizeof(chunk));
+    return status;
+}
+
+uint16_t optiga_rng_pool_refill(uint8_t max_commands)
+{
+    uint8_t chunk[OPTIGA_RNG_POOL_CHUNK_SIZE];
+    uint16_t added = 0;
+    uint16_t length;
+    uint16_t tail;
+    uint16_t part;
+    uint16_t offset;
+
+    while ((max_commands-- > 0) && (optiga_rng_pool_deficit() >= OPTIGA_RNG_MIN_REQUEST_SIZE)) {
+        length = optiga_rng_pool_deficit();
+        if (length > sizeof(chunk)) {
+            length = sizeof(chunk);
+        }
+        if (optiga_crypt_random(OPTIGA_RNG_TYPE_TRNG, chunk, length) != OPTIGA_LIB_SUCCESS) {
+            break;
+        }
+
+        optiga_rng_pool_lock();
+        g_rng_stats.refills++;
+        if (g_pool_count == 0) {
+            g_pool_oldest_ms = pal_os_timer_get_time_in_milliseconds();
+        }
+        /* a concurrent refill may have topped the pool up meanwhile, never overrun it */
+        if (length > (OPTIGA_RNG_POOL_SIZE - g_pool_count)) {
+            length = OPTIGA_RNG_POOL_SIZE - g_pool_count;
+        }
+        offset = 0;
+        while (offset < length) {
+            tail = (uint16_t)((g_pool_head + g_pool_count) % OPTIGA_RNG_POOL_SIZE);
+            part = OPTIGA_RNG_POOL_SIZE - tail;
+            if (part > (length - offset)) {
+                part = length - offset;
+            }
+            memcpy(&g_pool[tail], &chunk[offset], part);
+            g_pool_count += part;
+            offset += part;
+        }
+        added += length;
+        optiga_rng_pool_unlock();
+    }
+
+    memset(chunk, 0, sizeof(chunk));
+    return added;
+}
+
+uint16_t optiga_rng_pool_deficit(void)
+{
+    uint16_t deficit;
+
+    optiga_rng_pool_lock();
+    deficit = OPTIGA_RNG_POOL_SIZE - g_pool_count;
+    optiga_rng_pool_unlock();
+
+    return deficit;
+}
+
+pal_status_t optiga_rng_pool_idle_job(void* job_ctx)
+{
+    (void)job_ctx;
+
+    if (optiga_rng_pool_deficit() < OPTIGA_RNG_POOL_CHUNK_SIZE) {
+        return PAL_STATUS_FAILURE;
+    }
+    return (optiga_rng_pool_refill(1) > 0) ? PAL_STATUS_SUCCESS : PAL_STATUS_FAILURE;
+}
+
+void optiga_rng_pool_get_stats(optiga_rng_pool_stats_t * p_stats)
+{
+    optiga_rng_pool_lock();
+    *p_stats = g_rng_stats;
+    optiga_rng_pool_unlock();
+}
+
+/**
+* @}
+*/
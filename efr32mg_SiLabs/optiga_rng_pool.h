@@ -0,0 +1,126 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file declares the prefetched pool of OPTIGA TRNG output.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+#ifndef _OPTIGA_RNG_POOL_H_
+#define _OPTIGA_RNG_POOL_H_
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <trustx/optiga/include/optiga/optiga_util.h>
+#include <trustx/optiga/include/optiga/pal/pal.h>
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/// Size of the random pool in bytes
+#ifndef OPTIGA_RNG_POOL_SIZE
+#define OPTIGA_RNG_POOL_SIZE                256
+#endif
+
+/// Number of bytes requested from OPTIGA per refill command (8 to 256)
+#define OPTIGA_RNG_POOL_CHUNK_SIZE          64
+
+/// Smallest request accepted by the OPTIGA get random command
+#define OPTIGA_RNG_MIN_REQUEST_SIZE         8
+
+/// Default maximum age of pooled random bytes in milliseconds, older bytes are discarded
+#define OPTIGA_RNG_POOL_DEFAULT_MAX_AGE_MS  60000
+
+/**********************************************************************************************************************
+ * ENUMS / STRUCTURES
+ *********************************************************************************************************************/
+/// Random pool statistics
+typedef struct optiga_rng_pool_stats {
+    /// Requests served from the pool
+    uint32_t hits;
+    /// Requests served by a direct OPTIGA command
+    uint32_t misses;
+    /// Refill commands issued
+    uint32_t refills;
+    /// Pooled bytes wiped due to age or OPTIGA reset
+    uint32_t bytes_discarded;
+} optiga_rng_pool_stats_t;
+
+/**********************************************************************************************************************
+ * API PROTOTYPES
+ *********************************************************************************************************************/
+/**
+ * Initializes the (empty) random pool and registers for the OPTIGA reset notification.
+ *
+ * \param[in] max_age_ms    Maximum time random bytes are kept in the pool, 0 disables the age limit
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the pool is initialized
+ * \retval  #PAL_STATUS_FAILURE  Returns when the pool lock cannot be created
+ */
+pal_status_t optiga_rng_pool_init(uint32_t max_age_ms);
+
+/**
+ * Returns random bytes, from the pool if enough bytes are available, otherwise directly from OPTIGA.<br>
+ * Served bytes are wiped from the pool, each byte is handed out only once.
+ *
+ * \param[out] random_data          Buffer for the random bytes
+ * \param[in]  random_data_length   Number of bytes requested
+ */
+optiga_lib_status_t optiga_rng_pool_get(uint8_t * random_data, uint16_t random_data_length);
+
+/**
+ * Tops the pool up with OPTIGA TRNG output and returns the number of bytes added.<br>
+ * Must be called from a task context which is allowed to issue OPTIGA commands (typically the idle scheduler).
+ * The pool lock is not held during the OPTIGA command, so foreground requests are not blocked by a refill.
+ *
+ * \param[in] max_commands  Maximum number of get random commands issued by this call
+ */
+uint16_t optiga_rng_pool_refill(uint8_t max_commands);
+
+/**
+ * Returns the number of bytes missing to a full pool.
+ */
+uint16_t optiga_rng_pool_deficit(void);
+
+/**
+ * Idle scheduler job refilling the pool with one command once at least a chunk is missing.
+ * Fails if nothing was added, so that a failing OPTIGA is retried on the next period only.
+ * See #pal_os_idle_register.
+ */
+pal_status_t optiga_rng_pool_idle_job(void* job_ctx);
+
+/**
+ * Returns a snapshot of the random pool statistics.
+ */
+void optiga_rng_pool_get_stats(optiga_rng_pool_stats_t * p_stats);
+
+#endif /* _OPTIGA_RNG_POOL_H_ */
+
+/**
+* @}
+*/
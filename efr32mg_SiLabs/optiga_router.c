@@ -0,0 +1,416 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file implements the routing of crypto operations between OPTIGA and the EFR32 crypto (PSA).
+*
+* \ingroup  grPAL
+* @{
+*/
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* PSA Crypto of the Gecko SDK, backed by the EFR32 crypto accelerator / Secure Engine */
+#include "psa/crypto.h"
+
+/* Optiga based includes */
+#include <trustx/optiga/include/optiga/optiga_util.h>
+
+#include "pal_efr32.h"
+#include "optiga_rng_pool.h"
+#include "optiga_router.h"
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/* weight of a new sample in the averages of the cost model, 1/2^n */
+#define OPTIGA_ROUTER_EWMA_SHIFT    3
+/* fixed point scaling of the cost model moments, 2^n; the variance of the payload units is a small difference of
+ * large moments, a coarser scaling biases the fitted unit cost */
+#define OPTIGA_ROUTER_FIT_SHIFT     12
+/* smallest variance of the payload units (1/4 unit^2) from which the unit cost is fitted */
+#define OPTIGA_ROUTER_FIT_MIN_VARIANCE  ((int64_t)1 << (OPTIGA_ROUTER_FIT_SHIFT - 2))
+
+/* OPTIGA data object holding the error codes of the last commands, and the code of an invalid signature */
+#define OPTIGA_ROUTER_OID_ERROR_CODES       0xF1C2
+#define OPTIGA_ROUTER_ERROR_INVALID_SIGNATURE   0x2B
+
+/* data passed to OPTIGA per hash update command */
+#define OPTIGA_ROUTER_HASH_CHUNK    256
+
+/* two DER INTEGERs of up to 33 bytes */
+#define OPTIGA_ROUTER_DER_SIGNATURE_SIZE    70
+
+/*********************************************************************************************************************
+ * LOCAL DATA
+ *********************************************************************************************************************/
+/* exponentially weighted moments of the payload units x and the duration y, scaled by 2^OPTIGA_ROUTER_FIT_SHIFT */
+typedef struct {
+    int64_t x;
+    int64_t y;
+    int64_t xx;
+    int64_t xy;
+} optiga_router_fit_t;
+
+static uint8_t g_policy[OPTIGA_ROUTER_OP_COUNT];
+static optiga_router_fit_t g_fit[OPTIGA_ROUTER_OP_COUNT][OPTIGA_ROUTER_ENGINE_COUNT];
+static uint32_t g_decisions[OPTIGA_ROUTER_OP_COUNT];
+static optiga_router_stats_t g_router_stats;
+
+/**********************************************************************************************************************
+ * LOCAL ROUTINES
+ *********************************************************************************************************************/
+static void optiga_router_ewma(int64_t * p_average, int64_t sample, uint8_t first)
+{
+    sample <<= OPTIGA_ROUTER_FIT_SHIFT;
+    if (first) {
+        *p_average = sample;
+    } else {
+        /* rounded, truncation would bias every average downwards */
+        *p_average += (sample - *p_average + (1 << (OPTIGA_ROUTER_EWMA_SHIFT - 1))) >> OPTIGA_ROUTER_EWMA_SHIFT;
+    }
+}
+
+// Fits base and unit cost jointly (least squares over the weighted moments), called with the lock held
+static void optiga_router_fit(optiga_router_engine_stats_t * p_engine, optiga_router_fit_t * p_fit,
+                              uint32_t units, uint32_t duration, uint8_t first)
+{
+    int64_t variance;
+    int64_t covariance;
+    int64_t base;
+
+    optiga_router_ewma(&p_fit->x, units, first);
+    optiga_router_ewma(&p_fit->y, duration, first);
+    optiga_router_ewma(&p_fit->xx, (int64_t)units * units, first);
+    optiga_router_ewma(&p_fit->xy, (int64_t)units * duration, first);
+
+    variance = p_fit->xx - ((p_fit->x * p_fit->x) >> OPTIGA_ROUTER_FIT_SHIFT);
+    covariance = p_fit->xy - ((p_fit->x * p_fit->y) >> OPTIGA_ROUTER_FIT_SHIFT);
+    /* while all payloads have about the same size, the unit cost cannot be told from the base cost */
+    if (variance >= OPTIGA_ROUTER_FIT_MIN_VARIANCE) {
+        p_engine->unit_cost_us = (covariance > 0) ? (uint32_t)((covariance + (variance / 2)) / variance) : 0;
+    }
+    base = (p_fit->y - ((int64_t)p_engine->unit_cost_us * p_fit->x) + (1 << (OPTIGA_ROUTER_FIT_SHIFT - 1))) >>
+           OPTIGA_ROUTER_FIT_SHIFT;
+    /* a zero estimate stands for an engine without samples */
+    p_engine->base_cost_us = (base > 0) ? (uint32_t)base : 1;
+}
+
+static uint32_t optiga_router_estimate(const optiga_router_engine_stats_t * p_engine, uint32_t length)
+{
+    return p_engine->base_cost_us + (p_engine->unit_cost_us * (length / OPTIGA_ROUTER_COST_UNIT_SIZE)) +
+           p_engine->penalty_us;
+}
+
+static uint32_t optiga_router_begin(optiga_router_engine_t engine)
+{
+    if (engine == OPTIGA_ROUTER_ENGINE_OPTIGA) {
+        taskENTER_CRITICAL();
+        g_router_stats.optiga_outstanding++;
+        taskEXIT_CRITICAL();
+    }
+    return pal_os_timer_get_time_in_microseconds();
+}
+
+// Feeds the measured duration into the cost model
+static void optiga_router_end(optiga_router_op_t op, optiga_router_engine_t engine, uint32_t start_us,
+                              uint32_t length, uint8_t failed)
+{
+    optiga_router_engine_stats_t * p_engine = &g_router_stats.engines[op][engine];
+    uint32_t duration = pal_os_timer_get_time_in_microseconds() - start_us;
+
+    taskENTER_CRITICAL();
+    if (engine == OPTIGA_ROUTER_ENGINE_OPTIGA) {
+        g_router_stats.optiga_outstanding--;
+    }
+    p_engine->operations++;
+    if (failed) {
+        /* a failure says nothing about the cost of the operation, but the engine (e.g. OPTIGA absent, PSA not
+         * initialized) must not keep the traffic; it is no longer untried and gets probed only */
+        p_engine->errors++;
+        p_engine->penalty_us = OPTIGA_ROUTER_FAILURE_PENALTY_US;
+    } else {
+        optiga_router_fit(p_engine, &g_fit[op][engine], length / OPTIGA_ROUTER_COST_UNIT_SIZE, duration,
+                          (uint8_t)(p_engine->base_cost_us == 0));
+        p_engine->penalty_us >>= 1;
+    }
+    taskEXIT_CRITICAL();
+}
+
+// Converts r||s to the INTEGER pair expected by OPTIGA
+static uint16_t optiga_router_raw_to_der(const uint8_t * p_raw, uint8_t * p_der)
+{
+    uint16_t offset = 0;
+    uint8_t length;
+    const uint8_t * p_value;
+    uint8_t i;
+
+    for (i = 0; i < 2; i++) {
+        p_value = p_raw + (i * 32);
+        length = 32;
+        while ((length > 1) && (*p_value == 0)) {
+            p_value++;
+            length--;
+        }
+        p_der[offset++] = 0x02;
+        if (*p_value & 0x80) {
+            p_der[offset++] = (uint8_t)(length + 1);
+            p_der[offset++] = 0x00;
+        } else {
+            p_der[offset++] = length;
+        }
+        memcpy(&p_der[offset], p_value, length);
+        offset += length;
+    }
+    return offset;
+}
+
+static pal_status_t optiga_router_sha256_optiga(const uint8_t * p_data, uint32_t length, uint8_t digest[32])
+{
+    uint8_t context_buffer[OPTIGA_HASH_CONTEXT_LENGTH_SHA_256];
+    optiga_hash_context_t hash_context;
+    hash_data_from_host_t data;
+    uint32_t offset = 0;
+
+    hash_context.context_buffer = context_buffer;
+    hash_context.context_buffer_length = sizeof(context_buffer);
+    hash_context.hash_algo = OPTIGA_HASH_TYPE_SHA_256;
+
+    if (optiga_crypt_hash_start(&hash_context) != OPTIGA_LIB_SUCCESS) {
+        return PAL_STATUS_FAILURE;
+    }
+    while (offset < length) {
+        data.buffer = p_data + offset;
+        data.length = ((length - offset) > OPTIGA_ROUTER_HASH_CHUNK) ? OPTIGA_ROUTER_HASH_CHUNK : (length - offset);
+        if (optiga_crypt_hash_update(&hash_context, OPTIGA_CRYPT_HOST_DATA, &data) != OPTIGA_LIB_SUCCESS) {
+            return PAL_STATUS_FAILURE;
+        }
+        offset += data.length;
+    }
+    if (optiga_crypt_hash_finalize(&hash_context, digest) != OPTIGA_LIB_SUCCESS) {
+        return PAL_STATUS_FAILURE;
+    }
+    return PAL_STATUS_SUCCESS;
+}
+
+static pal_status_t optiga_router_verify_host(const uint8_t digest[32], const uint8_t signature[64],
+                                              const uint8_t public_key[65], uint8_t * p_failed)
+{
+    psa_key_attributes_t attributes = PSA_KEY_ATTRIBUTES_INIT;
+    mbedtls_svc_key_id_t key_id;
+    psa_status_t status;
+
+    psa_set_key_type(&attributes, PSA_KEY_TYPE_ECC_PUBLIC_KEY(PSA_ECC_FAMILY_SECP_R1));
+    psa_set_key_bits(&attributes, 256);
+    psa_set_key_usage_flags(&attributes, PSA_KEY_USAGE_VERIFY_HASH);
+    psa_set_key_algorithm(&attributes, PSA_ALG_ECDSA(PSA_ALG_SHA_256));
+
+    if (psa_import_key(&attributes, public_key, 65, &key_id) != PSA_SUCCESS) {
+        *p_failed = 1;
+        return PAL_STATUS_FAILURE;
+    }
+    status = psa_verify_hash(key_id, PSA_ALG_ECDSA(PSA_ALG_SHA_256), digest, 32, signature, 64);
+    (void)psa_destroy_key(key_id);
+
+    /* an invalid signature is a result, not an engine failure */
+    *p_failed = ((status != PSA_SUCCESS) && (status != PSA_ERROR_INVALID_SIGNATURE));
+    return (status == PSA_SUCCESS) ? PAL_STATUS_SUCCESS : PAL_STATUS_FAILURE;
+}
+
+static pal_status_t optiga_router_verify_optiga(const uint8_t digest[32], const uint8_t signature[64],
+                                                const uint8_t public_key[65], uint8_t * p_failed)
+{
+    uint8_t error_code;
+    uint16_t error_code_length = 1;
+    uint8_t der_signature[OPTIGA_ROUTER_DER_SIGNATURE_SIZE];
+    uint8_t der_public_key[3 + 65];
+    uint8_t digest_copy[32];
+    public_key_from_host_t host_public_key;
+    uint16_t der_signature_length;
+
+    /* OPTIGA takes the public key as BIT STRING */
+    der_public_key[0] = 0x03;
+    der_public_key[1] = 65 + 1;
+    der_public_key[2] = 0x00;
+    memcpy(&der_public_key[3], public_key, 65);
+    host_public_key.public_key = der_public_key;
+    host_public_key.length = sizeof(der_public_key);
+    host_public_key.curve = OPTIGA_ECC_NIST_P_256;
+
+    der_signature_length = optiga_router_raw_to_der(signature, der_signature);
+    memcpy(digest_copy, digest, sizeof(digest_copy));
+
+    *p_failed = 0;
+    if (optiga_crypt_ecdsa_verify(digest_copy, sizeof(digest_copy), der_signature, der_signature_length,
+                                  OPTIGA_CRYPT_HOST_DATA, &host_public_key) == OPTIGA_LIB_SUCCESS) {
+        return PAL_STATUS_SUCCESS;
+    }
+
+    /* the return code does not tell an invalid signature from a failure, the last error code of OPTIGA does */
+    *p_failed = ((optiga_util_read_data(OPTIGA_ROUTER_OID_ERROR_CODES, 0, &error_code, &error_code_length) !=
+                  OPTIGA_LIB_SUCCESS) || (error_code_length == 0) ||
+                 (error_code != OPTIGA_ROUTER_ERROR_INVALID_SIGNATURE));
+    return PAL_STATUS_FAILURE;
+}
+
+/**********************************************************************************************************************
+ * API IMPLEMENTATION
+ *********************************************************************************************************************/
+pal_status_t optiga_router_init(void)
+{
+    uint8_t i;
+
+    taskENTER_CRITICAL();
+    for (i = 0; i < OPTIGA_ROUTER_OP_COUNT; i++) {
+        g_policy[i] = OPTIGA_ROUTER_ALLOW_OPTIGA | OPTIGA_ROUTER_ALLOW_HOST;
+        g_decisions[i] = 0;
+    }
+    memset(&g_router_stats, 0, sizeof(g_router_stats));
+    memset(g_fit, 0, sizeof(g_fit));
+    taskEXIT_CRITICAL();
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t optiga_router_set_policy(optiga_router_op_t op, uint8_t allowed)
+{
+    if ((op >= OPTIGA_ROUTER_OP_COUNT) ||
+        ((allowed & (OPTIGA_ROUTER_ALLOW_OPTIGA | OPTIGA_ROUTER_ALLOW_HOST)) == 0)) {
+        return PAL_STATUS_FAILURE;
+    }
+    g_policy[op] = allowed;
+    return PAL_STATUS_SUCCESS;
+}
+
+optiga_router_engine_t optiga_router_select(optiga_router_op_t op, uint32_t length)
+{
+    optiga_router_engine_t faster;
+    uint32_t optiga_cost;
+    uint32_t host_cost;
+    uint32_t decision;
+
+    if (op >= OPTIGA_ROUTER_OP_COUNT) {
+        return OPTIGA_ROUTER_ENGINE_OPTIGA;
+    }
+    if (!(g_policy[op] & OPTIGA_ROUTER_ALLOW_HOST)) {
+        return OPTIGA_ROUTER_ENGINE_OPTIGA;
+    }
+    if (!(g_policy[op] & OPTIGA_ROUTER_ALLOW_OPTIGA)) {
+        return OPTIGA_ROUTER_ENGINE_HOST;
+    }
+
+    taskENTER_CRITICAL();
+    /* routed OPTIGA operations in progress are served first */
+    optiga_cost = optiga_router_estimate(&g_router_stats.engines[op][OPTIGA_ROUTER_ENGINE_OPTIGA], length) *
+                  (1 + (uint32_t)g_router_stats.optiga_outstanding);
+    host_cost = optiga_router_estimate(&g_router_stats.engines[op][OPTIGA_ROUTER_ENGINE_HOST], length);
+    decision = ++g_decisions[op];
+    taskEXIT_CRITICAL();
+
+    /* an engine without samples or failures is tried first, so that both have an estimate */
+    if (optiga_cost == 0) {
+        return OPTIGA_ROUTER_ENGINE_OPTIGA;
+    }
+    if (host_cost == 0) {
+        return OPTIGA_ROUTER_ENGINE_HOST;
+    }
+
+    faster = (optiga_cost < host_cost) ? OPTIGA_ROUTER_ENGINE_OPTIGA : OPTIGA_ROUTER_ENGINE_HOST;
+    if ((decision % OPTIGA_ROUTER_PROBE_INTERVAL) == 0) {
+        return (faster == OPTIGA_ROUTER_ENGINE_OPTIGA) ? OPTIGA_ROUTER_ENGINE_HOST : OPTIGA_ROUTER_ENGINE_OPTIGA;
+    }
+    return faster;
+}
+
+pal_status_t optiga_router_sha256(const uint8_t * p_data, uint32_t length, uint8_t digest[32])
+{
+    optiga_router_engine_t engine = optiga_router_select(OPTIGA_ROUTER_OP_SHA256, length);
+    pal_status_t status;
+    size_t digest_length;
+    uint32_t start_us;
+
+    start_us = optiga_router_begin(engine);
+    if (engine == OPTIGA_ROUTER_ENGINE_OPTIGA) {
+        status = optiga_router_sha256_optiga(p_data, length, digest);
+    } else {
+        status = (psa_hash_compute(PSA_ALG_SHA_256, p_data, length, digest, 32, &digest_length) == PSA_SUCCESS) ?
+                 PAL_STATUS_SUCCESS : PAL_STATUS_FAILURE;
+    }
+    optiga_router_end(OPTIGA_ROUTER_OP_SHA256, engine, start_us, length, (status != PAL_STATUS_SUCCESS));
+    return status;
+}
+
+pal_status_t optiga_router_ecdsa_verify(const uint8_t digest[32], const uint8_t signature[64],
+                                        const uint8_t public_key[65])
+{
+    optiga_router_engine_t engine = optiga_router_select(OPTIGA_ROUTER_OP_ECDSA_VERIFY, 0);
+    pal_status_t status;
+    uint8_t failed = 0;
+    uint32_t start_us;
+
+    start_us = optiga_router_begin(engine);
+    if (engine == OPTIGA_ROUTER_ENGINE_OPTIGA) {
+        status = optiga_router_verify_optiga(digest, signature, public_key, &failed);
+    } else {
+        status = optiga_router_verify_host(digest, signature, public_key, &failed);
+    }
+    optiga_router_end(OPTIGA_ROUTER_OP_ECDSA_VERIFY, engine, start_us, 0, failed);
+    return status;
+}
+
+pal_status_t optiga_router_random(uint8_t * p_data, uint16_t length)
+{
+    optiga_router_engine_t engine = optiga_router_select(OPTIGA_ROUTER_OP_RANDOM, length);
+    pal_status_t status;
+    uint32_t start_us;
+
+    start_us = optiga_router_begin(engine);
+    if (engine == OPTIGA_ROUTER_ENGINE_OPTIGA) {
+        /* served from the prefetched TRNG pool when possible */
+        status = (optiga_rng_pool_get(p_data, length) == OPTIGA_LIB_SUCCESS) ? PAL_STATUS_SUCCESS :
+                 PAL_STATUS_FAILURE;
+    } else {
+        status = (psa_generate_random(p_data, length) == PSA_SUCCESS) ? PAL_STATUS_SUCCESS : PAL_STATUS_FAILURE;
+    }
+    optiga_router_end(OPTIGA_ROUTER_OP_RANDOM, engine, start_us, length, (status != PAL_STATUS_SUCCESS));
+    return status;
+}
+
+void optiga_router_get_stats(optiga_router_stats_t * p_stats)
+{
+    taskENTER_CRITICAL();
+    *p_stats = g_router_stats;
+    taskEXIT_CRITICAL();
+}
+
+/**
+* @}
+*/
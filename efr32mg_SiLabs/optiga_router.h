@@ -0,0 +1,163 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file declares the routing of crypto operations between OPTIGA and the EFR32 crypto (PSA).
+*
+* \ingroup  grPAL
+* @{
+*/
+
+#ifndef _OPTIGA_ROUTER_H_
+#define _OPTIGA_ROUTER_H_
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <trustx/optiga/include/optiga/optiga_crypt.h>
+#include <trustx/optiga/include/optiga/pal/pal.h>
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/// Engines an operation may be routed to, see #optiga_router_set_policy
+#define OPTIGA_ROUTER_ALLOW_OPTIGA          0x01
+#define OPTIGA_ROUTER_ALLOW_HOST            0x02
+
+/// Every n-th routing decision goes to the slower engine, to keep its cost estimate current
+#ifndef OPTIGA_ROUTER_PROBE_INTERVAL
+#define OPTIGA_ROUTER_PROBE_INTERVAL        32
+#endif
+
+/// Penalty added to the estimate of an engine by a failed operation, in microseconds; halved by each success
+#ifndef OPTIGA_ROUTER_FAILURE_PENALTY_US
+#define OPTIGA_ROUTER_FAILURE_PENALTY_US    100000
+#endif
+
+/// Payload size of a cost unit, the cost of an operation is estimated as base + unit cost * length / unit size
+#define OPTIGA_ROUTER_COST_UNIT_SIZE        256
+
+/**********************************************************************************************************************
+ * ENUMS / STRUCTURES
+ *********************************************************************************************************************/
+/// Routed operations
+typedef enum optiga_router_op {
+    OPTIGA_ROUTER_OP_SHA256 = 0,
+    OPTIGA_ROUTER_OP_ECDSA_VERIFY,
+    OPTIGA_ROUTER_OP_RANDOM,
+    OPTIGA_ROUTER_OP_COUNT
+} optiga_router_op_t;
+
+/// Engines
+typedef enum optiga_router_engine {
+    OPTIGA_ROUTER_ENGINE_OPTIGA = 0,
+    /// EFR32 crypto accelerator / Secure Engine through PSA Crypto
+    OPTIGA_ROUTER_ENGINE_HOST,
+    OPTIGA_ROUTER_ENGINE_COUNT
+} optiga_router_engine_t;
+
+/// Cost model and counters of an operation on an engine
+typedef struct optiga_router_engine_stats {
+    /// Fixed cost of an operation in microseconds, 0 until the first sample
+    uint32_t base_cost_us;
+    /// Additional cost per unit of payload in microseconds, fitted jointly with the fixed cost once the payload sizes
+    /// vary
+    uint32_t unit_cost_us;
+    /// Operations routed to the engine
+    uint32_t operations;
+    /// Failed operations
+    uint32_t errors;
+    /// Penalty of the recent failures added to the estimate, in microseconds
+    uint32_t penalty_us;
+} optiga_router_engine_stats_t;
+
+/// Router statistics
+typedef struct optiga_router_stats {
+    optiga_router_engine_stats_t engines[OPTIGA_ROUTER_OP_COUNT][OPTIGA_ROUTER_ENGINE_COUNT];
+    /// Routed OPTIGA operations in progress
+    uint8_t optiga_outstanding;
+} optiga_router_stats_t;
+
+/**********************************************************************************************************************
+ * API PROTOTYPES
+ *********************************************************************************************************************/
+/**
+ * Initializes the router. All operations are allowed on both engines.
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the router is initialized
+ */
+pal_status_t optiga_router_init(void);
+
+/**
+ * Restricts the engines an operation may run on, e.g. to keep the random numbers on the OPTIGA TRNG.
+ *
+ * \param[in] op        Operation
+ * \param[in] allowed   Combination of OPTIGA_ROUTER_ALLOW_OPTIGA and OPTIGA_ROUTER_ALLOW_HOST
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the policy is set
+ * \retval  #PAL_STATUS_FAILURE  Returns when no engine is allowed
+ */
+pal_status_t optiga_router_set_policy(optiga_router_op_t op, uint8_t allowed);
+
+/**
+ * Returns the engine the operation would be routed to for the given payload length.<br>
+ * The estimate of OPTIGA grows with the number of routed OPTIGA operations in progress, so concurrent callers
+ * spread over both engines. An unknown operation is routed to OPTIGA.
+ */
+optiga_router_engine_t optiga_router_select(optiga_router_op_t op, uint32_t length);
+
+/**
+ * Computes the SHA-256 digest of a buffer.
+ */
+pal_status_t optiga_router_sha256(const uint8_t * p_data, uint32_t length, uint8_t digest[32]);
+
+/**
+ * Verifies an ECDSA signature on NIST P-256.
+ *
+ * \param[in] digest            SHA-256 digest to verify
+ * \param[in] signature         Raw signature r||s (64 bytes)
+ * \param[in] public_key        Uncompressed public key 04||X||Y (65 bytes)
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the signature is valid
+ * \retval  #PAL_STATUS_FAILURE  Returns when the signature is invalid or the verification failed
+ */
+pal_status_t optiga_router_ecdsa_verify(const uint8_t digest[32], const uint8_t signature[64],
+                                        const uint8_t public_key[65]);
+
+/**
+ * Fills a buffer with random bytes (TRNG on OPTIGA, CTR-DRBG seeded by the EFR32 TRNG on the host).
+ */
+pal_status_t optiga_router_random(uint8_t * p_data, uint16_t length);
+
+/**
+ * Returns a snapshot of the router statistics.
+ */
+void optiga_router_get_stats(optiga_router_stats_t * p_stats);
+
+#endif /* _OPTIGA_ROUTER_H_ */
+
+/**
+* @}
+*/
@@ -0,0 +1,186 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file implements the monitor of the OPTIGA security event counter (SEC).
+*
+* \ingroup  grPAL
+* @{
+*/
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Optiga based includes */
+#include <trustx/optiga/include/optiga/optiga_util.h>
+#include <trustx/optiga/include/optiga/pal/pal_os_timer.h>
+
+#include "pal_efr32.h"
+#include "optiga_sec_monitor.h"
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/* weight of a new sample in the average command duration, 1/2^n */
+#define OPTIGA_SEC_EWMA_SHIFT   3
+
+/*********************************************************************************************************************
+ * LOCAL DATA
+ *********************************************************************************************************************/
+static optiga_sec_stats_t g_sec_stats;
+static uint32_t g_period_ms = OPTIGA_SEC_DEFAULT_PERIOD_MS;
+static uint8_t g_threshold = OPTIGA_SEC_DEFAULT_THRESHOLD;
+static uint32_t g_last_read_ms = 0;
+static uint32_t g_last_guarded_ms = 0;
+static uint8_t g_observer_registered = 0;
+
+/**********************************************************************************************************************
+ * LOCAL ROUTINES
+ *********************************************************************************************************************/
+static void optiga_sec_ewma(uint32_t * p_average, uint32_t sample)
+{
+    if (*p_average == 0) {
+        *p_average = sample;
+    } else {
+        *p_average = (uint32_t)((int32_t)*p_average + (((int32_t)sample - (int32_t)*p_average) >> OPTIGA_SEC_EWMA_SHIFT));
+    }
+}
+
+// Lock observer, attributes the command duration to the SEC value last read
+static void optiga_sec_on_command(uint32_t acquired_ms, uint32_t hold_time_ms)
+{
+    (void)acquired_ms;
+
+    taskENTER_CRITICAL();
+    if (g_sec_stats.sec == 0) {
+        optiga_sec_ewma(&g_sec_stats.baseline_latency_ms, hold_time_ms);
+    } else {
+        optiga_sec_ewma(&g_sec_stats.elevated_latency_ms, hold_time_ms);
+        g_sec_stats.elevated_commands++;
+        if (hold_time_ms > g_sec_stats.baseline_latency_ms) {
+            g_sec_stats.attributed_delay_ms += hold_time_ms - g_sec_stats.baseline_latency_ms;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**********************************************************************************************************************
+ * API IMPLEMENTATION
+ *********************************************************************************************************************/
+pal_status_t optiga_sec_monitor_init(uint32_t period_ms, uint8_t threshold)
+{
+    if (!g_observer_registered) {
+        if (pal_os_lock_register_observer(optiga_sec_on_command) != PAL_STATUS_SUCCESS) {
+            return PAL_STATUS_FAILURE;
+        }
+        g_observer_registered = 1;
+    }
+
+    memset(&g_sec_stats, 0, sizeof(g_sec_stats));
+    g_period_ms = period_ms;
+    g_threshold = (threshold == 0) ? 1 : threshold;
+    g_last_read_ms = pal_os_timer_get_time_in_milliseconds() - period_ms;
+    return PAL_STATUS_SUCCESS;
+}
+
+optiga_lib_status_t optiga_sec_monitor_refresh(void)
+{
+    optiga_lib_status_t status;
+    uint8_t sec;
+    uint16_t length = sizeof(sec);
+
+    status = optiga_util_read_data(OPTIGA_SEC_OID, 0, &sec, &length);
+    g_last_read_ms = pal_os_timer_get_time_in_milliseconds();
+    if ((status != OPTIGA_LIB_SUCCESS) || (length != sizeof(sec))) {
+        return status;
+    }
+
+    taskENTER_CRITICAL();
+    g_sec_stats.reads++;
+    g_sec_stats.sec = sec;
+    if (sec > g_sec_stats.sec_max) {
+        g_sec_stats.sec_max = sec;
+    }
+    g_sec_stats.state = (sec >= g_threshold) ? OPTIGA_SEC_STATE_THROTTLED : OPTIGA_SEC_STATE_NORMAL;
+    taskEXIT_CRITICAL();
+
+    return status;
+}
+
+pal_status_t optiga_sec_monitor_idle_job(void* job_ctx)
+{
+    (void)job_ctx;
+
+    if ((pal_os_timer_get_time_in_milliseconds() - g_last_read_ms) < g_period_ms) {
+        return PAL_STATUS_FAILURE;
+    }
+    (void)optiga_sec_monitor_refresh();
+    return PAL_STATUS_SUCCESS;
+}
+
+uint32_t optiga_sec_guard_delay(void)
+{
+    uint32_t spacing;
+    uint32_t elapsed;
+
+    if (g_sec_stats.sec < g_threshold) {
+        return 0;
+    }
+
+    /* the further the SEC is above the threshold, the longer OPTIGA needs to decrement it */
+    spacing = OPTIGA_SEC_SPACING_MS * (uint32_t)(g_sec_stats.sec - g_threshold + 1);
+    elapsed = pal_os_timer_get_time_in_milliseconds() - g_last_guarded_ms;
+    return (elapsed >= spacing) ? 0 : (spacing - elapsed);
+}
+
+void optiga_sec_guard(void)
+{
+    uint32_t delay = optiga_sec_guard_delay();
+
+    if (delay > 0) {
+        vTaskDelay(pdMS_TO_TICKS(delay));
+        taskENTER_CRITICAL();
+        g_sec_stats.guard_delay_ms += delay;
+        taskEXIT_CRITICAL();
+    }
+    g_last_guarded_ms = pal_os_timer_get_time_in_milliseconds();
+}
+
+void optiga_sec_monitor_get_stats(optiga_sec_stats_t * p_stats)
+{
+    taskENTER_CRITICAL();
+    *p_stats = g_sec_stats;
+    taskEXIT_CRITICAL();
+}
+
+/**
+* @}
+*/
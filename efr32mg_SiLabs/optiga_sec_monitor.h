@@ -0,0 +1,138 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file declares the monitor of the OPTIGA security event counter (SEC).
+*
+* \ingroup  grPAL
+* @{
+*/
+
+#ifndef _OPTIGA_SEC_MONITOR_H_
+#define _OPTIGA_SEC_MONITOR_H_
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <trustx/optiga/include/optiga/optiga_util.h>
+#include <trustx/optiga/include/optiga/pal/pal.h>
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/// OID of the security event counter
+#define OPTIGA_SEC_OID                      0xE0C5
+
+/// Default period of the background SEC read in milliseconds
+#define OPTIGA_SEC_DEFAULT_PERIOD_MS        30000
+
+/// Default SEC value from which OPTIGA is assumed to throttle
+#define OPTIGA_SEC_DEFAULT_THRESHOLD        1
+
+/// Spacing per SEC step above the threshold between operations which may raise the SEC, in milliseconds
+#ifndef OPTIGA_SEC_SPACING_MS
+#define OPTIGA_SEC_SPACING_MS               500
+#endif
+
+/**********************************************************************************************************************
+ * ENUMS / STRUCTURES
+ *********************************************************************************************************************/
+/// Throttling estimate
+typedef enum optiga_sec_state {
+    /// The SEC is below the threshold
+    OPTIGA_SEC_STATE_NORMAL = 0,
+    /// The SEC reached the threshold, OPTIGA delays the command execution
+    OPTIGA_SEC_STATE_THROTTLED
+} optiga_sec_state_t;
+
+/// SEC statistics
+typedef struct optiga_sec_stats {
+    /// Last SEC value read
+    uint8_t sec;
+    /// Highest SEC value read
+    uint8_t sec_max;
+    /// Throttling estimate
+    optiga_sec_state_t state;
+    /// Number of SEC reads
+    uint32_t reads;
+    /// Average command duration while the SEC was 0, in milliseconds
+    uint32_t baseline_latency_ms;
+    /// Average command duration while the SEC was above 0, in milliseconds
+    uint32_t elevated_latency_ms;
+    /// Commands executed while the SEC was above 0
+    uint32_t elevated_commands;
+    /// Command time exceeding the baseline while the SEC was above 0, in milliseconds
+    uint32_t attributed_delay_ms;
+    /// Time waited by #optiga_sec_guard, in milliseconds
+    uint32_t guard_delay_ms;
+} optiga_sec_stats_t;
+
+/**********************************************************************************************************************
+ * API PROTOTYPES
+ *********************************************************************************************************************/
+/**
+ * Initializes the monitor and registers it as observer of the OPTIGA lock to attribute the command latency.
+ *
+ * \param[in] period_ms     Period of the background SEC read
+ * \param[in] threshold     SEC value from which OPTIGA is considered to throttle
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the monitor is initialized
+ * \retval  #PAL_STATUS_FAILURE  Returns when the lock observer cannot be registered
+ */
+pal_status_t optiga_sec_monitor_init(uint32_t period_ms, uint8_t threshold);
+
+/**
+ * Reads the SEC from OPTIGA.
+ */
+optiga_lib_status_t optiga_sec_monitor_refresh(void);
+
+/**
+ * Idle scheduler job reading the SEC once the period has elapsed. See #pal_os_idle_register.
+ */
+pal_status_t optiga_sec_monitor_idle_job(void* job_ctx);
+
+/**
+ * Returns the time to wait before the next operation which may raise the SEC (e.g. an authentication attempt),
+ * in milliseconds.
+ */
+uint32_t optiga_sec_guard_delay(void);
+
+/**
+ * Waits the time returned by #optiga_sec_guard_delay and records the operation.<br>
+ * To be called before each operation which may raise the SEC, so that OPTIGA has time to decrement the counter
+ * instead of escalating into throttling.
+ */
+void optiga_sec_guard(void);
+
+/**
+ * Returns a snapshot of the SEC statistics.
+ */
+void optiga_sec_monitor_get_stats(optiga_sec_stats_t * p_stats);
+
+#endif /* _OPTIGA_SEC_MONITOR_H_ */
+
+/**
+* @}
+*/
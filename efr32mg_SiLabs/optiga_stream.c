@@ -0,0 +1,245 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file implements the streaming read of OPTIGA data objects into a caller supplied sink.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "optiga_cache.h"
+#include "optiga_stream.h"
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/* metadata: 0x20, length, then tag/length/value entries */
+#define OPTIGA_STREAM_METADATA_TAG      0x20
+#define OPTIGA_STREAM_METADATA_MAX_SIZE 44
+/* tag of the used size of the object */
+#define OPTIGA_STREAM_USED_SIZE_TAG     0xC5
+
+/*********************************************************************************************************************
+ * LOCAL DATA
+ *********************************************************************************************************************/
+/* chunk read by the reader task */
+typedef struct {
+    uint16_t optiga_oid;
+    uint16_t offset;
+    uint16_t requested;
+    uint16_t length;
+    uint8_t buffer;
+    optiga_lib_status_t status;
+} optiga_stream_request_t;
+
+/* the sink consumes one chunk while the next one is read into the other */
+static uint8_t g_chunks[2][OPTIGA_STREAM_CHUNK_SIZE];
+static optiga_stream_request_t g_request;
+static optiga_stream_stats_t g_stream_stats;
+
+static SemaphoreHandle_t xStreamMutex = NULL;
+static SemaphoreHandle_t xStreamStart = NULL;
+static SemaphoreHandle_t xStreamDone = NULL;
+static TaskHandle_t xStreamTaskHandle = NULL;
+
+/**********************************************************************************************************************
+ * LOCAL ROUTINES
+ *********************************************************************************************************************/
+// Returns the used size of the object from its metadata, or OPTIGA_STREAM_TO_END if unknown
+static uint16_t optiga_stream_used_size(uint16_t optiga_oid)
+{
+    uint8_t metadata[OPTIGA_STREAM_METADATA_MAX_SIZE];
+    uint16_t length = sizeof(metadata);
+    uint16_t i;
+
+    if ((optiga_cache_read_metadata(optiga_oid, metadata, &length) != OPTIGA_LIB_SUCCESS) ||
+        (length < 2) || (metadata[0] != OPTIGA_STREAM_METADATA_TAG)) {
+        return OPTIGA_STREAM_TO_END;
+    }
+    if (metadata[1] + 2 < length) {
+        length = (uint16_t)(metadata[1] + 2);
+    }
+
+    for (i = 2; (i + 1) < length; i = (uint16_t)(i + 2 + metadata[i + 1])) {
+        if (metadata[i] != OPTIGA_STREAM_USED_SIZE_TAG) {
+            continue;
+        }
+        if ((metadata[i + 1] == 1) && ((i + 2) < length)) {
+            return metadata[i + 2];
+        }
+        if ((metadata[i + 1] == 2) && ((i + 3) < length)) {
+            return (uint16_t)((metadata[i + 2] << 8) | metadata[i + 3]);
+        }
+        break;
+    }
+    return OPTIGA_STREAM_TO_END;
+}
+
+// Hands the read of the next chunk into the buffer over to the reader task
+static void optiga_stream_issue(uint16_t optiga_oid, uint16_t offset, uint16_t length, uint8_t buffer)
+{
+    g_request.optiga_oid = optiga_oid;
+    g_request.offset = offset;
+    g_request.requested = (length < OPTIGA_STREAM_CHUNK_SIZE) ? length : OPTIGA_STREAM_CHUNK_SIZE;
+    g_request.length = g_request.requested;
+    g_request.buffer = buffer;
+    (void)xSemaphoreGive(xStreamStart);
+}
+
+static void vTaskStreamReader(void * pvParameters)
+{
+    (void)pvParameters;
+
+    do {
+        (void)xSemaphoreTake(xStreamStart, portMAX_DELAY);
+        g_request.status = optiga_cache_read_data(g_request.optiga_oid, g_request.offset,
+                                                  g_chunks[g_request.buffer], &g_request.length);
+        (void)xSemaphoreGive(xStreamDone);
+    } while (1);
+}
+
+/**********************************************************************************************************************
+ * API IMPLEMENTATION
+ *********************************************************************************************************************/
+pal_status_t optiga_stream_init(void)
+{
+    if (xStreamMutex == NULL) {
+        xStreamMutex = xSemaphoreCreateMutex();
+        xStreamStart = xSemaphoreCreateBinary();
+        xStreamDone = xSemaphoreCreateBinary();
+        if ((xStreamMutex == NULL) || (xStreamStart == NULL) || (xStreamDone == NULL)) {
+            return PAL_STATUS_FAILURE;
+        }
+    }
+    if (xStreamTaskHandle == NULL) {
+        if (xTaskCreate(vTaskStreamReader,             /* Function that implements the task. */
+                        "OtxStream",                   /* Text name for the task. */
+                        configMINIMAL_STACK_SIZE * 5,  /* Stack size in words, not bytes. */
+                        NULL,                          /* Parameter passed into the task. */
+                        OPTIGA_STREAM_TASK_PRIORITY,   /* Priority at which the task is created. */
+                        &xStreamTaskHandle) != pdPASS) {
+            return PAL_STATUS_FAILURE;
+        }
+    }
+
+    memset(&g_stream_stats, 0, sizeof(g_stream_stats));
+    return PAL_STATUS_SUCCESS;
+}
+
+optiga_lib_status_t optiga_stream_read(uint16_t optiga_oid, uint16_t offset, uint16_t length,
+                                       optiga_stream_sink_t sink, void * p_ctx)
+{
+    uint16_t used_size = optiga_stream_used_size(optiga_oid);
+    uint16_t start_offset = offset;
+    optiga_lib_status_t status = OPTIGA_LIB_SUCCESS;
+    uint16_t requested;
+    uint16_t chunk_length;
+    uint8_t current = 0;
+    uint8_t pending = 0;
+
+    if (used_size != OPTIGA_STREAM_TO_END) {
+        if (offset >= used_size) {
+            return (length == OPTIGA_STREAM_TO_END) ? OPTIGA_LIB_SUCCESS : OPTIGA_LIB_ERROR;
+        }
+        if ((length == OPTIGA_STREAM_TO_END) || (length > (uint16_t)(used_size - offset))) {
+            length = (uint16_t)(used_size - offset);
+        }
+    }
+
+    xSemaphoreTake(xStreamMutex, portMAX_DELAY);
+    if (length > 0) {
+        optiga_stream_issue(optiga_oid, offset, length, current);
+        pending = 1;
+    }
+    while (pending) {
+        (void)xSemaphoreTake(xStreamDone, portMAX_DELAY);
+        pending = 0;
+        requested = g_request.requested;
+        chunk_length = g_request.length;
+        status = g_request.status;
+        if ((status != OPTIGA_LIB_SUCCESS) && (length == OPTIGA_STREAM_TO_END) && (offset > start_offset)) {
+            /* without a used size, a read past an object ending on a chunk boundary is the end */
+            status = OPTIGA_LIB_SUCCESS;
+            break;
+        }
+        if ((status != OPTIGA_LIB_SUCCESS) || (chunk_length == 0)) {
+            status = OPTIGA_LIB_ERROR;
+            break;
+        }
+
+        offset = (uint16_t)(offset + chunk_length);
+        if (length != OPTIGA_STREAM_TO_END) {
+            length = (uint16_t)(length - chunk_length);
+        }
+        /* a chunk shorter than requested is the end of the object */
+        if ((chunk_length == requested) && (length > 0)) {
+            optiga_stream_issue(optiga_oid, offset, length, (uint8_t)(current ^ 1));
+            pending = 1;
+            g_stream_stats.read_ahead++;
+        }
+
+        if (sink(g_chunks[current], chunk_length, p_ctx) != PAL_STATUS_SUCCESS) {
+            status = OPTIGA_LIB_ERROR;
+            break;
+        }
+        g_stream_stats.chunks++;
+        g_stream_stats.bytes += chunk_length;
+        current ^= 1;
+    }
+    if (pending) {
+        /* the sink stopped the stream, the buffer of the read ahead is reused by the next stream */
+        (void)xSemaphoreTake(xStreamDone, portMAX_DELAY);
+    }
+
+    if (status == OPTIGA_LIB_SUCCESS) {
+        g_stream_stats.streams++;
+    } else {
+        g_stream_stats.errors++;
+    }
+    xSemaphoreGive(xStreamMutex);
+    return status;
+}
+
+void optiga_stream_get_stats(optiga_stream_stats_t * p_stats)
+{
+    xSemaphoreTake(xStreamMutex, portMAX_DELAY);
+    *p_stats = g_stream_stats;
+    xSemaphoreGive(xStreamMutex);
+}
+
+/**
+* @}
+*/
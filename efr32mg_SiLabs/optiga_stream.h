@@ -0,0 +1,122 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file declares the streaming read of OPTIGA data objects into a caller supplied sink.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+#ifndef _OPTIGA_STREAM_H_
+#define _OPTIGA_STREAM_H_
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <trustx/optiga/include/optiga/optiga_util.h>
+#include <trustx/optiga/include/optiga/pal/pal.h>
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/// Bytes read per command, the response fits a single IFX I2C frame of the maximum size. Two chunks are buffered.
+#ifndef OPTIGA_STREAM_CHUNK_SIZE
+#define OPTIGA_STREAM_CHUNK_SIZE    256
+#endif
+
+/// Priority of the reader task, at least the one of the streaming tasks for the read ahead to run during the sink
+#ifndef OPTIGA_STREAM_TASK_PRIORITY
+#define OPTIGA_STREAM_TASK_PRIORITY (tskIDLE_PRIORITY + 2)
+#endif
+
+/// Length passed to #optiga_stream_read to stream up to the end of the object
+#define OPTIGA_STREAM_TO_END        0xFFFF
+
+/**********************************************************************************************************************
+ * ENUMS / STRUCTURES
+ *********************************************************************************************************************/
+/**
+ * Consumer of the streamed data, called once per chunk in order of the offsets.<br>
+ * The chunk is only valid during the call. Returning #PAL_STATUS_FAILURE stops the stream.
+ */
+typedef pal_status_t (*optiga_stream_sink_t)(const uint8_t * p_chunk, uint16_t length, void * p_ctx);
+
+/// Streaming statistics
+typedef struct optiga_stream_stats {
+    /// Completed streams
+    uint32_t streams;
+    /// Chunks delivered to the sinks
+    uint32_t chunks;
+    /// Bytes delivered to the sinks
+    uint32_t bytes;
+    /// Chunks requested from OPTIGA before the sink was called on the previous chunk
+    uint32_t read_ahead;
+    /// Streams stopped by an OPTIGA error or by the sink
+    uint32_t errors;
+} optiga_stream_stats_t;
+
+/**********************************************************************************************************************
+ * API PROTOTYPES
+ *********************************************************************************************************************/
+/**
+ * Initializes the streaming read and starts its reader task.
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the module is initialized
+ * \retval  #PAL_STATUS_FAILURE  Returns when the locks or the reader task cannot be created
+ */
+pal_status_t optiga_stream_init(void);
+
+/**
+ * Reads a data object chunk by chunk into the sink, the RAM used is bounded by two #OPTIGA_STREAM_CHUNK_SIZE chunks
+ * whatever the size of the object.<br>
+ * The chunks are read by a dedicated task, the read of the next chunk is issued before the sink is called on the
+ * current one. If the sink stops the stream, the pending read completes before the function returns.<br>
+ * The reads go through the object cache, see #optiga_cache_read_data. The end of the object is taken from the used
+ * size in its metadata, or from the first chunk shorter than requested. Streams are serialized, the sink must not
+ * start another stream.
+ *
+ * \param[in] optiga_oid    OID of the data object
+ * \param[in] offset        Offset of the first byte
+ * \param[in] length        Number of bytes to stream, or #OPTIGA_STREAM_TO_END
+ * \param[in] sink          Consumer of the data
+ * \param[in] p_ctx         Argument of the sink
+ *
+ * \retval  #OPTIGA_LIB_SUCCESS  Returns when the data was delivered to the sink
+ * \retval  #OPTIGA_LIB_ERROR    Returns when a read failed or the sink stopped the stream
+ */
+optiga_lib_status_t optiga_stream_read(uint16_t optiga_oid, uint16_t offset, uint16_t length,
+                                       optiga_stream_sink_t sink, void * p_ctx);
+
+/**
+ * Returns a snapshot of the streaming statistics.
+ */
+void optiga_stream_get_stats(optiga_stream_stats_t * p_stats);
+
+#endif /* _OPTIGA_STREAM_H_ */
+
+/**
+* @}
+*/
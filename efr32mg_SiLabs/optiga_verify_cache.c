@@ -0,0 +1,333 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file implements the cache of successful peer certificate verifications.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/* PSA Crypto of the Gecko SDK, used for the host side hashing */
+#include "psa/crypto.h"
+
+/* Optiga based includes */
+#include <trustx/optiga/include/optiga/pal/pal_os_timer.h>
+
+#include "optiga_verify_cache.h"
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/* weight of a new sample in the average verification time, 1/2^n */
+#define OPTIGA_VERIFY_CACHE_EWMA_SHIFT  3
+
+/* largest digest accepted by OPTIGA */
+#define OPTIGA_VERIFY_CACHE_DIGEST_MAX_LENGTH   64
+
+/*********************************************************************************************************************
+ * LOCAL DATA
+ *********************************************************************************************************************/
+typedef struct {
+    uint8_t valid;
+    uint16_t anchor_oid;
+    /* SHA-256 of the certificate digest, anchor, TBS digest and signature, i.e. of everything OPTIGA was given */
+    uint8_t key[32];
+    /* identifies the entries of a revoked certificate */
+    uint8_t certificate_digest[32];
+    uint32_t verified_ms;
+    uint32_t last_used_ms;
+} optiga_verify_cache_entry_t;
+
+static optiga_verify_cache_entry_t g_entries[OPTIGA_VERIFY_CACHE_MAX_ENTRIES];
+static uint32_t g_ttl_ms = OPTIGA_VERIFY_CACHE_DEFAULT_TTL_MS;
+static optiga_verify_cache_revocation_t g_revocation_check = NULL;
+static void * g_revocation_ctx = NULL;
+static optiga_verify_cache_stats_t g_vc_stats;
+/* bumped by each invalidation, a verification which overlapped one is not cached */
+static uint32_t g_generation = 0;
+
+static SemaphoreHandle_t xVerifyCacheMutex = NULL;
+
+/**********************************************************************************************************************
+ * LOCAL ROUTINES
+ *********************************************************************************************************************/
+static pal_status_t optiga_verify_cache_digest(const uint8_t * p_certificate, uint16_t certificate_length,
+                                               uint8_t digest[32])
+{
+    size_t length;
+
+    return (psa_hash_compute(PSA_ALG_SHA_256, p_certificate, certificate_length, digest, 32, &length) ==
+            PSA_SUCCESS) ? PAL_STATUS_SUCCESS : PAL_STATUS_FAILURE;
+}
+
+// Computes the cache key, so that a hit stands for the same verification OPTIGA performed
+static pal_status_t optiga_verify_cache_key(const uint8_t certificate_digest[32], uint16_t anchor_oid,
+                                            const uint8_t * p_tbs_digest, uint8_t tbs_digest_length,
+                                            const uint8_t * p_signature, uint16_t signature_length, uint8_t key[32])
+{
+    psa_hash_operation_t operation = PSA_HASH_OPERATION_INIT;
+    uint8_t anchor[2];
+    size_t length;
+
+    anchor[0] = (uint8_t)(anchor_oid >> 8);
+    anchor[1] = (uint8_t)anchor_oid;
+
+    if ((psa_hash_setup(&operation, PSA_ALG_SHA_256) != PSA_SUCCESS) ||
+        (psa_hash_update(&operation, certificate_digest, 32) != PSA_SUCCESS) ||
+        (psa_hash_update(&operation, anchor, sizeof(anchor)) != PSA_SUCCESS) ||
+        (psa_hash_update(&operation, &tbs_digest_length, 1) != PSA_SUCCESS) ||
+        (psa_hash_update(&operation, p_tbs_digest, tbs_digest_length) != PSA_SUCCESS) ||
+        (psa_hash_update(&operation, p_signature, signature_length) != PSA_SUCCESS) ||
+        (psa_hash_finish(&operation, key, 32, &length) != PSA_SUCCESS)) {
+        (void)psa_hash_abort(&operation);
+        return PAL_STATUS_FAILURE;
+    }
+    return PAL_STATUS_SUCCESS;
+}
+
+// Drops the entries of the certificate, returns the number of entries dropped; called with the lock held
+static uint8_t optiga_verify_cache_drop_certificate(const uint8_t certificate_digest[32])
+{
+    uint8_t dropped = 0;
+    uint8_t i;
+
+    for (i = 0; i < OPTIGA_VERIFY_CACHE_MAX_ENTRIES; i++) {
+        if (g_entries[i].valid && (memcmp(g_entries[i].certificate_digest, certificate_digest, 32) == 0)) {
+            g_entries[i].valid = 0;
+            dropped++;
+        }
+    }
+    g_generation++;
+    return dropped;
+}
+
+// Returns the valid entry of the key and anchor, dropping it if expired; called with the lock held
+static optiga_verify_cache_entry_t * optiga_verify_cache_lookup(const uint8_t key[32], uint16_t anchor_oid,
+                                                                uint32_t now)
+{
+    uint8_t i;
+
+    for (i = 0; i < OPTIGA_VERIFY_CACHE_MAX_ENTRIES; i++) {
+        if (g_entries[i].valid && (g_entries[i].anchor_oid == anchor_oid) &&
+            (memcmp(g_entries[i].key, key, 32) == 0)) {
+            if ((now - g_entries[i].verified_ms) >= g_ttl_ms) {
+                g_entries[i].valid = 0;
+                g_vc_stats.expired++;
+                return NULL;
+            }
+            return &g_entries[i];
+        }
+    }
+    return NULL;
+}
+
+// Remembers a verification, evicting the least recently used entry if needed; called with the lock held
+static void optiga_verify_cache_store(const uint8_t key[32], const uint8_t certificate_digest[32],
+                                      uint16_t anchor_oid, uint32_t now)
+{
+    optiga_verify_cache_entry_t * p_entry = NULL;
+    uint8_t i;
+
+    for (i = 0; i < OPTIGA_VERIFY_CACHE_MAX_ENTRIES; i++) {
+        if (!g_entries[i].valid) {
+            p_entry = &g_entries[i];
+            break;
+        }
+        if ((p_entry == NULL) || ((int32_t)(g_entries[i].last_used_ms - p_entry->last_used_ms) < 0)) {
+            p_entry = &g_entries[i];
+        }
+    }
+
+    if (p_entry->valid) {
+        g_vc_stats.evictions++;
+    }
+    p_entry->valid = 1;
+    p_entry->anchor_oid = anchor_oid;
+    memcpy(p_entry->key, key, 32);
+    memcpy(p_entry->certificate_digest, certificate_digest, 32);
+    p_entry->verified_ms = now;
+    p_entry->last_used_ms = now;
+}
+
+/**********************************************************************************************************************
+ * API IMPLEMENTATION
+ *********************************************************************************************************************/
+pal_status_t optiga_verify_cache_init(uint32_t ttl_ms)
+{
+    if (xVerifyCacheMutex == NULL) {
+        xVerifyCacheMutex = xSemaphoreCreateMutex();
+        if (xVerifyCacheMutex == NULL) {
+            return PAL_STATUS_FAILURE;
+        }
+    }
+
+    g_ttl_ms = ttl_ms;
+    memset(g_entries, 0, sizeof(g_entries));
+    memset(&g_vc_stats, 0, sizeof(g_vc_stats));
+    return PAL_STATUS_SUCCESS;
+}
+
+void optiga_verify_cache_set_revocation_check(optiga_verify_cache_revocation_t check, void * p_ctx)
+{
+    xSemaphoreTake(xVerifyCacheMutex, portMAX_DELAY);
+    g_revocation_check = check;
+    g_revocation_ctx = p_ctx;
+    xSemaphoreGive(xVerifyCacheMutex);
+}
+
+pal_status_t optiga_verify_cache_verify(const uint8_t * p_certificate, uint16_t certificate_length,
+                                        const uint8_t * p_tbs_digest, uint8_t tbs_digest_length,
+                                        const uint8_t * p_signature, uint16_t signature_length, uint16_t anchor_oid)
+{
+    optiga_verify_cache_entry_t * p_entry;
+    uint8_t certificate_digest[32];
+    uint8_t key[32];
+    uint8_t tbs_digest[OPTIGA_VERIFY_CACHE_DIGEST_MAX_LENGTH];
+    uint16_t public_key_oid = anchor_oid;
+    optiga_lib_status_t status;
+    uint32_t generation;
+    uint32_t start_ms;
+    uint32_t duration;
+
+    if ((tbs_digest_length > sizeof(tbs_digest)) ||
+        (optiga_verify_cache_digest(p_certificate, certificate_length, certificate_digest) != PAL_STATUS_SUCCESS) ||
+        (optiga_verify_cache_key(certificate_digest, anchor_oid, p_tbs_digest, tbs_digest_length, p_signature,
+                                 signature_length, key) != PAL_STATUS_SUCCESS)) {
+        return PAL_STATUS_FAILURE;
+    }
+
+    /* a revoked certificate fails even if OPTIGA would accept its signature */
+    if ((g_revocation_check != NULL) && g_revocation_check(certificate_digest, g_revocation_ctx)) {
+        xSemaphoreTake(xVerifyCacheMutex, portMAX_DELAY);
+        g_vc_stats.revoked += optiga_verify_cache_drop_certificate(certificate_digest);
+        xSemaphoreGive(xVerifyCacheMutex);
+        return PAL_STATUS_FAILURE;
+    }
+
+    xSemaphoreTake(xVerifyCacheMutex, portMAX_DELAY);
+    start_ms = pal_os_timer_get_time_in_milliseconds();
+    p_entry = optiga_verify_cache_lookup(key, anchor_oid, start_ms);
+    if (p_entry != NULL) {
+        p_entry->last_used_ms = start_ms;
+        g_vc_stats.hits++;
+        g_vc_stats.time_saved_ms += g_vc_stats.verify_time_ms;
+        xSemaphoreGive(xVerifyCacheMutex);
+        return PAL_STATUS_SUCCESS;
+    }
+    g_vc_stats.misses++;
+    generation = g_generation;
+    xSemaphoreGive(xVerifyCacheMutex);
+
+    /* the host library takes non-const buffers */
+    memcpy(tbs_digest, p_tbs_digest, tbs_digest_length);
+    status = optiga_crypt_ecdsa_verify(tbs_digest, tbs_digest_length, (uint8_t *)p_signature, signature_length,
+                                       OPTIGA_CRYPT_OID_DATA, &public_key_oid);
+    if (status != OPTIGA_LIB_SUCCESS) {
+        return PAL_STATUS_FAILURE;
+    }
+
+    xSemaphoreTake(xVerifyCacheMutex, portMAX_DELAY);
+    duration = pal_os_timer_get_time_in_milliseconds() - start_ms;
+    if (g_vc_stats.verify_time_ms == 0) {
+        g_vc_stats.verify_time_ms = duration;
+    } else {
+        g_vc_stats.verify_time_ms = (uint32_t)((int32_t)g_vc_stats.verify_time_ms +
+            (((int32_t)duration - (int32_t)g_vc_stats.verify_time_ms) >> OPTIGA_VERIFY_CACHE_EWMA_SHIFT));
+    }
+    /* the anchor may have been replaced or the certificate revoked while OPTIGA was busy */
+    if (generation == g_generation) {
+        optiga_verify_cache_store(key, certificate_digest, anchor_oid, pal_os_timer_get_time_in_milliseconds());
+    }
+    xSemaphoreGive(xVerifyCacheMutex);
+    return PAL_STATUS_SUCCESS;
+}
+
+void optiga_verify_cache_revoke(const uint8_t * p_certificate, uint16_t certificate_length)
+{
+    uint8_t certificate_digest[32];
+
+    if (optiga_verify_cache_digest(p_certificate, certificate_length, certificate_digest) != PAL_STATUS_SUCCESS) {
+        /* cannot identify the entries, forget everything rather than keep a revoked certificate */
+        optiga_verify_cache_invalidate_all();
+        return;
+    }
+
+    xSemaphoreTake(xVerifyCacheMutex, portMAX_DELAY);
+    g_vc_stats.revoked += optiga_verify_cache_drop_certificate(certificate_digest);
+    xSemaphoreGive(xVerifyCacheMutex);
+}
+
+void optiga_verify_cache_invalidate_anchor(uint16_t anchor_oid)
+{
+    uint8_t i;
+
+    /* called for every object written through optiga_cache, also in builds without verify cache */
+    if (xVerifyCacheMutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(xVerifyCacheMutex, portMAX_DELAY);
+    for (i = 0; i < OPTIGA_VERIFY_CACHE_MAX_ENTRIES; i++) {
+        if (g_entries[i].anchor_oid == anchor_oid) {
+            g_entries[i].valid = 0;
+        }
+    }
+    g_generation++;
+    xSemaphoreGive(xVerifyCacheMutex);
+}
+
+void optiga_verify_cache_invalidate_all(void)
+{
+    xSemaphoreTake(xVerifyCacheMutex, portMAX_DELAY);
+    memset(g_entries, 0, sizeof(g_entries));
+    g_generation++;
+    xSemaphoreGive(xVerifyCacheMutex);
+}
+
+void optiga_verify_cache_get_stats(optiga_verify_cache_stats_t * p_stats)
+{
+    uint32_t verifications;
+
+    xSemaphoreTake(xVerifyCacheMutex, portMAX_DELAY);
+    *p_stats = g_vc_stats;
+    xSemaphoreGive(xVerifyCacheMutex);
+
+    verifications = p_stats->hits + p_stats->misses;
+    p_stats->hit_rate_percent = (verifications == 0) ? 0 : (uint8_t)((p_stats->hits * 100) / verifications);
+}
+
+/**
+* @}
+*/
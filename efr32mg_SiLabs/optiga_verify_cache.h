@@ -0,0 +1,148 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file declares the cache of successful peer certificate verifications.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+#ifndef _OPTIGA_VERIFY_CACHE_H_
+#define _OPTIGA_VERIFY_CACHE_H_
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <trustx/optiga/include/optiga/optiga_crypt.h>
+#include <trustx/optiga/include/optiga/pal/pal.h>
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/// Maximum number of remembered verifications
+#ifndef OPTIGA_VERIFY_CACHE_MAX_ENTRIES
+#define OPTIGA_VERIFY_CACHE_MAX_ENTRIES     8
+#endif
+
+/// Default lifetime of a remembered verification in milliseconds
+#define OPTIGA_VERIFY_CACHE_DEFAULT_TTL_MS  (60UL * 60UL * 1000UL)
+
+/**********************************************************************************************************************
+ * ENUMS / STRUCTURES
+ *********************************************************************************************************************/
+/**
+ * Revocation check invoked before each verification, including the ones answered from the cache.<br>
+ * Returns non zero if the certificate with the given SHA-256 digest is revoked.
+ */
+typedef uint8_t (*optiga_verify_cache_revocation_t)(const uint8_t certificate_digest[32], void * p_ctx);
+
+/// Verification cache statistics
+typedef struct optiga_verify_cache_stats {
+    /// Verifications answered from the cache
+    uint32_t hits;
+    /// Verifications performed by OPTIGA
+    uint32_t misses;
+    /// Entries dropped because their lifetime elapsed
+    uint32_t expired;
+    /// Entries dropped because the certificate was revoked
+    uint32_t revoked;
+    /// Entries dropped to make room for new ones
+    uint32_t evictions;
+    /// Average duration of an OPTIGA verification in milliseconds
+    uint32_t verify_time_ms;
+    /// Estimated OPTIGA time saved by the hits in milliseconds
+    uint32_t time_saved_ms;
+    /// hits * 100 / (hits + misses)
+    uint8_t hit_rate_percent;
+} optiga_verify_cache_stats_t;
+
+/**********************************************************************************************************************
+ * API PROTOTYPES
+ *********************************************************************************************************************/
+/**
+ * Initializes the cache.
+ *
+ * \param[in] ttl_ms    Lifetime of a remembered verification
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the cache is initialized
+ * \retval  #PAL_STATUS_FAILURE  Returns when the cache lock cannot be created
+ */
+pal_status_t optiga_verify_cache_init(uint32_t ttl_ms);
+
+/**
+ * Registers the revocation check, NULL disables it.
+ */
+void optiga_verify_cache_set_revocation_check(optiga_verify_cache_revocation_t check, void * p_ctx);
+
+/**
+ * Verifies the signature of a certificate with the public key of a trust anchor stored in OPTIGA.<br>
+ * A successful verification is remembered for the exact certificate, anchor, TBS digest and signature, repeated
+ * calls are answered without OPTIGA. The cache does not parse the certificate, the caller must take the TBS digest
+ * and the signature from it; a hit only stands for what OPTIGA verified.<br>
+ * A verification overlapping an invalidation or revocation is not remembered.
+ *
+ * \param[in] p_certificate         DER encoded certificate, identifies the entries for the revocation
+ * \param[in] certificate_length    Length of the certificate
+ * \param[in] p_tbs_digest          Digest of the to-be-signed part of the certificate
+ * \param[in] tbs_digest_length     Length of the digest
+ * \param[in] p_signature           DER encoded signature of the certificate
+ * \param[in] signature_length      Length of the signature
+ * \param[in] anchor_oid            OID of the trust anchor certificate
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the signature is valid
+ * \retval  #PAL_STATUS_FAILURE  Returns when the signature is invalid, the certificate is revoked or the
+ *                               verification failed
+ */
+pal_status_t optiga_verify_cache_verify(const uint8_t * p_certificate, uint16_t certificate_length,
+                                        const uint8_t * p_tbs_digest, uint8_t tbs_digest_length,
+                                        const uint8_t * p_signature, uint16_t signature_length, uint16_t anchor_oid);
+
+/**
+ * Forgets the verifications of a certificate.
+ */
+void optiga_verify_cache_revoke(const uint8_t * p_certificate, uint16_t certificate_length);
+
+/**
+ * Forgets the verifications against a trust anchor. Called by #optiga_cache_write_data and
+ * #optiga_cache_write_metadata for the written object, hence also for the write-back buffer.
+ */
+void optiga_verify_cache_invalidate_anchor(uint16_t anchor_oid);
+
+/**
+ * Forgets all verifications.
+ */
+void optiga_verify_cache_invalidate_all(void);
+
+/**
+ * Returns a snapshot of the cache statistics.
+ */
+void optiga_verify_cache_get_stats(optiga_verify_cache_stats_t * p_stats);
+
+#endif /* _OPTIGA_VERIFY_CACHE_H_ */
+
+/**
+* @}
+*/
@@ -0,0 +1,290 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file implements the write-back buffer for small, frequently updated OPTIGA data objects.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/* Optiga based includes */
+#include <trustx/optiga/include/optiga/optiga_util.h>
+#include <trustx/optiga/include/optiga/pal/pal_os_timer.h>
+
+#include "optiga_cache.h"
+#include "optiga_writeback.h"
+
+/*********************************************************************************************************************
+ * LOCAL DATA
+ *********************************************************************************************************************/
+/* buffered write of a data object */
+typedef struct {
+    uint16_t oid;
+    uint16_t length;
+    uint8_t  pending;
+    /* time of the first buffered write, the window starts here */
+    uint32_t first_write_ms;
+    uint8_t  data[OPTIGA_WRITEBACK_MAX_DATA_SIZE];
+} optiga_writeback_slot_t;
+
+static optiga_writeback_slot_t g_slots[OPTIGA_WRITEBACK_MAX_SLOTS];
+static optiga_writeback_stats_t g_wb_stats;
+static uint32_t g_window_ms = OPTIGA_WRITEBACK_DEFAULT_WINDOW_MS;
+
+static SemaphoreHandle_t xWritebackMutex = NULL;
+
+/**********************************************************************************************************************
+ * LOCAL ROUTINES
+ *********************************************************************************************************************/
+static optiga_writeback_slot_t * optiga_writeback_lookup(uint16_t optiga_oid)
+{
+    uint8_t i;
+
+    for (i = 0; i < OPTIGA_WRITEBACK_MAX_SLOTS; i++) {
+        if ((g_slots[i].pending != 0) && (g_slots[i].oid == optiga_oid)) {
+            return &g_slots[i];
+        }
+    }
+    return NULL;
+}
+
+// Writes the buffered data, the slot stays pending if the write fails
+static optiga_lib_status_t optiga_writeback_commit(optiga_writeback_slot_t * p_slot)
+{
+    optiga_lib_status_t status;
+
+    status = optiga_cache_write_data(p_slot->oid, OPTIGA_UTIL_ERASE_AND_WRITE, 0, p_slot->data, p_slot->length);
+    if (status == OPTIGA_LIB_SUCCESS) {
+        p_slot->pending = 0;
+        g_wb_stats.writes_issued++;
+    } else {
+        g_wb_stats.write_errors++;
+    }
+    return status;
+}
+
+// Writes the data directly to OPTIGA
+static optiga_lib_status_t optiga_writeback_write_through(uint16_t optiga_oid, const uint8_t * buffer, uint16_t length)
+{
+    optiga_lib_status_t status;
+
+    status = optiga_cache_write_data(optiga_oid, OPTIGA_UTIL_ERASE_AND_WRITE, 0, (uint8_t *)buffer, length);
+    if (status == OPTIGA_LIB_SUCCESS) {
+        g_wb_stats.writes_issued++;
+    } else {
+        g_wb_stats.write_errors++;
+    }
+    return status;
+}
+
+// Returns a free slot, flushing the oldest pending write if all slots are in use
+static optiga_writeback_slot_t * optiga_writeback_allocate(void)
+{
+    optiga_writeback_slot_t * p_oldest = NULL;
+    uint8_t i;
+
+    for (i = 0; i < OPTIGA_WRITEBACK_MAX_SLOTS; i++) {
+        if (g_slots[i].pending == 0) {
+            return &g_slots[i];
+        }
+        if ((p_oldest == NULL) ||
+            ((int32_t)(g_slots[i].first_write_ms - p_oldest->first_write_ms) < 0)) {
+            p_oldest = &g_slots[i];
+        }
+    }
+
+    if (optiga_writeback_commit(p_oldest) != OPTIGA_LIB_SUCCESS) {
+        return NULL;
+    }
+    return p_oldest;
+}
+
+/**********************************************************************************************************************
+ * API IMPLEMENTATION
+ *********************************************************************************************************************/
+pal_status_t optiga_writeback_init(uint32_t window_ms)
+{
+    if (xWritebackMutex == NULL) {
+        xWritebackMutex = xSemaphoreCreateMutex();
+        if (xWritebackMutex == NULL) {
+            return PAL_STATUS_FAILURE;
+        }
+    }
+
+    g_window_ms = window_ms;
+    memset(g_slots, 0, sizeof(g_slots));
+    memset(&g_wb_stats, 0, sizeof(g_wb_stats));
+    return PAL_STATUS_SUCCESS;
+}
+
+optiga_lib_status_t optiga_writeback_write(uint16_t optiga_oid, const uint8_t * buffer, uint16_t length)
+{
+    optiga_lib_status_t status = OPTIGA_LIB_SUCCESS;
+    optiga_writeback_slot_t * p_slot;
+
+    xSemaphoreTake(xWritebackMutex, portMAX_DELAY);
+    g_wb_stats.writes_requested++;
+
+    if (length > OPTIGA_WRITEBACK_MAX_DATA_SIZE) {
+        /* not bufferable, drop a pending older version and write through */
+        p_slot = optiga_writeback_lookup(optiga_oid);
+        if (p_slot != NULL) {
+            p_slot->pending = 0;
+        }
+        status = optiga_writeback_write_through(optiga_oid, buffer, length);
+        xSemaphoreGive(xWritebackMutex);
+        return status;
+    }
+
+    p_slot = optiga_writeback_lookup(optiga_oid);
+    if (p_slot == NULL) {
+        p_slot = optiga_writeback_allocate();
+        if (p_slot == NULL) {
+            /* the oldest write failed, keep it and write this one through */
+            status = optiga_writeback_write_through(optiga_oid, buffer, length);
+            xSemaphoreGive(xWritebackMutex);
+            return status;
+        }
+        p_slot->oid = optiga_oid;
+        p_slot->first_write_ms = pal_os_timer_get_time_in_milliseconds();
+        p_slot->pending = 1;
+    }
+
+    memcpy(p_slot->data, buffer, length);
+    p_slot->length = length;
+
+    xSemaphoreGive(xWritebackMutex);
+    return status;
+}
+
+optiga_lib_status_t optiga_writeback_read(uint16_t optiga_oid, uint8_t * buffer, uint16_t * length)
+{
+    optiga_writeback_slot_t * p_slot;
+
+    xSemaphoreTake(xWritebackMutex, portMAX_DELAY);
+    p_slot = optiga_writeback_lookup(optiga_oid);
+    if (p_slot != NULL) {
+        if (*length > p_slot->length) {
+            *length = p_slot->length;
+        }
+        memcpy(buffer, p_slot->data, *length);
+        xSemaphoreGive(xWritebackMutex);
+        return OPTIGA_LIB_SUCCESS;
+    }
+    xSemaphoreGive(xWritebackMutex);
+
+    return optiga_cache_read_data(optiga_oid, 0, buffer, length);
+}
+
+optiga_lib_status_t optiga_writeback_flush(uint16_t optiga_oid)
+{
+    optiga_lib_status_t status = OPTIGA_LIB_SUCCESS;
+    optiga_writeback_slot_t * p_slot;
+
+    xSemaphoreTake(xWritebackMutex, portMAX_DELAY);
+    p_slot = optiga_writeback_lookup(optiga_oid);
+    if (p_slot != NULL) {
+        status = optiga_writeback_commit(p_slot);
+    }
+    xSemaphoreGive(xWritebackMutex);
+
+    return status;
+}
+
+optiga_lib_status_t optiga_writeback_flush_all(void)
+{
+    optiga_lib_status_t status = OPTIGA_LIB_SUCCESS;
+    uint8_t i;
+
+    xSemaphoreTake(xWritebackMutex, portMAX_DELAY);
+    for (i = 0; i < OPTIGA_WRITEBACK_MAX_SLOTS; i++) {
+        if ((g_slots[i].pending != 0) && (optiga_writeback_commit(&g_slots[i]) != OPTIGA_LIB_SUCCESS)) {
+            status = OPTIGA_LIB_ERROR;
+        }
+    }
+    xSemaphoreGive(xWritebackMutex);
+
+    return status;
+}
+
+void optiga_writeback_process(void)
+{
+    uint32_t now = pal_os_timer_get_time_in_milliseconds();
+    uint8_t i;
+
+    xSemaphoreTake(xWritebackMutex, portMAX_DELAY);
+    for (i = 0; i < OPTIGA_WRITEBACK_MAX_SLOTS; i++) {
+        if ((g_slots[i].pending != 0) && ((now - g_slots[i].first_write_ms) >= g_window_ms)) {
+            (void)optiga_writeback_commit(&g_slots[i]);
+        }
+    }
+    xSemaphoreGive(xWritebackMutex);
+}
+
+pal_status_t optiga_writeback_idle_job(void* job_ctx)
+{
+    pal_status_t status = PAL_STATUS_FAILURE;
+    uint32_t now = pal_os_timer_get_time_in_milliseconds();
+    uint8_t i;
+
+    (void)job_ctx;
+
+    xSemaphoreTake(xWritebackMutex, portMAX_DELAY);
+    for (i = 0; i < OPTIGA_WRITEBACK_MAX_SLOTS; i++) {
+        if ((g_slots[i].pending != 0) && ((now - g_slots[i].first_write_ms) >= g_window_ms)) {
+            if (optiga_writeback_commit(&g_slots[i]) == OPTIGA_LIB_SUCCESS) {
+                status = PAL_STATUS_SUCCESS;
+            }
+            break;
+        }
+    }
+    xSemaphoreGive(xWritebackMutex);
+
+    return status;
+}
+
+void optiga_writeback_get_stats(optiga_writeback_stats_t * p_stats)
+{
+    xSemaphoreTake(xWritebackMutex, portMAX_DELAY);
+    *p_stats = g_wb_stats;
+    xSemaphoreGive(xWritebackMutex);
+
+    p_stats->coalescing_ratio_percent = (p_stats->writes_issued == 0) ? 0 :
+                                        ((p_stats->writes_requested * 100) / p_stats->writes_issued);
+}
+
+/**
+* @}
+*/
@@ -0,0 +1,136 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file declares the write-back buffer for small, frequently updated OPTIGA data objects.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+#ifndef _OPTIGA_WRITEBACK_H_
+#define _OPTIGA_WRITEBACK_H_
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include <trustx/optiga/include/optiga/optiga_util.h>
+#include <trustx/optiga/include/optiga/pal/pal.h>
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/// Number of data objects which can be buffered at the same time
+#ifndef OPTIGA_WRITEBACK_MAX_SLOTS
+#define OPTIGA_WRITEBACK_MAX_SLOTS          4
+#endif
+
+/// Largest object which can be buffered
+#ifndef OPTIGA_WRITEBACK_MAX_DATA_SIZE
+#define OPTIGA_WRITEBACK_MAX_DATA_SIZE      64
+#endif
+
+/// Default coalescing window in milliseconds
+#define OPTIGA_WRITEBACK_DEFAULT_WINDOW_MS  10000
+
+/**********************************************************************************************************************
+ * ENUMS / STRUCTURES
+ *********************************************************************************************************************/
+/// Write-back statistics
+typedef struct optiga_writeback_stats {
+    /// Writes requested by the application
+    uint32_t writes_requested;
+    /// Writes issued to OPTIGA
+    uint32_t writes_issued;
+    /// Failed writes to OPTIGA, the data stays buffered
+    uint32_t write_errors;
+    /// writes_requested * 100 / writes_issued
+    uint32_t coalescing_ratio_percent;
+} optiga_writeback_stats_t;
+
+/**********************************************************************************************************************
+ * API PROTOTYPES
+ *********************************************************************************************************************/
+/**
+ * Initializes the write-back buffer.
+ *
+ * \param[in] window_ms     Time a buffered write may be delayed to coalesce further writes to the same OID
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the buffer is initialized
+ * \retval  #PAL_STATUS_FAILURE  Returns when the buffer lock cannot be created
+ */
+pal_status_t optiga_writeback_init(uint32_t window_ms);
+
+/**
+ * Buffers a write replacing the complete data object (erase and write from offset 0).<br>
+ * A following write to the same OID within the window replaces the buffered data. If no slot is available the
+ * oldest buffered write is flushed first.
+ *
+ * \param[in] optiga_oid    OID of the data object
+ * \param[in] buffer        Object data
+ * \param[in] length        Object length, at most #OPTIGA_WRITEBACK_MAX_DATA_SIZE
+ *
+ * \retval  #OPTIGA_LIB_SUCCESS  Returns when the data is buffered
+ * \retval  error code of optiga_util_write_data if the object is too large and the direct write fails
+ */
+optiga_lib_status_t optiga_writeback_write(uint16_t optiga_oid, const uint8_t * buffer, uint16_t length);
+
+/**
+ * Reads the data object, the buffered data is returned if a write is pending.
+ */
+optiga_lib_status_t optiga_writeback_read(uint16_t optiga_oid, uint8_t * buffer, uint16_t * length);
+
+/**
+ * Writes the pending data of the OID to OPTIGA.
+ */
+optiga_lib_status_t optiga_writeback_flush(uint16_t optiga_oid);
+
+/**
+ * Writes all pending data to OPTIGA, to be called on demand or from the power-down notification.
+ */
+optiga_lib_status_t optiga_writeback_flush_all(void);
+
+/**
+ * Writes the pending data whose coalescing window has elapsed.<br>
+ * Must be called periodically from a task context which is allowed to issue OPTIGA commands. It must not be called
+ * from a pal_os_event callback, since the OPTIGA host library waits for the events dispatched by that task.
+ */
+void optiga_writeback_process(void);
+
+/**
+ * Idle scheduler job writing one buffered object whose window has elapsed. See #pal_os_idle_register.
+ */
+pal_status_t optiga_writeback_idle_job(void* job_ctx);
+
+/**
+ * Returns a snapshot of the write-back statistics.
+ */
+void optiga_writeback_get_stats(optiga_writeback_stats_t * p_stats);
+
+#endif /* _OPTIGA_WRITEBACK_H_ */
+
+/**
+* @}
+*/
@@ -0,0 +1,534 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file declares the EFR32 specific configuration and extensions of the platform abstraction layer.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+#ifndef _PAL_EFR32_H_
+#define _PAL_EFR32_H_
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+/* Optiga based includes */
+#include <trustx/optiga/include/optiga/pal/pal.h>
+#include <trustx/optiga/include/optiga/pal/pal_gpio.h>
+#include <trustx/optiga/include/optiga/pal/pal_i2c.h>
+#include <trustx/optiga/include/optiga/pal/pal_os_event.h>
+#include <trustx/optiga/include/optiga/comms/optiga_comms.h>
+#include <trustx/optiga/include/optiga/ifx_i2c/ifx_i2c_config.h>
+
+#include "sl_i2cspm.h"
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/**
+ * Enables the pipelined I2C mode.<br>
+ * The transfers are interrupt driven and pal_i2c_write/pal_i2c_read return as soon as the frame is queued, so the
+ * host can prepare the next request while the current frame is on the bus. pal_i2c_init sets the I2C interrupt
+ * to configMAX_SYSCALL_INTERRUPT_PRIORITY, as its handler uses the FreeRTOS FromISR API.
+ */
+#ifndef PAL_I2C_PIPELINED
+#define PAL_I2C_PIPELINED           0
+#endif
+
+/// Number of frame buffers in the pool, at most 32
+#ifndef PAL_FRAME_POOL_SIZE
+#define PAL_FRAME_POOL_SIZE         4
+#endif
+
+/// Alignment of the frame buffers, for word and DMA access
+#define PAL_FRAME_ALIGNMENT         4
+
+/// Handle returned by #pal_frame_alloc when the pool is exhausted
+#define PAL_FRAME_INVALID_HANDLE    0xFF
+
+/// Resolution of the oneshot timers of pal_os_event: the FreeRTOS tick period in microseconds
+#define PAL_OS_TICK_US              (1000000UL / configTICK_RATE_HZ)
+
+/**
+ * Minimum time between the end of an I2C transfer and the start of the next one required by OPTIGA, in microseconds.
+ * <br>The guard time is enforced by pal_i2c, hence oneshot callbacks of at most this delay are queued to the event
+ * handler task right away instead of starting a (one tick minimum) timer.
+ */
+#ifndef PAL_I2C_GUARD_TIME_US
+#define PAL_I2C_GUARD_TIME_US       50
+#endif
+
+/// Longest I2C transfer: the largest IFX I2C frame supported by Trust X (277 bytes) plus the register address
+#define PAL_I2C_MAX_TRANSFER_LENGTH (0x0115 + 1)
+
+/// Number of transfer descriptors used in the pipelined mode (current and next frame)
+#define PAL_I2C_PIPELINE_DEPTH      2
+
+/**
+ * Enables the radio coexistence scheduling of the I2C transfers.<br>
+ * Non urgent transfers which would overlap a radio busy window published with #pal_i2c_coex_add_window are
+ * deferred to the end of the window. The status polls and other register accesses are not urgent, the command
+ * frames and response reads through the data register go ahead regardless of the radio. The deferred transfer is
+ * restarted from a dedicated FreeRTOS timer (at least one tick later) in the event handler task.
+ */
+#ifndef PAL_I2C_COEX
+#define PAL_I2C_COEX                0
+#endif
+
+/// Maximum number of radio busy windows known at a time
+#define PAL_I2C_COEX_MAX_WINDOWS    4
+
+/// Longest deferral of a transfer in microseconds, the transfer then goes ahead regardless of the radio
+#ifndef PAL_I2C_COEX_MAX_DEFER_US
+#define PAL_I2C_COEX_MAX_DEFER_US   10000
+#endif
+
+/**
+ * Enables the prediction of the OPTIGA command durations.<br>
+ * The duration of each command and payload size is learned from the I2C traffic, the status poll timer of the IFX
+ * I2C physical layer is then set to expire just before the predicted completion and backs off geometrically after.
+ * <br>The poll delays are whole ticks (#PAL_OS_TICK_US). With a tick period of at least the physical layer interval
+ * the first poll cannot be earlier than without the predictor, the predictor then only saves the early polls.
+ */
+#ifndef PAL_I2C_POLL_PREDICTOR
+#define PAL_I2C_POLL_PREDICTOR      0
+#endif
+
+/// Maximum number of learned command and payload size classes
+#define PAL_I2C_POLL_MAX_CLASSES    16
+
+/// Completions of a class observed before its prediction is used
+#define PAL_I2C_POLL_MIN_SAMPLES    2
+
+/**
+ * Poll interval of the IFX I2C physical layer (PL_POLLING_INVERVAL_US), used both to poll I2C_STATE while OPTIGA is
+ * busy and to retry a NACKed transfer. Only oneshot timers of this delay are taken as polls by the predictor.
+ */
+#ifndef PAL_I2C_POLL_INTERVAL_US
+#define PAL_I2C_POLL_INTERVAL_US    1000
+#endif
+
+/// Poll interval after the predicted completion, doubled on each poll up to #PAL_I2C_POLL_BACKOFF_MAX_US, rounded up
+/// to whole ticks
+#define PAL_I2C_POLL_BACKOFF_MIN_US 1000
+#define PAL_I2C_POLL_BACKOFF_MAX_US 4000
+
+/**
+ * Computes the CRC of the IFX I2C frames with the GPCRC peripheral. Without it, and while the GPCRC is in use by
+ * another context, the CRC is computed with tables (slicing-by-8).
+ */
+#ifndef PAL_CRC_GPCRC
+#define PAL_CRC_GPCRC               1
+#endif
+
+/// Shortest frame handed to the GPCRC, the tables are faster than its set up for control frames
+#define PAL_CRC_GPCRC_MIN_LENGTH    16
+
+/// Number of OPTIGA chips of the build, their contexts are listed in the chip tables of pal_ifx_i2c_config.c
+#ifndef PAL_OPTIGA_CHIP_COUNT
+#define PAL_OPTIGA_CHIP_COUNT       1
+#endif
+
+/**
+ * Specializes the I2C PAL for a single OPTIGA chip on the sensor I2CSPM instance.<br>
+ * The bus and its context are then compile time constants instead of being looked up through the #pal_i2c_t context,
+ * and the context is not checked against NULL, the upper layer always passes the context of pal_ifx_i2c_config.c.
+ */
+#ifndef PAL_I2C_SINGLE_INSTANCE
+#define PAL_I2C_SINGLE_INSTANCE     0
+#endif
+
+#if ((PAL_I2C_SINGLE_INSTANCE == 1) && (PAL_OPTIGA_CHIP_COUNT > 1))
+#error "PAL_I2C_SINGLE_INSTANCE requires PAL_OPTIGA_CHIP_COUNT 1"
+#endif
+
+/// Number of GPIO ports handled by the bulk pin updates
+#define PAL_GPIO_MAX_PORTS          12
+
+/// Maximum number of listeners notified when the OPTIGA reset line is asserted
+#define PAL_GPIO_MAX_RESET_LISTENERS    4
+
+/// Maximum number of background jobs of the idle scheduler
+#define PAL_OS_IDLE_MAX_JOBS            8
+
+/// Time without foreground OPTIGA activity before background jobs are started, in milliseconds
+#ifndef PAL_OS_IDLE_QUIET_TIME_MS
+#define PAL_OS_IDLE_QUIET_TIME_MS       20
+#endif
+
+/// Priority of the idle scheduler task, just above the FreeRTOS idle task
+#define PAL_OS_IDLE_TASK_PRIORITY       (tskIDLE_PRIORITY + 1)
+
+/// Maximum number of observers of the OPTIGA lock
+#define PAL_OS_LOCK_MAX_OBSERVERS       4
+
+/**********************************************************************************************************************
+ * ENUMS / STRUCTURES
+ *********************************************************************************************************************/
+/**
+ * Context of the I2C master, referenced by pal_i2c_t.p_i2c_hw_config.<br>
+ * p_bitrate is updated by pal_i2c_set_bitrate in Hz.
+ */
+typedef struct {
+    sl_i2cspm_t *sl_i2cspm_sensor;
+    uint32_t p_bitrate;
+} i2c_ctx_t;
+
+/// Context of a GPIO pin, referenced by pal_gpio_t.p_gpio_hw
+typedef struct {
+    uint8_t         p_pin;
+    uint8_t         p_port_name;
+    uint8_t         p_init_flag;
+} gpio_ctx_t;
+
+/**
+ * Observer of the OPTIGA lock, invoked on each release with the time the lock was acquired and how long it was
+ * held (i.e. the duration of the OPTIGA command), both in milliseconds.
+ */
+typedef void (*pal_os_lock_observer_t)(uint32_t acquired_ms, uint32_t hold_time_ms);
+
+/**
+ * Background job of the idle scheduler.<br>
+ * A job performs at most one OPTIGA command per call, so that a foreground request waits for at most one command.
+ * It returns #PAL_STATUS_SUCCESS if it did some work and #PAL_STATUS_FAILURE if there was nothing to do.
+ */
+typedef pal_status_t (*pal_os_idle_job_t)(void* job_ctx);
+
+/// Idle scheduler statistics
+typedef struct pal_os_idle_stats {
+    /// Job calls which did some work
+    uint32_t jobs_run;
+    /// Foreground lock requests which had to wait for a background job
+    uint32_t foreground_delayed;
+    /// Total time foreground lock requests waited for background jobs, in milliseconds
+    uint32_t foreground_delay_ms;
+    /// Longest wait of a foreground lock request for a background job, in milliseconds
+    uint32_t foreground_delay_max_ms;
+} pal_os_idle_stats_t;
+
+/// Radio coexistence statistics
+typedef struct pal_i2c_coex_stats {
+    /// Busy windows published by the radio stack
+    uint32_t windows;
+    /// Transfers deferred to the end of a busy window
+    uint32_t deferred;
+    /// Total time the transfers were deferred, in microseconds
+    uint32_t deferred_time_us;
+    /// Transfers started while the radio was busy, after #PAL_I2C_COEX_MAX_DEFER_US or if the retry timer failed
+    uint32_t forced;
+    /// Command frames and response reads started while the radio was busy, they are never deferred
+    uint32_t urgent;
+    /// Transfers which overlapped a busy window, e.g. published while the transfer was on the bus
+    uint32_t collisions;
+} pal_i2c_coex_stats_t;
+
+/// Handle of a frame buffer of the pool
+typedef uint8_t pal_frame_handle_t;
+
+/// Frame buffer pool statistics
+typedef struct pal_frame_pool_stats {
+    /// Buffers handed out
+    uint32_t allocations;
+    /// Allocations which failed because all buffers were in use
+    uint32_t exhausted;
+    /// Buffers currently in use
+    uint8_t in_use;
+    /// Largest number of buffers in use at a time
+    uint8_t high_water;
+} pal_frame_pool_stats_t;
+
+/// Poll prediction statistics
+typedef struct pal_i2c_poll_stats {
+    /// Commands whose completion was observed
+    uint32_t commands;
+    /// Status polls while a command was pending
+    uint32_t polls;
+    /// Status polls which found OPTIGA still executing the command
+    uint32_t early_polls;
+    /// Polls saved by waiting longer than the physical layer interval, as applied by the tick based timer
+    uint32_t polls_avoided;
+    /// Latency saved by polling earlier than the physical layer interval as applied by the tick based timer, in
+    /// microseconds
+    uint32_t latency_saved_us;
+} pal_i2c_poll_stats_t;
+
+/**********************************************************************************************************************
+ * API PROTOTYPES
+ *********************************************************************************************************************/
+/**
+ * Queues the callback to the event handler task without starting a timer.
+ *
+ * \param[in] callback              Callback function pointer
+ * \param[in] callback_args         Callback arguments
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the callback is queued
+ * \retval  #PAL_STATUS_FAILURE  Returns when the callback queue is full, the entries reserved for the interrupt
+ *                               handlers are not available to #pal_os_event_post
+ */
+pal_status_t pal_os_event_post(register_callback callback, void* callback_args);
+
+/**
+ * ISR variant of #pal_os_event_post.<br>
+ * #PAL_I2C_PIPELINE_DEPTH queue entries are reserved for the interrupt handlers, and as many callbacks are kept
+ * aside for the handler task if the queue is full nevertheless.
+ *
+ * \param[in] callback              Callback function pointer
+ * \param[in] callback_args         Callback arguments
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the callback is queued
+ * \retval  #PAL_STATUS_FAILURE  Returns when the callback queue and the reserved entries are full
+ */
+pal_status_t pal_os_event_post_from_isr(register_callback callback, void* callback_args);
+
+/**
+ * Returns the current time in microseconds. The value wraps around after about 71 minutes, use differences only.
+ */
+uint32_t pal_os_timer_get_time_in_microseconds(void);
+
+/**
+ * Takes a frame buffer of #PAL_I2C_MAX_TRANSFER_LENGTH bytes from the pool. Can be called from interrupt context.
+ *
+ * \param[out] p_handle     Handle of the buffer, #PAL_FRAME_INVALID_HANDLE on failure
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when a buffer is allocated
+ * \retval  #PAL_STATUS_FAILURE  Returns when all buffers are in use
+ */
+pal_status_t pal_frame_alloc(pal_frame_handle_t * p_handle);
+
+/**
+ * Returns a frame buffer to the pool. Can be called from interrupt context.
+ */
+void pal_frame_free(pal_frame_handle_t handle);
+
+/**
+ * Returns the data of a frame buffer, NULL for an invalid or freed handle.
+ */
+uint8_t * pal_frame_data(pal_frame_handle_t handle);
+
+/**
+ * Returns the length of the frame held by a buffer, 0 for an invalid or freed handle.
+ */
+uint16_t pal_frame_length(pal_frame_handle_t handle);
+
+/**
+ * Sets the length of the frame held by a buffer.
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the length is set
+ * \retval  #PAL_STATUS_FAILURE  Returns when the handle is invalid or freed, or the length exceeds the buffer
+ */
+pal_status_t pal_frame_set_length(pal_frame_handle_t handle, uint16_t length);
+
+/**
+ * Returns a snapshot of the frame buffer pool statistics.
+ */
+void pal_frame_pool_get_stats(pal_frame_pool_stats_t * p_stats);
+
+/**
+ * Writes the frame held by a pool buffer to the I2C slave, without copying it. The buffer is owned by the PAL until
+ * the upper layer handler is invoked, it stays allocated and is freed by the caller.<br>
+ * Returns #PAL_STATUS_FAILURE for an invalid or freed handle, otherwise identical to pal_i2c_write.
+ */
+pal_status_t pal_i2c_write_frame(pal_i2c_t* p_i2c_context, pal_frame_handle_t handle);
+
+/**
+ * Reads a frame from the I2C slave directly into a pool buffer and sets its length. The buffer is owned by the PAL
+ * until the upper layer handler is invoked, the frame can then be passed up by handle and is freed by its consumer.
+ * <br>Returns #PAL_STATUS_FAILURE for an invalid or freed handle, otherwise identical to pal_i2c_read.
+ */
+pal_status_t pal_i2c_read_frame(pal_i2c_t* p_i2c_context, pal_frame_handle_t handle, uint16_t length);
+
+/**
+ * Publishes an upcoming radio busy window, e.g. a scheduled RX slot or a TX. Transfers which would overlap the window
+ * are deferred to its end.<br>
+ * Can be called from interrupt context. Windows which ended are dropped, if all slots are in use the oldest window is
+ * replaced.
+ *
+ * \param[in] start_us      Start of the window, see #pal_os_timer_get_time_in_microseconds
+ * \param[in] duration_us   Length of the window in microseconds
+ */
+void pal_i2c_coex_add_window(uint32_t start_us, uint32_t duration_us);
+
+/**
+ * Drops all published busy windows, e.g. when the radio schedule is cancelled.
+ */
+void pal_i2c_coex_clear_windows(void);
+
+/**
+ * Returns a snapshot of the radio coexistence statistics.
+ */
+void pal_i2c_coex_get_stats(pal_i2c_coex_stats_t * p_stats);
+
+/**
+ * Poll predictor bookkeeping, called by pal_i2c with each completed or failed transfer before the upper layer is
+ * notified. A failed status poll is OPTIGA NACKing the poll while it is busy.
+ */
+void pal_i2c_poll_observe(const pal_i2c_t* p_i2c_context, uint8_t is_read, uint8_t is_error,
+                          const uint8_t* p_data, uint16_t length);
+
+/**
+ * Poll predictor hook of pal_os_event_register_callback_oneshot, returns the delay of the timer.<br>
+ * Only the poll timer of the physical layer is adjusted: the next timer of #PAL_I2C_POLL_INTERVAL_US registered for
+ * the I2C context after a status poll found OPTIGA busy. Other timers keep their delay.
+ */
+uint32_t pal_i2c_poll_adjust_delay(const void* callback_args, uint32_t time_us);
+
+/**
+ * Returns a snapshot of the poll prediction statistics.
+ */
+void pal_i2c_poll_get_stats(pal_i2c_poll_stats_t * p_stats);
+
+/**
+ * Returns the CRC-16 of the IFX I2C data link layer (CCITT polynomial, reflected, initial value 0), a drop-in for the
+ * bytewise calculation of the data link layer. Can be called from interrupt context.
+ *
+ * \param[in] p_data    Frame header and payload
+ * \param[in] length    Length of the data
+ */
+uint16_t pal_crc16(const uint8_t* p_data, uint16_t length);
+
+/**
+ * Drives several pins to the same level with one port write per GPIO port, e.g. to reset all OPTIGA chips at once.
+ * <br>The reset listeners are notified if a reset pin of the chip tables is driven low.
+ *
+ * \param[in] pp_gpio_contexts  Pins to drive
+ * \param[in] count             Number of pins
+ * \param[in] level             0 for low, high otherwise
+ */
+void pal_gpio_set_bulk(pal_gpio_t * const * pp_gpio_contexts, uint8_t count, uint8_t level);
+
+/**
+ * Registers a listener which is invoked whenever the reset line of an OPTIGA chip of the chip tables is asserted.<br>
+ * The listener is called from the context driving the reset pin (typically the event handler task), so it must
+ * not block and must not issue OPTIGA commands.
+ *
+ * \param[in] callback              Callback function pointer
+ * \param[in] callback_args         Callback arguments
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the listener is registered
+ * \retval  #PAL_STATUS_FAILURE  Returns when all listener slots are in use
+ */
+pal_status_t pal_gpio_register_reset_listener(register_callback callback, void* callback_args);
+
+/**
+ * Creates the idle scheduler task.
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the task is created
+ * \retval  #PAL_STATUS_FAILURE  Returns when the task cannot be created
+ */
+pal_status_t pal_os_idle_init(void);
+
+/**
+ * Registers a background job.
+ *
+ * \param[in] job           Job function
+ * \param[in] job_ctx       Job argument
+ * \param[in] priority      Jobs with a higher value run first
+ * \param[in] period_ms     Time to wait before the job is called again after it had nothing to do
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the job is registered
+ * \retval  #PAL_STATUS_FAILURE  Returns when the job table is full
+ */
+pal_status_t pal_os_idle_register(pal_os_idle_job_t job, void* job_ctx, uint8_t priority, uint32_t period_ms);
+
+/**
+ * Makes a registered job due immediately, e.g. when work was queued for it. The job runs as soon as the CPU is idle
+ * and there is no foreground OPTIGA activity.
+ */
+void pal_os_idle_trigger(pal_os_idle_job_t job);
+
+/**
+ * Wakes the idle scheduler when a job is due, to be called from vApplicationIdleHook.
+ */
+void pal_os_idle_hook(void);
+
+/**
+ * Returns non zero if called from a background job of the idle scheduler.
+ */
+uint8_t pal_os_idle_in_background(void);
+
+/**
+ * Returns non zero if a foreground OPTIGA request is pending and background work has to yield.
+ */
+uint8_t pal_os_idle_should_yield(void);
+
+/**
+ * Returns a snapshot of the idle scheduler statistics.
+ */
+void pal_os_idle_get_stats(pal_os_idle_stats_t * p_stats);
+
+/**
+ * Registers an observer of the OPTIGA lock.<br>
+ * The observer runs in the context of the task releasing the lock and must not issue OPTIGA commands.
+ *
+ * \retval  #PAL_STATUS_SUCCESS  Returns when the observer is registered
+ * \retval  #PAL_STATUS_FAILURE  Returns when all observer slots are in use
+ */
+pal_status_t pal_os_lock_register_observer(pal_os_lock_observer_t observer);
+
+/**
+ * Selects the OPTIGA chip which the commands of the calling task are sent to, a single task at a time may select a
+ * chip other than 0.<br>
+ * pal_os_lock_acquire, called by the host library at the start of each command, sets the comms context of the
+ * chip from #optiga_comms_table, the commands of the other tasks go to chip 0. Each chip keeps its own IFX I2C
+ * protocol state in its context.
+ *
+ * \param[in] chip  Index of the chip in the chip tables, 0 to restore the default
+ */
+void pal_os_lock_select_chip(uint8_t chip);
+
+/**
+ * Lock bookkeeping of the idle scheduler, called by pal_os_lock.<br>
+ * pal_os_idle_lock_requested returns the request timestamp and whether a background job held the lock at that
+ * time, both are passed on to pal_os_idle_lock_acquired.
+ */
+uint32_t pal_os_idle_lock_requested(uint8_t * p_background_held);
+void pal_os_idle_lock_acquired(uint32_t requested_ms, uint8_t background_held);
+void pal_os_idle_lock_released(void);
+
+/**********************************************************************************************************************
+ * CHIP TABLES
+ *********************************************************************************************************************/
+/// Context of the I2C bus shared by the OPTIGA chips
+extern i2c_ctx_t i2c_ctx;
+
+/// I2C contexts of the OPTIGA chips, indexed by chip
+extern pal_i2c_t * const optiga_pal_i2c_table[PAL_OPTIGA_CHIP_COUNT];
+
+/// Reset pins of the OPTIGA chips, indexed by chip
+extern pal_gpio_t * const optiga_reset_table[PAL_OPTIGA_CHIP_COUNT];
+
+/// IFX I2C protocol contexts of the OPTIGA chips, indexed by chip
+extern ifx_i2c_context_t * const optiga_ifx_i2c_table[PAL_OPTIGA_CHIP_COUNT];
+
+/// Comms contexts of the OPTIGA chips, indexed by chip. Chip 0 uses optiga_comms of the application.
+extern optiga_comms_t * const optiga_comms_table[PAL_OPTIGA_CHIP_COUNT];
+
+#endif /* _PAL_EFR32_H_ */
+
+/**
+* @}
+*/
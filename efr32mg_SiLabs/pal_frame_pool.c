@@ -0,0 +1,152 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file implements the pool of IFX I2C frame buffers handed over between the PAL and the upper layers.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+#include "em_common.h"
+#include "em_core.h"
+
+#include "pal_efr32.h"
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/* buffer size rounded up so that each buffer of the pool is aligned */
+#define PAL_FRAME_BUFFER_SIZE   ((PAL_I2C_MAX_TRANSFER_LENGTH + PAL_FRAME_ALIGNMENT - 1) & \
+                                 ~(PAL_FRAME_ALIGNMENT - 1))
+
+/* the allocated buffers are tracked in a 32 bit mask */
+#if (PAL_FRAME_POOL_SIZE > 32)
+#error "PAL_FRAME_POOL_SIZE must be at most 32"
+#endif
+
+/*********************************************************************************************************************
+ * LOCAL DATA
+ *********************************************************************************************************************/
+SL_ALIGN(PAL_FRAME_ALIGNMENT)
+static uint8_t g_frame_buffers[PAL_FRAME_POOL_SIZE][PAL_FRAME_BUFFER_SIZE] SL_ATTRIBUTE_ALIGN(PAL_FRAME_ALIGNMENT);
+static uint16_t g_frame_lengths[PAL_FRAME_POOL_SIZE];
+/* bit n set if buffer n is allocated */
+static uint32_t g_frame_allocated = 0;
+
+static pal_frame_pool_stats_t g_frame_stats;
+
+/**********************************************************************************************************************
+ * LOCAL ROUTINES
+ *********************************************************************************************************************/
+// Returns non zero if the handle refers to an allocated buffer, freed buffers may already be reused
+static uint8_t pal_frame_is_allocated(pal_frame_handle_t handle)
+{
+    return (uint8_t)((handle < PAL_FRAME_POOL_SIZE) && (g_frame_allocated & (1UL << handle)));
+}
+
+/**********************************************************************************************************************
+ * API IMPLEMENTATION
+ *********************************************************************************************************************/
+pal_status_t pal_frame_alloc(pal_frame_handle_t * p_handle)
+{
+    pal_frame_handle_t handle;
+    CORE_DECLARE_IRQ_STATE;
+
+    CORE_ENTER_ATOMIC();
+    for (handle = 0; handle < PAL_FRAME_POOL_SIZE; handle++) {
+        if (!(g_frame_allocated & (1UL << handle))) {
+            break;
+        }
+    }
+    if (handle == PAL_FRAME_POOL_SIZE) {
+        g_frame_stats.exhausted++;
+        CORE_EXIT_ATOMIC();
+        *p_handle = PAL_FRAME_INVALID_HANDLE;
+        return PAL_STATUS_FAILURE;
+    }
+    g_frame_allocated |= (1UL << handle);
+    g_frame_lengths[handle] = 0;
+    g_frame_stats.allocations++;
+    g_frame_stats.in_use++;
+    if (g_frame_stats.in_use > g_frame_stats.high_water) {
+        g_frame_stats.high_water = g_frame_stats.in_use;
+    }
+    CORE_EXIT_ATOMIC();
+
+    *p_handle = handle;
+    return PAL_STATUS_SUCCESS;
+}
+
+void pal_frame_free(pal_frame_handle_t handle)
+{
+    CORE_DECLARE_IRQ_STATE;
+
+    if (handle >= PAL_FRAME_POOL_SIZE) {
+        return;
+    }
+
+    CORE_ENTER_ATOMIC();
+    if (g_frame_allocated & (1UL << handle)) {
+        g_frame_allocated &= ~(1UL << handle);
+        g_frame_stats.in_use--;
+    }
+    CORE_EXIT_ATOMIC();
+}
+
+uint8_t * pal_frame_data(pal_frame_handle_t handle)
+{
+    return pal_frame_is_allocated(handle) ? g_frame_buffers[handle] : NULL;
+}
+
+uint16_t pal_frame_length(pal_frame_handle_t handle)
+{
+    return pal_frame_is_allocated(handle) ? g_frame_lengths[handle] : 0;
+}
+
+pal_status_t pal_frame_set_length(pal_frame_handle_t handle, uint16_t length)
+{
+    if (!pal_frame_is_allocated(handle) || (length > PAL_I2C_MAX_TRANSFER_LENGTH)) {
+        return PAL_STATUS_FAILURE;
+    }
+    g_frame_lengths[handle] = length;
+    return PAL_STATUS_SUCCESS;
+}
+
+void pal_frame_pool_get_stats(pal_frame_pool_stats_t * p_stats)
+{
+    CORE_DECLARE_IRQ_STATE;
+
+    CORE_ENTER_ATOMIC();
+    *p_stats = g_frame_stats;
+    CORE_EXIT_ATOMIC();
+}
+
+/**
+* @}
+*/
@@ -38,15 +38,46 @@
 #include <trustx/optiga/include/optiga/pal/pal_gpio.h>
 #include "em_gpio.h"
 
+#include "pal_efr32.h"
+
 /**********************************************************************************************************************
  * LOCAL DATA
  *********************************************************************************************************************/
-/* gpio context */
+/* listeners notified on OPTIGA reset */
 typedef struct {
-    uint8_t         p_pin;
-    uint8_t         p_port_name;
-    uint8_t         p_init_flag;
-} gpio_ctx_t;
+    register_callback clb;
+    void * clb_ctx;
+} pal_gpio_reset_listener_t;
+
+static pal_gpio_reset_listener_t g_reset_listeners[PAL_GPIO_MAX_RESET_LISTENERS];
+
+/**********************************************************************************************************************
+ * LOCAL ROUTINES
+ *********************************************************************************************************************/
+// Notifies the registered listeners that the OPTIGA is being reset
+static void pal_gpio_notify_reset(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < PAL_GPIO_MAX_RESET_LISTENERS; i++) {
+        if (g_reset_listeners[i].clb != NULL) {
+            g_reset_listeners[i].clb(g_reset_listeners[i].clb_ctx);
+        }
+    }
+}
+
+// Returns non zero if the pin is the reset line of one of the OPTIGA chips
+static uint8_t pal_gpio_is_optiga_reset(const pal_gpio_t* p_gpio_context)
+{
+    uint8_t i;
+
+    for (i = 0; i < PAL_OPTIGA_CHIP_COUNT; i++) {
+        if (p_gpio_context == optiga_reset_table[i]) {
+            return 1;
+        }
+    }
+    return 0;
+}
 
 /**********************************************************************************************************************
  * API IMPLEMENTATION
@@ -95,7 +126,89 @@ void pal_gpio_set_low(const pal_gpio_t* p_gpio_context)
             current_ctx->p_init_flag = 1;
         }
         GPIO_PinOutClear(current_ctx->p_port_name, current_ctx->p_pin);
+        if (pal_gpio_is_optiga_reset(p_gpio_context)) {
+            pal_gpio_notify_reset();
+        }
+    }
+}
+
+/**
+* Drives several pins to the same level
+*
+* <b>API Details:</b>
+*      The pins are grouped by port and each port is written once, so that pins of the same port change at the same
+*      time.<br>
+*      Pins without a valid gpio context are skipped.<br>
+*
+*\param[in] pp_gpio_contexts Pins to drive
+*\param[in] count            Number of pins
+*\param[in] level            0 for low, high otherwise
+*/
+void pal_gpio_set_bulk(pal_gpio_t * const * pp_gpio_contexts, uint8_t count, uint8_t level)
+{
+    uint32_t port_masks[PAL_GPIO_MAX_PORTS] = {0};
+    gpio_ctx_t *current_ctx;
+    uint8_t notify = 0;
+    uint8_t i;
+
+    for (i = 0; i < count; i++) {
+        if ((pp_gpio_contexts[i] == NULL) || (pp_gpio_contexts[i]->p_gpio_hw == NULL)) {
+            continue;
+        }
+        current_ctx = (gpio_ctx_t*)(pp_gpio_contexts[i]->p_gpio_hw);
+        if (current_ctx->p_port_name >= PAL_GPIO_MAX_PORTS) {
+            continue;
+        }
+        if (current_ctx->p_init_flag == 0) {
+            GPIO_PinModeSet(current_ctx->p_port_name, current_ctx->p_pin, gpioModePushPull, 1);
+            current_ctx->p_init_flag = 1;
+        }
+        port_masks[current_ctx->p_port_name] |= (1UL << current_ctx->p_pin);
+        if (pal_gpio_is_optiga_reset(pp_gpio_contexts[i])) {
+            notify = 1;
+        }
+    }
+
+    for (i = 0; i < PAL_GPIO_MAX_PORTS; i++) {
+        if (port_masks[i] == 0) {
+            continue;
+        }
+        if (level) {
+            GPIO_PortOutSet((GPIO_Port_TypeDef)i, port_masks[i]);
+        } else {
+            GPIO_PortOutClear((GPIO_Port_TypeDef)i, port_masks[i]);
+        }
+    }
+
+    if (notify && !level) {
+        pal_gpio_notify_reset();
+    }
+}
+
+/**
+* Registers a listener for the OPTIGA reset
+*
+* <b>API Details:</b>
+*      The listener is invoked each time the reset pin of the OPTIGA is driven low.<br>
+*
+*\param[in] callback        Callback function pointer
+*\param[in] callback_args   Callback arguments
+*
+* \retval  #PAL_STATUS_SUCCESS  Returns when the listener is registered
+* \retval  #PAL_STATUS_FAILURE  Returns when all listener slots are in use
+*/
+pal_status_t pal_gpio_register_reset_listener(register_callback callback, void* callback_args)
+{
+    uint8_t i;
+
+    for (i = 0; i < PAL_GPIO_MAX_RESET_LISTENERS; i++) {
+        if (g_reset_listeners[i].clb == NULL) {
+            g_reset_listeners[i].clb_ctx = callback_args;
+            g_reset_listeners[i].clb = callback;
+            return PAL_STATUS_SUCCESS;
+        }
     }
+    return PAL_STATUS_FAILURE;
 }
 
 /**
@@ -34,10 +34,22 @@
 /**********************************************************************************************************************
  * HEADER FILES
  *********************************************************************************************************************/
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
 /* Optiga based includes */
 #include <trustx/optiga/include/optiga/pal/pal_i2c.h>
+#include <trustx/optiga/include/optiga/ifx_i2c/ifx_i2c_config.h>
 
 #include "sl_i2cspm_instances.h"
+#include "sl_i2cspm_sensor_config.h"
+
+#include "pal_efr32.h"
+
+#if (PAL_I2C_COEX == 1)
+#include "em_core.h"
+#include "timers.h"
+#endif
 
 /**********************************************************************************************************************
  * MACROS
@@ -46,16 +58,100 @@
 #define SEM_MAX_VALUE       1
 #define SEM_TAKE_SUCCESS    0
 
+#if (PAL_I2C_SINGLE_INSTANCE == 1)
+/* the only bus and context of the build, resolved at compile time */
+#define PAL_I2C_HW_CONFIG(ctx)          (&i2c_ctx)
+#define PAL_I2C_BUS(ctx)                (SL_I2CSPM_SENSOR_PERIPHERAL)
+#define PAL_I2C_CONTEXT_INVALID(ctx)    (0)
+#else
+#define PAL_I2C_HW_CONFIG(ctx)          ((i2c_ctx_t *)((ctx)->p_i2c_hw_config))
+#define PAL_I2C_BUS(ctx)                (PAL_I2C_HW_CONFIG(ctx)->sl_i2cspm_sensor)
+#define PAL_I2C_CONTEXT_INVALID(ctx)    ((ctx) == NULL)
+#endif
+
+#if ((DL_MAX_FRAME_SIZE + 1) > PAL_I2C_MAX_TRANSFER_LENGTH)
+#error "DL_MAX_FRAME_SIZE exceeds the largest frame supported by OPTIGA Trust X"
+#endif
+
+/* bitrates in KHz up to which the standard and fast mode clock ratios are used */
+#define PAL_I2C_STANDARD_MODE_MAX_BITRATE   100
+#define PAL_I2C_FAST_MODE_MAX_BITRATE       400
+
+#if (PAL_I2C_PIPELINED == 1)
+#if (SL_I2CSPM_SENSOR_PERIPHERAL_NO == 0)
+#define PAL_I2C_IRQn        I2C0_IRQn
+#define PAL_I2C_IRQHandler  I2C0_IRQHandler
+#else
+#define PAL_I2C_IRQn        I2C1_IRQn
+#define PAL_I2C_IRQHandler  I2C1_IRQHandler
+#endif
+
+#define PAL_I2C_IRQ_FLAGS   (I2C_IEN_ACK | I2C_IEN_NACK | I2C_IEN_MSTOP | I2C_IEN_RXDATAV | \
+                             I2C_IEN_ARBLOST | I2C_IEN_BUSERR)
+
+/* the handler posts to the event queue, its priority must not be above the kernel's syscall priority */
+#define PAL_I2C_IRQ_PRIORITY    (configMAX_SYSCALL_INTERRUPT_PRIORITY >> (8 - __NVIC_PRIO_BITS))
+#endif
+
+#if (PAL_I2C_COEX == 1)
+/* bitrate assumed when the context holds a speed mode instead of a bitrate */
+#define PAL_I2C_COEX_DEFAULT_BITRATE    100000
+/* address byte plus start/stop conditions and interrupt latency, in bytes */
+#define PAL_I2C_COEX_OVERHEAD_BYTES     2
+/* IFX I2C data register, command frames and their responses go through it, the status polls do not */
+#define PAL_I2C_COEX_DATA_REG           0x80
+#endif
+
 /*********************************************************************************************************************
  * LOCAL DATA
  *********************************************************************************************************************//* Varibale to indicate the re-entrant count of the i2c bus acquire function*/
 static volatile uint32_t g_entry_count = 0;
 
-/* context for i2c devices */
+/* end of the last transfer, the next one starts after the guard time */
+static volatile uint32_t g_transfer_end_us = 0;
+
+#if (PAL_I2C_PIPELINED == 1)
+/* descriptor of a frame handed over to the interrupt driven transfer */
+typedef struct {
+    pal_i2c_t *p_i2c_context;
+    I2C_TransferSeq_TypeDef seq;
+    uint16_t event;
+} pal_i2c_request_t;
+
+/* The upper layer usually queues the next frame from within the completion handler of the current one,
+ * hence the descriptors are double buffered */
+static pal_i2c_request_t g_requests[PAL_I2C_PIPELINE_DEPTH];
+static uint8_t g_next_request = 0;
+static pal_i2c_request_t * volatile g_active_request = NULL;
+#endif
+
+#if (PAL_I2C_COEX == 1)
+/* radio busy window */
+typedef struct {
+    uint32_t start_us;
+    uint32_t duration_us;
+} pal_i2c_coex_window_t;
+
+/* transfer waiting for the end of a busy window, the upper layer waits for its handler before the next frame */
 typedef struct {
-    sl_i2cspm_t *sl_i2cspm_sensor;
-    uint32_t p_bitrate;
-} i2c_ctx_t;
+    pal_i2c_t *p_i2c_context;
+    uint16_t flags;
+    uint8_t *p_data;
+    uint16_t length;
+} pal_i2c_coex_request_t;
+
+static pal_i2c_coex_window_t g_windows[PAL_I2C_COEX_MAX_WINDOWS];
+static uint8_t g_window_count = 0;
+static pal_i2c_coex_request_t g_deferred;
+static uint8_t g_retrying = 0;
+static uint32_t g_deferred_since_us = 0;
+static uint32_t g_transfer_start_us = 0;
+/* register selected by the last write, a read transfers data from it */
+static uint8_t g_coex_register = 0;
+static pal_i2c_coex_stats_t g_coex_stats;
+/* dedicated to the deferred transfer, the oneshots of the event module can all be in use */
+static TimerHandle_t g_retry_timer = NULL;
+#endif
 
 /**********************************************************************************************************************
  * LOCAL ROUTINES
@@ -64,7 +160,7 @@ typedef struct {
 //lint --e{715} suppress the unused p_i2c_context variable lint error , since this is kept for future enhancements
 static pal_status_t pal_i2c_acquire(const void* p_i2c_context)
 {
-  if((p_i2c_context == NULL)){
+  if(PAL_I2C_CONTEXT_INVALID(p_i2c_context)){
     return PAL_STATUS_FAILURE;
   }
   if(g_entry_count == 0)
@@ -82,11 +178,280 @@ static pal_status_t pal_i2c_acquire(const void* p_i2c_context)
 //lint --e{715} suppress the unused p_i2c_context variable lint, since this is kept for future enhancements
 static void pal_i2c_release(const void* p_i2c_context)
 {
-  if((p_i2c_context != NULL)){
+  if(!PAL_I2C_CONTEXT_INVALID(p_i2c_context)){
     g_entry_count = 0;
   }
 }
 
+#if (PAL_I2C_COEX == 1)
+static pal_status_t pal_i2c_transfer(pal_i2c_t* p_i2c_context, uint16_t flags,
+                                     uint8_t* p_data, uint16_t length);
+
+// Estimated bus time of a transfer in microseconds
+static uint32_t pal_i2c_coex_duration(const pal_i2c_t* p_i2c_context, uint16_t length)
+{
+    uint32_t bitrate = PAL_I2C_HW_CONFIG(p_i2c_context)->p_bitrate;
+
+    if (bitrate < 1000) {
+        bitrate = PAL_I2C_COEX_DEFAULT_BITRATE;
+    }
+    /* 8 data bits plus acknowledge per byte */
+    return (uint32_t)(((uint64_t)(length + PAL_I2C_COEX_OVERHEAD_BYTES) * 9 * 1000000) / bitrate);
+}
+
+// Returns the end of the busy windows overlapping [start, start + duration], or start if there is none
+static uint32_t pal_i2c_coex_free_from(uint32_t start_us, uint32_t duration_us)
+{
+    uint8_t overlap;
+    uint8_t i;
+    CORE_DECLARE_IRQ_STATE;
+
+    CORE_ENTER_ATOMIC();
+    /* windows may be back to back, move on until the slot is free */
+    do {
+        overlap = 0;
+        for (i = 0; i < g_window_count; i++) {
+            if (((int32_t)(g_windows[i].start_us - (start_us + duration_us)) < 0) &&
+                ((int32_t)(g_windows[i].start_us + g_windows[i].duration_us - start_us) > 0)) {
+                start_us = g_windows[i].start_us + g_windows[i].duration_us;
+                overlap = 1;
+            }
+        }
+    } while (overlap);
+    CORE_EXIT_ATOMIC();
+
+    return start_us;
+}
+
+// Counts a finished transfer which overlapped a busy window
+static void pal_i2c_coex_check(void)
+{
+    uint32_t duration_us = pal_os_timer_get_time_in_microseconds() - g_transfer_start_us;
+
+    if (pal_i2c_coex_free_from(g_transfer_start_us, duration_us) != g_transfer_start_us) {
+        g_coex_stats.collisions++;
+    }
+}
+
+// Retries the deferred transfer from the event handler task
+static void pal_i2c_coex_retry(void* p_args)
+{
+    (void)p_args;
+
+    g_retrying = 1;
+    (void)pal_i2c_transfer(g_deferred.p_i2c_context, g_deferred.flags, g_deferred.p_data, g_deferred.length);
+    g_retrying = 0;
+}
+
+// Retry timer, hands the deferred transfer over to the event handler task like the other upper layer callbacks
+static void pal_i2c_coex_timer_callback(TimerHandle_t xTimer)
+{
+    if (pal_os_event_post(pal_i2c_coex_retry, NULL) != PAL_STATUS_SUCCESS) {
+        /* the queue is full, try again on the next tick */
+        (void)xTimerChangePeriod(xTimer, 1, 0);
+    }
+}
+
+// Returns non zero for the transfers of a command frame or its response, the status polls and register accesses
+// can wait for the radio
+static uint8_t pal_i2c_coex_is_urgent(uint16_t flags, const uint8_t* p_data, uint16_t length)
+{
+    if ((flags & I2C_FLAG_WRITE) && (length > 0)) {
+        g_coex_register = p_data[0];
+    }
+    return (g_coex_register == PAL_I2C_COEX_DATA_REG);
+}
+
+// Defers the transfer to the end of the busy windows it would overlap, returns non zero if deferred
+static uint8_t pal_i2c_coex_defer(pal_i2c_t* p_i2c_context, uint16_t flags, uint8_t* p_data, uint16_t length)
+{
+    uint32_t now = pal_os_timer_get_time_in_microseconds();
+    uint32_t free_us = pal_i2c_coex_free_from(now, pal_i2c_coex_duration(p_i2c_context, length));
+    uint8_t urgent = pal_i2c_coex_is_urgent(flags, p_data, length);
+    TickType_t ticks;
+
+    if (!g_retrying) {
+        g_deferred_since_us = now;
+    }
+
+    if ((free_us != now) && urgent) {
+        /* the command or response is on the critical path of the caller, it goes ahead */
+        g_coex_stats.urgent++;
+    } else if (free_us != now) {
+        /* do not starve OPTIGA behind a busy radio */
+        /* at least a tick, even for short windows, so that the event handler task does not spin on the retry */
+        ticks = pdMS_TO_TICKS((free_us - now + 999) / 1000);
+        if (ticks == 0) {
+            ticks = 1;
+        }
+        if (((now - g_deferred_since_us) < PAL_I2C_COEX_MAX_DEFER_US) && (g_retry_timer != NULL)) {
+            g_deferred.p_i2c_context = p_i2c_context;
+            g_deferred.flags = flags;
+            g_deferred.p_data = p_data;
+            g_deferred.length = length;
+            if (xTimerChangePeriod(g_retry_timer, ticks, 0) == pdPASS) {
+                if (!g_retrying) {
+                    g_coex_stats.deferred++;
+                }
+                return 1;
+            }
+        }
+        /* the transfer goes ahead rather than never completing */
+        g_coex_stats.forced++;
+    }
+
+    g_coex_stats.deferred_time_us += now - g_deferred_since_us;
+    g_transfer_start_us = now;
+    return 0;
+}
+#endif
+
+// Waits until the guard time since the end of the last transfer has elapsed
+static void pal_i2c_guard_time(void)
+{
+    while ((pal_os_timer_get_time_in_microseconds() - g_transfer_end_us) < PAL_I2C_GUARD_TIME_US) {
+    }
+}
+
+#if (PAL_I2C_PIPELINED == 1)
+// Delivers the transfer result to the upper layer from the event handler task
+static void pal_i2c_complete(void* p_request)
+{
+    pal_i2c_request_t *request = (pal_i2c_request_t *)p_request;
+    app_event_handler_t upper_layer_handler =
+            (app_event_handler_t)request->p_i2c_context->upper_layer_event_handler;
+
+#if (PAL_I2C_COEX == 1)
+    pal_i2c_coex_check();
+#endif
+#if (PAL_I2C_POLL_PREDICTOR == 1)
+    pal_i2c_poll_observe(request->p_i2c_context, (uint8_t)(request->seq.flags == I2C_FLAG_READ),
+                         (uint8_t)(request->event != PAL_I2C_EVENT_SUCCESS), request->seq.buf[0].data,
+                         request->seq.buf[0].len);
+#endif
+    upper_layer_handler(request->p_i2c_context->upper_layer_ctx, request->event);
+}
+
+// I2C interrupt handler, drives the emlib transfer state machine
+void PAL_I2C_IRQHandler(void)
+{
+    pal_i2c_request_t *request = g_active_request;
+    I2C_TransferReturn_TypeDef result;
+
+    result = I2C_Transfer(PAL_I2C_BUS(request->p_i2c_context));
+    if (result == i2cTransferInProgress) {
+        return;
+    }
+
+    g_transfer_end_us = pal_os_timer_get_time_in_microseconds();
+    NVIC_DisableIRQ(PAL_I2C_IRQn);
+    request->event = (result == i2cTransferDone) ? PAL_I2C_EVENT_SUCCESS : PAL_I2C_EVENT_ERROR;
+    g_active_request = NULL;
+    pal_i2c_release((void *)request->p_i2c_context);
+
+    /* a single transfer is active, the entries reserved for the interrupt handlers always take its completion */
+    if (pal_os_event_post_from_isr(pal_i2c_complete, (void *)request) != PAL_STATUS_SUCCESS) {
+        configASSERT(0);
+    }
+}
+#endif
+
+// Performs the I2C transfer and notifies the upper layer about the result
+static pal_status_t pal_i2c_transfer(pal_i2c_t* p_i2c_context, uint16_t flags,
+                                     uint8_t* p_data, uint16_t length)
+{
+    pal_status_t status;
+    app_event_handler_t upper_layer_handler;
+
+    if (PAL_I2C_CONTEXT_INVALID(p_i2c_context)) {
+        return PAL_STATUS_FAILURE;
+    }
+    upper_layer_handler = (app_event_handler_t)p_i2c_context->upper_layer_event_handler;
+
+    if (length > PAL_I2C_MAX_TRANSFER_LENGTH) {
+        upper_layer_handler(p_i2c_context->upper_layer_ctx,
+                            PAL_I2C_EVENT_ERROR);
+        return PAL_STATUS_FAILURE;
+    }
+
+#if (PAL_I2C_COEX == 1)
+    /* the upper layer handler is invoked once the deferred transfer is done */
+    if (pal_i2c_coex_defer(p_i2c_context, flags, p_data, length)) {
+        return PAL_STATUS_SUCCESS;
+    }
+#endif
+
+    if (PAL_STATUS_SUCCESS == pal_i2c_acquire(p_i2c_context)) {
+#if (PAL_I2C_PIPELINED == 1)
+        pal_i2c_request_t *request = &g_requests[g_next_request];
+        sl_i2cspm_t *i2c = PAL_I2C_BUS(p_i2c_context);
+
+        g_next_request = (uint8_t)((g_next_request + 1) % PAL_I2C_PIPELINE_DEPTH);
+
+        request->p_i2c_context = p_i2c_context;
+        request->seq.addr = (p_i2c_context->slave_address) << 1;
+        request->seq.flags = flags;
+        request->seq.buf[0].len  = length;
+        request->seq.buf[0].data = p_data;
+        request->seq.buf[1].len  = 0;
+        g_active_request = request;
+
+        pal_i2c_guard_time();
+        NVIC_ClearPendingIRQ(PAL_I2C_IRQn);
+        I2C_IntEnable(i2c, PAL_I2C_IRQ_FLAGS);
+        if (I2C_TransferInit(i2c, &request->seq) == i2cTransferInProgress) {
+            /* the upper layer is notified from the interrupt handler */
+            NVIC_EnableIRQ(PAL_I2C_IRQn);
+            return PAL_STATUS_SUCCESS;
+        }
+
+        g_active_request = NULL;
+        g_transfer_end_us = pal_os_timer_get_time_in_microseconds();
+        upper_layer_handler(p_i2c_context->upper_layer_ctx,
+                            PAL_I2C_EVENT_ERROR);
+        status = PAL_STATUS_FAILURE;
+#else
+        I2C_TransferSeq_TypeDef seq;
+        int i2c_result;
+
+        seq.addr = (p_i2c_context->slave_address) << 1;
+        seq.flags = flags;
+        seq.buf[0].len  = length;
+        seq.buf[0].data = p_data;
+        seq.buf[1].len  = 0;
+
+        pal_i2c_guard_time();
+        i2c_result = I2CSPM_Transfer(PAL_I2C_BUS(p_i2c_context), &seq);
+        g_transfer_end_us = pal_os_timer_get_time_in_microseconds();
+#if (PAL_I2C_COEX == 1)
+        pal_i2c_coex_check();
+#endif
+
+#if (PAL_I2C_POLL_PREDICTOR == 1)
+        pal_i2c_poll_observe(p_i2c_context, (uint8_t)(flags == I2C_FLAG_READ), (uint8_t)(i2c_result != 0),
+                             p_data, length);
+#endif
+        if (i2c_result == 0) {
+            upper_layer_handler(p_i2c_context->upper_layer_ctx,
+                                PAL_I2C_EVENT_SUCCESS);
+            status = PAL_STATUS_SUCCESS;
+        } else {
+            upper_layer_handler(p_i2c_context->upper_layer_ctx,
+                                PAL_I2C_EVENT_ERROR);
+            status = PAL_STATUS_FAILURE;
+        }
+#endif
+
+        pal_i2c_release((void *)p_i2c_context);
+    } else {
+        status = PAL_STATUS_I2C_BUSY;
+        upper_layer_handler(p_i2c_context->upper_layer_ctx,
+                            PAL_I2C_EVENT_BUSY);
+    }
+
+    return status;
+}
+
 /**********************************************************************************************************************
  * API IMPLEMENTATION
  *********************************************************************************************************************/
@@ -115,10 +480,20 @@ static void pal_i2c_release(const void* p_i2c_context)
  */
 pal_status_t pal_i2c_init(const pal_i2c_t* p_i2c_context)
 {
-    i2c_ctx_t *current_ctx = p_i2c_context->p_i2c_hw_config;
-    if(current_ctx->sl_i2cspm_sensor == NULL){
+    if (PAL_I2C_CONTEXT_INVALID(p_i2c_context) || (PAL_I2C_BUS(p_i2c_context) == NULL)) {
         return PAL_STATUS_FAILURE;
     }
+#if (PAL_I2C_PIPELINED == 1)
+    NVIC_SetPriority(PAL_I2C_IRQn, PAL_I2C_IRQ_PRIORITY);
+#endif
+#if (PAL_I2C_COEX == 1)
+    if (g_retry_timer == NULL) {
+        g_retry_timer = xTimerCreate("OTXCoex", 1, pdFALSE, NULL, pal_i2c_coex_timer_callback);
+        if (g_retry_timer == NULL) {
+            return PAL_STATUS_FAILURE;
+        }
+    }
+#endif
 
     return PAL_STATUS_SUCCESS;
 }
@@ -148,7 +523,7 @@ pal_status_t pal_i2c_init(const pal_i2c_t* p_i2c_context)
 pal_status_t pal_i2c_deinit(const pal_i2c_t* p_i2c_context)
 {
   pal_status_t status = PAL_STATUS_SUCCESS;
-  if((p_i2c_context == NULL)){
+  if(PAL_I2C_CONTEXT_INVALID(p_i2c_context)){
       status = PAL_STATUS_FAILURE;
   }
   return status;
@@ -176,7 +551,11 @@ pal_status_t pal_i2c_deinit(const pal_i2c_t* p_i2c_context)
  *
  *<b>Notes:</b><br>
  *  - Otherwise the below implementation has to be updated to handle different bitrates based on the input context.<br>
- *  - The caller of this API must take care of the guard time based on the slave's requirement.<br>
+ *  - The API waits for #PAL_I2C_GUARD_TIME_US since the end of the previous transfer before it starts, the caller
+ *    does not need to delay back-to-back requests.<br>
+ *  - With #PAL_I2C_PIPELINED enabled the API returns once the transfer is started and the upper layer handler is
+ *    invoked from the event handler task. The data buffer must stay valid until then.<br>
+ *  - Transfers longer than #PAL_I2C_MAX_TRANSFER_LENGTH are rejected with #PAL_I2C_EVENT_ERROR.<br>
  *
  * \param[in] p_i2c_context  Pointer to the pal I2C context #pal_i2c_t
  * \param[in] p_data         Pointer to the data to be written
@@ -189,52 +568,7 @@ pal_status_t pal_i2c_deinit(const pal_i2c_t* p_i2c_context)
 pal_status_t pal_i2c_write(pal_i2c_t *p_i2c_context, uint8_t *p_data,
                            uint16_t length)
 {
-    pal_status_t status;
-    I2C_TransferSeq_TypeDef seq;
-    app_event_handler_t upper_layer_handler =
-            (app_event_handler_t)p_i2c_context->upper_layer_event_handler;
-
-
-    if ((PAL_STATUS_SUCCESS == pal_i2c_acquire(p_i2c_context)) && (p_i2c_context != NULL)) {
-        int i2c_result;
-        seq.addr = (p_i2c_context->slave_address) << 1;
-        /*if(length > 1){
-            seq.flags = I2C_FLAG_WRITE_WRITE;
-            seq.buf[0].len  = 1;
-            seq.buf[0].data = p_data;
-            seq.buf[1].len  = (uint8_t)(length-1);
-            seq.buf[1].data = p_data++;
-        } else if(length == 1){
-            seq.flags = I2C_FLAG_WRITE;
-            seq.buf[0].len  = 1;
-            seq.buf[0].data = p_data;
-            seq.buf[1].len  = 0;
-        }*/
-        seq.flags = I2C_FLAG_WRITE;
-        seq.buf[0].len  = length;
-        seq.buf[0].data = p_data;
-        seq.buf[1].len  = 0;
-
-        i2c_result = I2CSPM_Transfer(((i2c_ctx_t *)(p_i2c_context->p_i2c_hw_config))->sl_i2cspm_sensor, &seq);
-
-        if (i2c_result == 0) {
-            upper_layer_handler(p_i2c_context->upper_layer_ctx,
-                                PAL_I2C_EVENT_SUCCESS);
-            status = PAL_STATUS_SUCCESS;
-        } else {
-            upper_layer_handler(p_i2c_context->upper_layer_ctx,
-                                PAL_I2C_EVENT_ERROR);
-            status = PAL_STATUS_FAILURE;
-        }
-
-        pal_i2c_release((void *)p_i2c_context);
-    } else {
-        status = PAL_STATUS_I2C_BUSY;
-        upper_layer_handler(p_i2c_context->upper_layer_ctx,
-                            PAL_I2C_EVENT_BUSY);
-    }
-
-    return status;
+    return pal_i2c_transfer(p_i2c_context, I2C_FLAG_WRITE, p_data, length);
 }
 
 /**
@@ -258,7 +592,11 @@ pal_status_t pal_i2c_write(pal_i2c_t *p_i2c_context, uint8_t *p_data,
  *
  *<b>Notes:</b><br>
  *  - Otherwise the below implementation has to be updated to handle different bitrates based on the input context.<br>
- *  - The caller of this API must take care of the guard time based on the slave's requirement.<br>
+ *  - The API waits for #PAL_I2C_GUARD_TIME_US since the end of the previous transfer before it starts, the caller
+ *    does not need to delay back-to-back requests.<br>
+ *  - With #PAL_I2C_PIPELINED enabled the API returns once the transfer is started and the upper layer handler is
+ *    invoked from the event handler task. The data buffer must stay valid until then.<br>
+ *  - Transfers longer than #PAL_I2C_MAX_TRANSFER_LENGTH are rejected with #PAL_I2C_EVENT_ERROR.<br>
  *
  * \param[in]  p_i2c_context  pointer to the PAL i2c context #pal_i2c_t
  * \param[in]  p_data         Pointer to the data buffer to store the read data
@@ -271,49 +609,26 @@ pal_status_t pal_i2c_write(pal_i2c_t *p_i2c_context, uint8_t *p_data,
 pal_status_t pal_i2c_read(pal_i2c_t* p_i2c_context, uint8_t* p_data,
                           uint16_t length)
 {
-    pal_status_t status;
-    app_event_handler_t upper_layer_handler =
-            (app_event_handler_t)p_i2c_context->upper_layer_event_handler;
-
-
-    if ((PAL_STATUS_SUCCESS == pal_i2c_acquire(p_i2c_context)) && (p_i2c_context != NULL)) {
-        int result;
-        I2C_TransferSeq_TypeDef seq;
-
-        seq.addr = (p_i2c_context->slave_address) << 1;
-        seq.flags = I2C_FLAG_READ;
-
-        seq.buf[0].len  = length;
-        seq.buf[0].data = p_data;
-        seq.buf[1].len  = 0;
-
-        result = I2CSPM_Transfer(((i2c_ctx_t *)(p_i2c_context->p_i2c_hw_config))->sl_i2cspm_sensor, &seq);
-
-        /*for(int count = 1; count < length; count++){
-            seq.buf[0].data = p_data++;
-            result = I2CSPM_Transfer(((i2c_ctx_t *)(p_i2c_context->p_i2c_hw_config))->sl_i2cspm_sensor, &seq);
-            if(result != 0)
-              break;
-        }*/
+    return pal_i2c_transfer(p_i2c_context, I2C_FLAG_READ, p_data, length);
+}
 
-        if (result == 0) {
-            upper_layer_handler(p_i2c_context->upper_layer_ctx,
-                                PAL_I2C_EVENT_SUCCESS);
-            status = PAL_STATUS_SUCCESS;
-        } else {
-            upper_layer_handler(p_i2c_context->upper_layer_ctx,
-                                PAL_I2C_EVENT_ERROR);
-            status = PAL_STATUS_FAILURE;
-        }
+pal_status_t pal_i2c_write_frame(pal_i2c_t* p_i2c_context, pal_frame_handle_t handle)
+{
+    uint8_t *p_data = pal_frame_data(handle);
 
-        pal_i2c_release((void *)p_i2c_context);
-    } else {
-        status = PAL_STATUS_I2C_BUSY;
-        upper_layer_handler(p_i2c_context->upper_layer_ctx,
-                            PAL_I2C_EVENT_BUSY);
+    if (p_data == NULL) {
+        return PAL_STATUS_FAILURE;
     }
+    return pal_i2c_transfer(p_i2c_context, I2C_FLAG_WRITE, p_data, pal_frame_length(handle));
+}
 
-    return status;
+pal_status_t pal_i2c_read_frame(pal_i2c_t* p_i2c_context, pal_frame_handle_t handle, uint16_t length)
+{
+    /* the length is set before the transfer, the upper layer may be notified before pal_i2c_read_frame returns */
+    if (pal_frame_set_length(handle, length) != PAL_STATUS_SUCCESS) {
+        return PAL_STATUS_FAILURE;
+    }
+    return pal_i2c_transfer(p_i2c_context, I2C_FLAG_READ, pal_frame_data(handle), length);
 }
 
 /**
@@ -347,9 +662,93 @@ pal_status_t pal_i2c_read(pal_i2c_t* p_i2c_context, uint8_t* p_data,
 pal_status_t pal_i2c_set_bitrate(const pal_i2c_t* p_i2c_context,
                                  uint16_t bitrate)
 {
-    /* not supporting config changes on run time */
-    return PAL_STATUS_SUCCESS;
+    i2c_ctx_t *current_ctx;
+    app_event_handler_t upper_layer_handler;
+    I2C_ClockHLR_TypeDef clock_ratio;
+    pal_status_t status;
+    uint16_t event;
+
+    if (PAL_I2C_CONTEXT_INVALID(p_i2c_context)) {
+        return PAL_STATUS_FAILURE;
+    }
+    current_ctx = PAL_I2C_HW_CONFIG(p_i2c_context);
+    upper_layer_handler = (app_event_handler_t)p_i2c_context->upper_layer_event_handler;
+
+    if (PAL_STATUS_SUCCESS == pal_i2c_acquire(p_i2c_context)) {
+        if (bitrate > PAL_I2C_MASTER_MAX_BITRATE) {
+            bitrate = PAL_I2C_MASTER_MAX_BITRATE;
+        }
+        if (bitrate <= PAL_I2C_STANDARD_MODE_MAX_BITRATE) {
+            clock_ratio = i2cClockHLRStandard;
+        } else if (bitrate <= PAL_I2C_FAST_MODE_MAX_BITRATE) {
+            clock_ratio = i2cClockHLRAsymetric;
+        } else {
+            clock_ratio = i2cClockHLRFast;
+        }
+
+        /* the negotiated frame size only pays off if the bus runs at the bitrate OPTIGA asked for */
+        I2C_BusFreqSet(PAL_I2C_BUS(p_i2c_context), 0, (uint32_t)bitrate * 1000, clock_ratio);
+        current_ctx->p_bitrate = (uint32_t)bitrate * 1000;
+
+        pal_i2c_release((void *)p_i2c_context);
+        status = PAL_STATUS_SUCCESS;
+        event = PAL_I2C_EVENT_SUCCESS;
+    } else {
+        status = PAL_STATUS_I2C_BUSY;
+        event = PAL_I2C_EVENT_BUSY;
+    }
+
+    if (upper_layer_handler != NULL) {
+        upper_layer_handler(p_i2c_context->upper_layer_ctx, event);
+    }
+    return status;
+}
+
+#if (PAL_I2C_COEX == 1)
+void pal_i2c_coex_add_window(uint32_t start_us, uint32_t duration_us)
+{
+    uint32_t now = pal_os_timer_get_time_in_microseconds();
+    uint8_t i;
+    uint8_t count = 0;
+    CORE_DECLARE_IRQ_STATE;
+
+    CORE_ENTER_ATOMIC();
+    for (i = 0; i < g_window_count; i++) {
+        if ((int32_t)(g_windows[i].start_us + g_windows[i].duration_us - now) > 0) {
+            g_windows[count++] = g_windows[i];
+        }
+    }
+    if (count == PAL_I2C_COEX_MAX_WINDOWS) {
+        for (i = 1; i < PAL_I2C_COEX_MAX_WINDOWS; i++) {
+            g_windows[i - 1] = g_windows[i];
+        }
+        count--;
+    }
+    g_windows[count].start_us = start_us;
+    g_windows[count].duration_us = duration_us;
+    g_window_count = (uint8_t)(count + 1);
+    g_coex_stats.windows++;
+    CORE_EXIT_ATOMIC();
+}
+
+void pal_i2c_coex_clear_windows(void)
+{
+    CORE_DECLARE_IRQ_STATE;
+
+    CORE_ENTER_ATOMIC();
+    g_window_count = 0;
+    CORE_EXIT_ATOMIC();
+}
+
+void pal_i2c_coex_get_stats(pal_i2c_coex_stats_t * p_stats)
+{
+    CORE_DECLARE_IRQ_STATE;
+
+    CORE_ENTER_ATOMIC();
+    *p_stats = g_coex_stats;
+    CORE_EXIT_ATOMIC();
 }
+#endif
 
 /**
 * @}
@@ -0,0 +1,321 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file implements the prediction of the OPTIGA command duration used to schedule the status polls.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Optiga based includes */
+#include <trustx/optiga/include/optiga/pal/pal_os_timer.h>
+
+#include "pal_efr32.h"
+
+#if (PAL_I2C_POLL_PREDICTOR == 1)
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/* IFX I2C registers */
+#define PAL_I2C_POLL_DATA_REG           0x80
+#define PAL_I2C_POLL_STATE_REG          0x82
+
+/* I2C_STATE flag of a frame ready to be read */
+#define PAL_I2C_POLL_STATE_RESP_RDY     0x40
+/* length of the I2C_STATE register */
+#define PAL_I2C_POLL_STATE_LENGTH       4
+
+/* frame written to the data register: register, FCTR, LEN (2 bytes), PCTR, command */
+#define PAL_I2C_POLL_FRAME_LEN_OFFSET   2
+#define PAL_I2C_POLL_FRAME_PCTR_OFFSET  4
+#define PAL_I2C_POLL_FRAME_CMD_OFFSET   5
+/* chaining bits of the PCTR, the command is in the single or first frame of a chain */
+#define PAL_I2C_POLL_PCTR_CHAIN_MASK    0x07
+#define PAL_I2C_POLL_PCTR_CHAIN_FIRST   0x01
+
+/* control frame (FCTR, LEN, CRC) i.e. the acknowledge of the written frame */
+#define PAL_I2C_POLL_CONTROL_FRAME_LENGTH   5
+
+/* commands of a class differ by payload length in steps of 2^n bytes */
+#define PAL_I2C_POLL_SIZE_SHIFT         6
+#define PAL_I2C_POLL_SIZE_CLASSES       4
+
+/* weights of a new sample in the average duration and its deviation, 1/2^n */
+#define PAL_I2C_POLL_MEAN_SHIFT         3
+#define PAL_I2C_POLL_DEV_SHIFT          2
+
+/*********************************************************************************************************************
+ * LOCAL DATA
+ *********************************************************************************************************************/
+typedef enum {
+    PAL_I2C_POLL_IDLE = 0,
+    /* frame written, the acknowledge is pending */
+    PAL_I2C_POLL_WAIT_ACK,
+    /* frame acknowledged, OPTIGA is executing the command */
+    PAL_I2C_POLL_WAIT_RESPONSE
+} pal_i2c_poll_state_t;
+
+/* learned duration of a command and payload size class */
+typedef struct {
+    uint8_t command;
+    uint8_t size_class;
+    uint8_t samples;
+    uint32_t mean_us;
+    uint32_t dev_us;
+    uint32_t last_used_ms;
+} pal_i2c_poll_class_t;
+
+static pal_i2c_poll_class_t g_classes[PAL_I2C_POLL_MAX_CLASSES];
+
+static pal_i2c_poll_state_t g_state = PAL_I2C_POLL_IDLE;
+static uint8_t g_last_register = 0;
+static uint8_t g_command = 0;
+static uint16_t g_payload_length = 0;
+static uint32_t g_sent_us = 0;
+/* the next oneshot timer of the poll interval for this context is the poll timer of the physical layer */
+static uint8_t g_poll_timer_pending = 0;
+static const void* g_poll_ctx = NULL;
+static uint8_t g_backoff = 0;
+
+static pal_i2c_poll_stats_t g_poll_stats;
+
+/**********************************************************************************************************************
+ * LOCAL ROUTINES
+ *********************************************************************************************************************/
+// Delay applied by the oneshot timer: rounded up to whole ticks, at least one
+static uint32_t pal_i2c_poll_ticks_us(uint32_t time_us)
+{
+    uint32_t ticks = (uint32_t)((time_us + PAL_OS_TICK_US - 1) / PAL_OS_TICK_US);
+
+    return (uint32_t)(((ticks > 0) ? ticks : 1) * PAL_OS_TICK_US);
+}
+
+static uint8_t pal_i2c_poll_size_class(uint16_t payload_length)
+{
+    uint16_t size_class = payload_length >> PAL_I2C_POLL_SIZE_SHIFT;
+
+    return (uint8_t)((size_class < PAL_I2C_POLL_SIZE_CLASSES) ? size_class : (PAL_I2C_POLL_SIZE_CLASSES - 1));
+}
+
+// Returns the class of the pending command, or NULL if it was never seen
+static pal_i2c_poll_class_t * pal_i2c_poll_lookup(void)
+{
+    uint8_t size_class = pal_i2c_poll_size_class(g_payload_length);
+    uint8_t i;
+
+    for (i = 0; i < PAL_I2C_POLL_MAX_CLASSES; i++) {
+        if ((g_classes[i].samples > 0) && (g_classes[i].command == g_command) &&
+            (g_classes[i].size_class == size_class)) {
+            return &g_classes[i];
+        }
+    }
+    return NULL;
+}
+
+// Learns the duration of the completed command, evicting the least recently used class if needed
+static void pal_i2c_poll_learn(uint32_t duration_us)
+{
+    pal_i2c_poll_class_t * p_class = pal_i2c_poll_lookup();
+    int32_t error;
+    uint8_t i;
+
+    if (p_class == NULL) {
+        for (i = 0; i < PAL_I2C_POLL_MAX_CLASSES; i++) {
+            if (g_classes[i].samples == 0) {
+                p_class = &g_classes[i];
+                break;
+            }
+            if ((p_class == NULL) || ((int32_t)(g_classes[i].last_used_ms - p_class->last_used_ms) < 0)) {
+                p_class = &g_classes[i];
+            }
+        }
+        p_class->command = g_command;
+        p_class->size_class = pal_i2c_poll_size_class(g_payload_length);
+        p_class->samples = 0;
+        p_class->mean_us = duration_us;
+        p_class->dev_us = duration_us / 2;
+    }
+
+    error = (int32_t)duration_us - (int32_t)p_class->mean_us;
+    p_class->mean_us = (uint32_t)((int32_t)p_class->mean_us + (error >> PAL_I2C_POLL_MEAN_SHIFT));
+    error = ((error < 0) ? -error : error) - (int32_t)p_class->dev_us;
+    p_class->dev_us = (uint32_t)((int32_t)p_class->dev_us + (error >> PAL_I2C_POLL_DEV_SHIFT));
+    if (p_class->samples < 0xFF) {
+        p_class->samples++;
+    }
+    p_class->last_used_ms = pal_os_timer_get_time_in_milliseconds();
+}
+
+// Status poll which found OPTIGA busy, the physical layer polls again after its poll interval
+static void pal_i2c_poll_busy(const pal_i2c_t* p_i2c_context)
+{
+    if (g_state == PAL_I2C_POLL_WAIT_RESPONSE) {
+        g_poll_stats.early_polls++;
+        g_poll_timer_pending = 1;
+        g_poll_ctx = p_i2c_context->upper_layer_ctx;
+    }
+}
+
+/**********************************************************************************************************************
+ * API IMPLEMENTATION
+ *********************************************************************************************************************/
+void pal_i2c_poll_observe(const pal_i2c_t* p_i2c_context, uint8_t is_read, uint8_t is_error,
+                          const uint8_t* p_data, uint16_t length)
+{
+    uint16_t frame_length;
+    uint8_t chain;
+
+    /* a poll timer not started right after the busy poll belongs to someone else */
+    g_poll_timer_pending = 0;
+
+    if (length == 0) {
+        return;
+    }
+
+    if (is_error) {
+        /* OPTIGA NACKs the status register address or read while it is executing a command */
+        if (!is_read) {
+            g_last_register = p_data[0];
+        }
+        if ((g_last_register == PAL_I2C_POLL_STATE_REG) && (g_state != PAL_I2C_POLL_IDLE)) {
+            g_poll_stats.polls++;
+            pal_i2c_poll_busy(p_i2c_context);
+        }
+        return;
+    }
+
+    if (!is_read) {
+        g_last_register = p_data[0];
+        if ((p_data[0] != PAL_I2C_POLL_DATA_REG) || (length <= PAL_I2C_POLL_FRAME_CMD_OFFSET)) {
+            return;
+        }
+        frame_length = (uint16_t)((p_data[PAL_I2C_POLL_FRAME_LEN_OFFSET] << 8) |
+                                  p_data[PAL_I2C_POLL_FRAME_LEN_OFFSET + 1]);
+        if (frame_length == 0) {
+            /* acknowledge sent by the host */
+            return;
+        }
+        chain = p_data[PAL_I2C_POLL_FRAME_PCTR_OFFSET] & PAL_I2C_POLL_PCTR_CHAIN_MASK;
+        if ((chain == 0) || (chain == PAL_I2C_POLL_PCTR_CHAIN_FIRST)) {
+            g_command = p_data[PAL_I2C_POLL_FRAME_CMD_OFFSET];
+            g_payload_length = 0;
+        }
+        g_payload_length = (uint16_t)(g_payload_length + frame_length);
+        g_sent_us = pal_os_timer_get_time_in_microseconds();
+        g_state = PAL_I2C_POLL_WAIT_ACK;
+        g_backoff = 0;
+        return;
+    }
+
+    if ((g_last_register != PAL_I2C_POLL_STATE_REG) || (length < PAL_I2C_POLL_STATE_LENGTH) ||
+        (g_state == PAL_I2C_POLL_IDLE)) {
+        return;
+    }
+
+    g_poll_stats.polls++;
+    if (!(p_data[0] & PAL_I2C_POLL_STATE_RESP_RDY)) {
+        pal_i2c_poll_busy(p_i2c_context);
+        return;
+    }
+
+    frame_length = (uint16_t)((p_data[2] << 8) | p_data[3]);
+    if (frame_length <= PAL_I2C_POLL_CONTROL_FRAME_LENGTH) {
+        g_state = PAL_I2C_POLL_WAIT_RESPONSE;
+        return;
+    }
+
+    /* the response is ready, the command took at most until this poll */
+    pal_i2c_poll_learn(pal_os_timer_get_time_in_microseconds() - g_sent_us);
+    g_poll_stats.commands++;
+    g_state = PAL_I2C_POLL_IDLE;
+}
+
+uint32_t pal_i2c_poll_adjust_delay(const void* callback_args, uint32_t time_us)
+{
+    pal_i2c_poll_class_t * p_class;
+    uint32_t elapsed_us;
+    uint32_t target_us;
+    uint32_t delay_us;
+    uint32_t interval_us;
+
+    if (!g_poll_timer_pending || (callback_args != g_poll_ctx) || (time_us != PAL_I2C_POLL_INTERVAL_US)) {
+        return time_us;
+    }
+    g_poll_timer_pending = 0;
+
+    p_class = pal_i2c_poll_lookup();
+    if ((g_state != PAL_I2C_POLL_WAIT_RESPONSE) || (p_class == NULL) ||
+        (p_class->samples < PAL_I2C_POLL_MIN_SAMPLES)) {
+        return time_us;
+    }
+
+    /* first poll just before the predicted completion, then back off geometrically */
+    elapsed_us = pal_os_timer_get_time_in_microseconds() - g_sent_us;
+    target_us = (p_class->mean_us > p_class->dev_us) ? (p_class->mean_us - p_class->dev_us) : 0;
+    if (elapsed_us < target_us) {
+        /* rounded down so that the poll is not later than predicted */
+        delay_us = target_us - elapsed_us;
+        delay_us = (delay_us < PAL_OS_TICK_US) ? PAL_OS_TICK_US : (uint32_t)(delay_us - delay_us % PAL_OS_TICK_US);
+    } else {
+        delay_us = PAL_I2C_POLL_BACKOFF_MIN_US << g_backoff;
+        if (delay_us >= PAL_I2C_POLL_BACKOFF_MAX_US) {
+            delay_us = PAL_I2C_POLL_BACKOFF_MAX_US;
+        } else {
+            g_backoff++;
+        }
+        delay_us = pal_i2c_poll_ticks_us(delay_us);
+    }
+
+    /* only the difference to the interval the timer would have applied is saved */
+    interval_us = pal_i2c_poll_ticks_us(time_us);
+    taskENTER_CRITICAL();
+    if (delay_us < interval_us) {
+        g_poll_stats.latency_saved_us += interval_us - delay_us;
+    } else {
+        g_poll_stats.polls_avoided += (delay_us / interval_us) - 1;
+    }
+    taskEXIT_CRITICAL();
+    return delay_us;
+}
+
+void pal_i2c_poll_get_stats(pal_i2c_poll_stats_t * p_stats)
+{
+    taskENTER_CRITICAL();
+    *p_stats = g_poll_stats;
+    taskEXIT_CRITICAL();
+}
+#endif
+
+/**
+* @}
+*/
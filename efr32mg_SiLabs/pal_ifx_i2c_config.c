@@ -36,10 +36,14 @@
 /* Optiga based includes */
 #include <trustx/optiga/include/optiga/pal/pal_gpio.h>
 #include <trustx/optiga/include/optiga/pal/pal_i2c.h>
+#include <trustx/optiga/include/optiga/comms/optiga_comms.h>
+#include <trustx/optiga/include/optiga/ifx_i2c/ifx_i2c_config.h>
 
 #include "sl_i2cspm_sensor_config.h"
 #include "sl_i2cspm.h"
 
+#include "pal_efr32.h"
+
 /**********************************************************************************************************************
  * MACROS
  *********************************************************************************************************************/
@@ -55,23 +59,19 @@
 #define RST_PORT_NAME   gpioPortD
 #define RST_PIN         9  /* PD9 */
 
+/* Configuration of the second OPTIGA of gateway builds, on the same bus at another address */
+#define I2C_OPTIGA_ADDRESS_1 0x31
+#define RST_PORT_NAME_1 gpioPortD
+#define RST_PIN_1       10  /* PD10 */
+
+#if (PAL_OPTIGA_CHIP_COUNT > 2)
+#error "Add the contexts of the further OPTIGA chips to the chip tables"
+#endif
+
 /*********************************************************************************************************************
  * Context structures
  *********************************************************************************************************************/
-/* context for i2c devices */
-typedef struct {
-  sl_i2cspm_t *sl_i2cspm_sensor;
-  uint32_t p_bitrate;
-} i2c_ctx_t;
-
-/* context for gpio devices */
-typedef struct {
-    uint8_t         p_pin;
-    uint8_t        *p_port_name;
-    uint8_t         p_init_flag;
-} gpio_ctx_t;
-
-/* initialization of contexts */
+/* initialization of contexts, the context types are shared with pal_i2c.c and pal_gpio.c through pal_efr32.h */
 i2c_ctx_t i2c_ctx = {
     SL_I2CSPM_SENSOR_PERIPHERAL,
     I2C_FREQ_HZ
@@ -83,6 +83,14 @@ gpio_ctx_t rst_gpio_ctx = {
     0
 };
 
+#if (PAL_OPTIGA_CHIP_COUNT > 1)
+gpio_ctx_t rst_gpio_ctx_1 = {
+    RST_PIN_1,
+    RST_PORT_NAME_1,
+    0
+};
+#endif
+
 /*********************************************************************************************************************
  * Pal ifx i2c instance *********************************************************************************************************************/
 /**
@@ -95,6 +103,18 @@ pal_i2c_t optiga_pal_i2c_context_0 = {
     NULL                 /* callback event handler */
 };
 
+#if (PAL_OPTIGA_CHIP_COUNT > 1)
+/**
+ * \brief PAL I2C configuration for the second OPTIGA.
+ */
+pal_i2c_t optiga_pal_i2c_context_1 = {
+    (void*)&i2c_ctx,     /* context */
+    I2C_OPTIGA_ADDRESS_1,/* address */
+    NULL,                /* upper layer context */
+    NULL                 /* callback event handler */
+};
+#endif
+
 /*********************************************************************************************************************
  * PAL GPIO configurations *********************************************************************************************************************/
 /**
@@ -113,6 +133,72 @@ pal_gpio_t optiga_reset_0 = {
     (void*)&rst_gpio_ctx
 };
 
+#if (PAL_OPTIGA_CHIP_COUNT > 1)
+/**
+ * \brief PAL reset pin configuration for the second OPTIGA.
+ */
+pal_gpio_t optiga_reset_1 = {
+    /* platform specific GPIO context for the pin used to toggle Reset */
+    (void*)&rst_gpio_ctx_1
+};
+#endif
+
+#if (PAL_OPTIGA_CHIP_COUNT > 1)
+/*********************************************************************************************************************
+ * IFX I2C instances of the further chips *********************************************************************************************************************/
+/**
+ * \brief IFX I2C context of the second OPTIGA, as ifx_i2c_context_0 of the host library.
+ * The session is opened without a cold reset, which would drop a volatile address: the chip is reset through
+ * optiga_dispatch_reset_all.
+ */
+ifx_i2c_context_t ifx_i2c_context_1 = {
+    I2C_OPTIGA_ADDRESS_1,        /* slave address */
+    400,                         /* i2c-master frequency */
+    DL_MAX_FRAME_SIZE,           /* IFX-I2C frame size */
+    NULL,                        /* vdd pin */
+    NULL,                        /* reset pin */
+    &optiga_pal_i2c_context_1    /* optiga pal i2c context */
+};
+
+/**
+ * \brief Comms context of the second OPTIGA.
+ */
+optiga_comms_t optiga_comms_1 = {(void*)&ifx_i2c_context_1, NULL, NULL, OPTIGA_COMMS_SUCCESS};
+#endif
+
+/* comms context of the first OPTIGA, defined by the application for optiga_util_open_application */
+extern optiga_comms_t optiga_comms;
+
+/*********************************************************************************************************************
+ * Chip tables *********************************************************************************************************************/
+pal_i2c_t * const optiga_pal_i2c_table[PAL_OPTIGA_CHIP_COUNT] = {
+    &optiga_pal_i2c_context_0,
+#if (PAL_OPTIGA_CHIP_COUNT > 1)
+    &optiga_pal_i2c_context_1,
+#endif
+};
+
+pal_gpio_t * const optiga_reset_table[PAL_OPTIGA_CHIP_COUNT] = {
+    &optiga_reset_0,
+#if (PAL_OPTIGA_CHIP_COUNT > 1)
+    &optiga_reset_1,
+#endif
+};
+
+ifx_i2c_context_t * const optiga_ifx_i2c_table[PAL_OPTIGA_CHIP_COUNT] = {
+    &ifx_i2c_context_0,
+#if (PAL_OPTIGA_CHIP_COUNT > 1)
+    &ifx_i2c_context_1,
+#endif
+};
+
+optiga_comms_t * const optiga_comms_table[PAL_OPTIGA_CHIP_COUNT] = {
+    &optiga_comms,
+#if (PAL_OPTIGA_CHIP_COUNT > 1)
+    &optiga_comms_1,
+#endif
+};
+
 /**
 * @}
 */
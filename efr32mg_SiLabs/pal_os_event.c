@@ -46,7 +46,15 @@
 #include <trustx/optiga/include/optiga/pal/pal_os_event.h>
 #include <trustx/optiga/include/optiga/pal/pal_os_timer.h>
 
+#include "pal_efr32.h"
+
 #define MAX_CALLBACKS 5
+/* Callbacks queued at a time with pal_os_event_post, i.e. the oneshots within the I2C guard time */
+#define MAX_POSTED_CALLBACKS 2
+/* Queue entries left to the interrupt handlers, an I2C completion must never be dropped */
+#define ISR_RESERVED_CALLBACKS PAL_I2C_PIPELINE_DEPTH
+/* Timer callbacks, posted callbacks and the entries reserved for the interrupt handlers */
+#define MAX_QUEUED_CALLBACKS (MAX_CALLBACKS + MAX_POSTED_CALLBACKS + ISR_RESERVED_CALLBACKS)
 
 /*********************************************************************************************************************
  * LOCAL DATA
@@ -61,6 +69,8 @@ typedef struct callbacks {
 
 static TimerHandle_t otxTimer[MAX_CALLBACKS];
 static pal_os_event_clbs_t clbs[MAX_CALLBACKS];
+/* callbacks of interrupt handlers which found the queue full, run by the handler task after the queued ones */
+static pal_os_event_clbs_t isr_clbs[ISR_RESERVED_CALLBACKS];
 
 QueueHandle_t xQueueCallbacks;
 
@@ -100,6 +110,27 @@ timer's ID.  Obtain the count. */
 
 /// @endcond
 
+// Runs the callbacks the interrupt handlers could not queue
+static void pal_os_event_run_isr_clbs(void)
+{
+  pal_os_event_clbs_t clb_params;
+  uint8_t i;
+
+  for (i = 0; i < ISR_RESERVED_CALLBACKS; i++)
+  {
+    portENTER_CRITICAL();
+    clb_params.clb = isr_clbs[i].clb;
+    clb_params.clb_ctx = isr_clbs[i].clb_ctx;
+    isr_clbs[i].clb = NULL;
+    portEXIT_CRITICAL();
+
+    if (clb_params.clb)
+    {
+      clb_params.clb(clb_params.clb_ctx);
+    }
+  }
+}
+
 void vTaskCallbackHandler( void * pvParameters )
 {
   pal_os_event_clbs_t clb_params;
@@ -118,6 +149,8 @@ void vTaskCallbackHandler( void * pvParameters )
         func_args = clb_params.clb_ctx;
         func((void*)func_args);
       }
+      /* the queue was full when an interrupt handler posted, so the task always gets here after it */
+      pal_os_event_run_isr_clbs();
     }
   } while(1);
 }
@@ -159,8 +192,8 @@ pal_status_t pal_os_event_init(void)
 
   }
 
-  /* Create a queue capable of containing MAX_CALLBACKS timers id values. */
-  xQueueCallbacks = xQueueCreate( MAX_CALLBACKS, sizeof( pal_os_event_clbs_t ) );
+  /* Create a queue capable of containing MAX_CALLBACKS timers id values and the posted callbacks. */
+  xQueueCallbacks = xQueueCreate( MAX_QUEUED_CALLBACKS, sizeof( pal_os_event_clbs_t ) );
 
   /* Create the handler for the callbacks. */
   xTaskCreate( vTaskCallbackHandler,       /* Function that implements the task. */
@@ -193,15 +226,23 @@ void pal_os_event_register_callback_oneshot(register_callback callback,
 {
   uint8_t i = 0;
 
+#if (PAL_I2C_POLL_PREDICTOR == 1)
+  time_us = pal_i2c_poll_adjust_delay(callback_args, time_us);
+#endif
+
+  /* the I2C guard time is enforced by pal_i2c, no need for a timer hop */
+  if ((time_us <= PAL_I2C_GUARD_TIME_US) && (pal_os_event_post(callback, callback_args) == PAL_STATUS_SUCCESS)) {
+    return;
+  }
+
   for (i = 0; i < MAX_CALLBACKS; i++)
   {
     portENTER_CRITICAL();
     if( xTimerIsTimerActive( otxTimer[i] ) == pdFALSE )
   {
-      if (time_us < 1000) {
-        time_us = 1000;
-      }
-      xTimerChangePeriod( otxTimer[i], pdMS_TO_TICKS(time_us / 1000), 10 );
+      /* rounded up to whole ticks, at least one */
+      time_us = (time_us < PAL_OS_TICK_US) ? 1 : (uint32_t)((time_us + PAL_OS_TICK_US - 1) / PAL_OS_TICK_US);
+      xTimerChangePeriod( otxTimer[i], (TickType_t)time_us, 10 );
       clbs[i].clb = callback;
       clbs[i].clb_ctx = callback_args;
 
@@ -215,6 +256,72 @@ void pal_os_event_register_callback_oneshot(register_callback callback,
   }
 }
 
+/**
+* Queues the callback to the event handler task without starting a timer.
+* <br>
+*
+* <b>API Details:</b>
+*         The callback is executed by the event handler task in the same order as the timer callbacks,
+*         so the upper layers never run concurrently.<br>
+*
+* \param[in] callback              Callback function pointer
+* \param[in] callback_args         Callback arguments
+*
+*/
+pal_status_t pal_os_event_post(register_callback callback, void* callback_args)
+{
+  pal_os_event_clbs_t clb_params;
+  pal_status_t status = PAL_STATUS_FAILURE;
+
+  clb_params.clb = callback;
+  clb_params.clb_ctx = callback_args;
+
+  portENTER_CRITICAL();
+  /* the entries reserved for the interrupt handlers are not available to the tasks */
+  if ( ( uxQueueSpacesAvailable( xQueueCallbacks ) > ISR_RESERVED_CALLBACKS ) &&
+       ( xQueueSend( xQueueCallbacks, ( void * ) &clb_params, ( TickType_t ) 0 ) == pdTRUE ) )
+  {
+    status = PAL_STATUS_SUCCESS;
+  }
+  portEXIT_CRITICAL();
+  return status;
+}
+
+/**
+* ISR variant of #pal_os_event_post.
+*
+* \param[in] callback              Callback function pointer
+* \param[in] callback_args         Callback arguments
+*
+*/
+pal_status_t pal_os_event_post_from_isr(register_callback callback, void* callback_args)
+{
+  pal_os_event_clbs_t clb_params;
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+  clb_params.clb = callback;
+  clb_params.clb_ctx = callback_args;
+
+  uint8_t i;
+
+  if ( xQueueSendFromISR( xQueueCallbacks, ( void * ) &clb_params, &xHigherPriorityTaskWoken ) != pdTRUE )
+  {
+    /* the handler task is busy with a full queue, it picks up the callback once it is done with the next entry */
+    for (i = 0; i < ISR_RESERVED_CALLBACKS; i++)
+    {
+      if (isr_clbs[i].clb == NULL)
+      {
+        isr_clbs[i].clb_ctx = callback_args;
+        isr_clbs[i].clb = callback;
+        return PAL_STATUS_SUCCESS;
+      }
+    }
+    return PAL_STATUS_FAILURE;
+  }
+  portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+  return PAL_STATUS_SUCCESS;
+}
+
 /**
 * Platform specific task delay function.
 * <br>
@@ -0,0 +1,299 @@
+/**
+* MIT License
+*
+* Copyright (c) 2019 Arrow Electronics
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE
+*
+*
+* \file
+*
+* \brief This file implements the idle time scheduler for OPTIGA background jobs.
+*
+* \ingroup  grPAL
+* @{
+*/
+
+/**********************************************************************************************************************
+ * HEADER FILES
+ *********************************************************************************************************************/
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Optiga based includes */
+#include <trustx/optiga/include/optiga/pal/pal.h>
+#include <trustx/optiga/include/optiga/pal/pal_os_timer.h>
+
+#include "pal_efr32.h"
+
+/**********************************************************************************************************************
+ * MACROS
+ *********************************************************************************************************************/
+/* furthest due time which still compares as in the future, in milliseconds */
+#define PAL_OS_IDLE_FAR_FUTURE_MS   0x7FFFFFFFUL
+
+/*********************************************************************************************************************
+ * LOCAL DATA
+ *********************************************************************************************************************/
+typedef struct {
+    pal_os_idle_job_t job;
+    void * job_ctx;
+    uint8_t priority;
+    uint32_t period_ms;
+    /* time the job is called next */
+    uint32_t due_ms;
+    /* set by pal_os_idle_trigger, a job triggered while it runs is not rescheduled a period later */
+    uint8_t triggered;
+} pal_os_idle_job_entry_t;
+
+/* jobs sorted by descending priority */
+static pal_os_idle_job_entry_t g_jobs[PAL_OS_IDLE_MAX_JOBS];
+static uint8_t g_job_count = 0;
+
+static TaskHandle_t xIdleTaskHandle = NULL;
+static volatile uint32_t g_next_due_ms = 0;
+
+/* foreground tasks waiting for or holding the OPTIGA lock */
+static volatile uint8_t g_foreground_active = 0;
+static volatile uint32_t g_foreground_last_ms = 0;
+static volatile uint8_t g_background_holds_lock = 0;
+
+static pal_os_idle_stats_t g_idle_stats;
+
+/**********************************************************************************************************************
+ * LOCAL ROUTINES
+ *********************************************************************************************************************/
+// Runs the due jobs until they have nothing to do or a foreground request arrives
+static void pal_os_idle_run(void)
+{
+    uint32_t now;
+    uint32_t next_due;
+    uint8_t ran;
+    uint8_t i;
+
+    do {
+        ran = 0;
+        now = pal_os_timer_get_time_in_milliseconds();
+        next_due = now + PAL_OS_IDLE_FAR_FUTURE_MS;
+
+        for (i = 0; i < g_job_count; i++) {
+            if (pal_os_idle_should_yield()) {
+                g_next_due_ms = now;
+                return;
+            }
+            if ((int32_t)(g_jobs[i].due_ms - now) > 0) {
+                if ((int32_t)(g_jobs[i].due_ms - next_due) < 0) {
+                    next_due = g_jobs[i].due_ms;
+                }
+                continue;
+            }
+            taskENTER_CRITICAL();
+            g_jobs[i].triggered = 0;
+            taskEXIT_CRITICAL();
+            if (g_jobs[i].job(g_jobs[i].job_ctx) == PAL_STATUS_SUCCESS) {
+                g_idle_stats.jobs_run++;
+                ran = 1;
+                /* restart from the highest priority job */
+                break;
+            }
+            taskENTER_CRITICAL();
+            if (g_jobs[i].triggered) {
+                /* work was queued after the job found nothing to do, it stays due */
+                ran = 1;
+            } else {
+                g_jobs[i].due_ms = now + g_jobs[i].period_ms;
+            }
+            taskEXIT_CRITICAL();
+            if (ran) {
+                break;
+            }
+            if ((int32_t)(g_jobs[i].due_ms - next_due) < 0) {
+                next_due = g_jobs[i].due_ms;
+            }
+        }
+    } while (ran);
+
+    /* a job may have been triggered while the others ran */
+    taskENTER_CRITICAL();
+    for (i = 0; i < g_job_count; i++) {
+        if ((int32_t)(g_jobs[i].due_ms - next_due) < 0) {
+            next_due = g_jobs[i].due_ms;
+        }
+    }
+    g_next_due_ms = next_due;
+    taskEXIT_CRITICAL();
+}
+
+static void vTaskIdleScheduler(void * pvParameters)
+{
+    (void)pvParameters;
+
+    do {
+        /* woken by the idle hook once a job is due */
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        pal_os_idle_run();
+    } while (1);
+}
+
+/**********************************************************************************************************************
+ * API IMPLEMENTATION
+ *********************************************************************************************************************/
+pal_status_t pal_os_idle_init(void)
+{
+    if (xIdleTaskHandle != NULL) {
+        return PAL_STATUS_SUCCESS;
+    }
+
+    if (xTaskCreate(vTaskIdleScheduler,            /* Function that implements the task. */
+                    "OtxIdle",                     /* Text name for the task. */
+                    configMINIMAL_STACK_SIZE * 5,  /* Stack size in words, not bytes. */
+                    NULL,                          /* Parameter passed into the task. */
+                    PAL_OS_IDLE_TASK_PRIORITY,     /* Priority at which the task is created. */
+                    &xIdleTaskHandle) != pdPASS) {
+        return PAL_STATUS_FAILURE;
+    }
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t pal_os_idle_register(pal_os_idle_job_t job, void* job_ctx, uint8_t priority, uint32_t period_ms)
+{
+    uint8_t i;
+
+    if ((job == NULL) || (g_job_count >= PAL_OS_IDLE_MAX_JOBS)) {
+        return PAL_STATUS_FAILURE;
+    }
+
+    taskENTER_CRITICAL();
+    /* insert sorted by priority, equal priorities keep the registration order */
+    for (i = g_job_count; (i > 0) && (g_jobs[i - 1].priority < priority); i--) {
+        g_jobs[i] = g_jobs[i - 1];
+    }
+    g_jobs[i].job = job;
+    g_jobs[i].job_ctx = job_ctx;
+    g_jobs[i].priority = priority;
+    g_jobs[i].period_ms = period_ms;
+    g_jobs[i].due_ms = pal_os_timer_get_time_in_milliseconds();
+    g_jobs[i].triggered = 0;
+    g_job_count++;
+    g_next_due_ms = g_jobs[i].due_ms;
+    taskEXIT_CRITICAL();
+
+    return PAL_STATUS_SUCCESS;
+}
+
+void pal_os_idle_trigger(pal_os_idle_job_t job)
+{
+    uint32_t now = pal_os_timer_get_time_in_milliseconds();
+    uint8_t i;
+
+    taskENTER_CRITICAL();
+    for (i = 0; i < g_job_count; i++) {
+        if (g_jobs[i].job == job) {
+            g_jobs[i].due_ms = now;
+            g_jobs[i].triggered = 1;
+            g_next_due_ms = now;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+void pal_os_idle_hook(void)
+{
+    uint32_t now = pal_os_timer_get_time_in_milliseconds();
+
+    if ((xIdleTaskHandle == NULL) || (g_job_count == 0) || ((int32_t)(g_next_due_ms - now) > 0) ||
+        pal_os_idle_should_yield()) {
+        return;
+    }
+    /* do not wake the scheduler again until it has computed the next due time */
+    g_next_due_ms = now + PAL_OS_IDLE_FAR_FUTURE_MS;
+    (void)xTaskNotifyGive(xIdleTaskHandle);
+}
+
+uint8_t pal_os_idle_in_background(void)
+{
+    return (uint8_t)((xIdleTaskHandle != NULL) && (xTaskGetCurrentTaskHandle() == xIdleTaskHandle));
+}
+
+uint8_t pal_os_idle_should_yield(void)
+{
+    return (uint8_t)((g_foreground_active != 0) ||
+                     ((pal_os_timer_get_time_in_milliseconds() - g_foreground_last_ms) < PAL_OS_IDLE_QUIET_TIME_MS));
+}
+
+void pal_os_idle_get_stats(pal_os_idle_stats_t * p_stats)
+{
+    taskENTER_CRITICAL();
+    *p_stats = g_idle_stats;
+    taskEXIT_CRITICAL();
+}
+
+uint32_t pal_os_idle_lock_requested(uint8_t * p_background_held)
+{
+    *p_background_held = 0;
+    if (!pal_os_idle_in_background()) {
+        taskENTER_CRITICAL();
+        g_foreground_active++;
+        *p_background_held = g_background_holds_lock;
+        taskEXIT_CRITICAL();
+    }
+    return pal_os_timer_get_time_in_milliseconds();
+}
+
+void pal_os_idle_lock_acquired(uint32_t requested_ms, uint8_t background_held)
+{
+    uint32_t delay;
+
+    if (pal_os_idle_in_background()) {
+        g_background_holds_lock = 1;
+        return;
+    }
+
+    /* the wait is attributed to the background work if a job held the lock when the request was made */
+    if (background_held) {
+        delay = pal_os_timer_get_time_in_milliseconds() - requested_ms;
+        taskENTER_CRITICAL();
+        g_idle_stats.foreground_delayed++;
+        g_idle_stats.foreground_delay_ms += delay;
+        if (delay > g_idle_stats.foreground_delay_max_ms) {
+            g_idle_stats.foreground_delay_max_ms = delay;
+        }
+        taskEXIT_CRITICAL();
+    }
+}
+
+void pal_os_idle_lock_released(void)
+{
+    if (pal_os_idle_in_background()) {
+        g_background_holds_lock = 0;
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    if (g_foreground_active > 0) {
+        g_foreground_active--;
+    }
+    g_foreground_last_ms = pal_os_timer_get_time_in_milliseconds();
+    taskEXIT_CRITICAL();
+}
+
+/**
+* @}
+*/
@@ -34,6 +34,7 @@
  *********************************************************************************************************************/
 /* Optiga based includes */
 #include <trustx/optiga/include/optiga/pal/pal_os_lock.h>
+#include <trustx/optiga/include/optiga/pal/pal_os_timer.h>
 
 /*********************************************************************************************************************
  * LOCAL DATA
@@ -73,21 +74,35 @@ void pal_os_lock_release(void)
 }*/
 
 #include "FreeRTOS.h"
+#include "task.h"
 #include "semphr.h"
 
+#include <trustx/optiga/include/optiga/cmd/CommandLib.h>
+
+#include "pal_efr32.h"
+
 SemaphoreHandle_t xLockSemaphoreHandle;
 
 volatile uint8_t first_call_flag = 1;
 
+static pal_os_lock_observer_t g_lock_observers[PAL_OS_LOCK_MAX_OBSERVERS];
+static uint32_t g_lock_acquired_ms = 0;
+
+/* task whose commands go to g_selected_chip, the commands of the others go to chip 0 */
+static TaskHandle_t g_selecting_task = NULL;
+static uint8_t g_selected_chip = 0;
+
 void _lock_init(void)
 {
-  xLockSemaphoreHandle = xSemaphoreCreateBinary();
-  pal_os_lock_release();
+  /* a mutex, so that a background job holding the lock inherits the priority of the foreground task waiting for it */
+  xLockSemaphoreHandle = xSemaphoreCreateMutex();
 }
 
 pal_status_t pal_os_lock_acquire(void)
 {
   pal_status_t status = PAL_STATUS_FAILURE;
+  uint8_t background_held;
+  uint32_t requested_ms;
   vPortEnterCritical();
   if (first_call_flag)
   {
@@ -96,18 +111,65 @@ pal_status_t pal_os_lock_acquire(void)
   }
   vPortExitCritical();
 
+  /* lets the idle scheduler yield to foreground requests and account the delay it causes */
+  requested_ms = pal_os_idle_lock_requested(&background_held);
   if ( xSemaphoreTake(xLockSemaphoreHandle, portMAX_DELAY) == pdTRUE ){
       status = PAL_STATUS_SUCCESS;
   }
+  pal_os_idle_lock_acquired(requested_ms, background_held);
+  g_lock_acquired_ms = pal_os_timer_get_time_in_milliseconds();
+
+#if (PAL_OPTIGA_CHIP_COUNT > 1)
+  /* always set, optiga_util_open_application sets the context of the chip it opens */
+  CmdLib_SetOptigaCommsContext(optiga_comms_table[(g_selecting_task == xTaskGetCurrentTaskHandle()) ?
+                                                  g_selected_chip : 0]);
+#endif
 
   return status;
 }
 
 void pal_os_lock_release(void)
 {
+  uint32_t hold_time_ms = pal_os_timer_get_time_in_milliseconds() - g_lock_acquired_ms;
+  uint8_t i;
+
+  if (!first_call_flag)
+  {
+    for (i = 0; i < PAL_OS_LOCK_MAX_OBSERVERS; i++)
+    {
+      if (g_lock_observers[i] != NULL)
+      {
+        g_lock_observers[i](g_lock_acquired_ms, hold_time_ms);
+      }
+    }
+  }
+  pal_os_idle_lock_released();
   xSemaphoreGive(xLockSemaphoreHandle);
 }
 
+void pal_os_lock_select_chip(uint8_t chip)
+{
+  vPortEnterCritical();
+  g_selecting_task = (chip != 0) ? xTaskGetCurrentTaskHandle() : NULL;
+  g_selected_chip = chip;
+  vPortExitCritical();
+}
+
+pal_status_t pal_os_lock_register_observer(pal_os_lock_observer_t observer)
+{
+  uint8_t i;
+
+  for (i = 0; i < PAL_OS_LOCK_MAX_OBSERVERS; i++)
+  {
+    if (g_lock_observers[i] == NULL)
+    {
+      g_lock_observers[i] = observer;
+      return PAL_STATUS_SUCCESS;
+    }
+  }
+  return PAL_STATUS_FAILURE;
+}
+
 /**
 * @}
 */
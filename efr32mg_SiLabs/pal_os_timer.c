@@ -38,8 +38,12 @@
 #include "task.h"
 #include "timers.h"
 
+#include "sl_sleeptimer.h"
+
 #include <trustx/optiga/include/optiga/pal/pal_os_timer.h>
 
+#include "pal_efr32.h"
+
 /**********************************************************************************************************************
  * API IMPLEMENTATION
  *********************************************************************************************************************/
@@ -54,6 +58,19 @@ uint32_t pal_os_timer_get_time_in_milliseconds(void)
   return xTaskGetTickCount();
 }
 
+/**
+* Get the current time in microseconds<br>
+* Based on the sleeptimer, so the resolution is one sleeptimer tick (about 30 us with the 32768 Hz clock).
+*
+* \retval  uint32_t time in microseconds
+*/
+uint32_t pal_os_timer_get_time_in_microseconds(void)
+{
+  uint64_t ticks = sl_sleeptimer_get_tick_count64();
+
+  return (uint32_t)((ticks * 1000000ULL) / sl_sleeptimer_get_timer_frequency());
+}
+
 /**
 * Waits or delays until the given milliseconds time
 * 
@@ -0,0 +1,47 @@
+/**
+ * \file
+ *
+ * \brief Single threaded stand-in for the FreeRTOS services used by the modules under test: critical sections nest,
+ * mutexes are counters which are always free when taken.
+ */
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+static unsigned int g_critical_nesting;
+static int g_task;
+
+void vPortEnterCritical(void)
+{
+    g_critical_nesting++;
+}
+
+void vPortExitCritical(void)
+{
+    g_critical_nesting--;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return &g_task;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return calloc(1, sizeof(unsigned int));
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime)
+{
+    (void)xBlockTime;
+    (*(unsigned int *)xSemaphore)++;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore)
+{
+    (*(unsigned int *)xSemaphore)--;
+    return pdTRUE;
+}
@@ -0,0 +1,33 @@
+/* Host stand-in for the FreeRTOS kernel header, declares only what the unit tests use */
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef void * TaskHandle_t;
+typedef void * SemaphoreHandle_t;
+
+#define pdTRUE                  1
+#define pdFALSE                 0
+#define pdPASS                  1
+#define portMAX_DELAY           0xFFFFFFFFUL
+
+#ifndef configTICK_RATE_HZ
+#define configTICK_RATE_HZ      1000
+#endif
+#define configMINIMAL_STACK_SIZE    128
+#define tskIDLE_PRIORITY        0
+
+void vPortEnterCritical(void);
+void vPortExitCritical(void);
+
+#define portENTER_CRITICAL()    vPortEnterCritical()
+#define portEXIT_CRITICAL()     vPortExitCritical()
+#define taskENTER_CRITICAL()    vPortEnterCritical()
+#define taskEXIT_CRITICAL()     vPortExitCritical()
+
+#endif /* INC_FREERTOS_H */
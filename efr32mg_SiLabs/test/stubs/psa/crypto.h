@@ -0,0 +1,86 @@
+/* Host stand-in for the PSA Crypto API header, declares only what the unit tests use */
+#ifndef PSA_CRYPTO_H
+#define PSA_CRYPTO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int32_t psa_status_t;
+typedef uint32_t psa_algorithm_t;
+typedef uint16_t psa_key_type_t;
+typedef uint32_t psa_key_lifetime_t;
+typedef uint32_t psa_key_location_t;
+typedef uint32_t psa_key_usage_t;
+typedef uint32_t mbedtls_svc_key_id_t;
+typedef uint64_t psa_drv_slot_number_t;
+
+#define PSA_SUCCESS                     ((psa_status_t)0)
+#define PSA_ERROR_GENERIC_ERROR         ((psa_status_t)-132)
+#define PSA_ERROR_NOT_SUPPORTED         ((psa_status_t)-134)
+#define PSA_ERROR_INVALID_ARGUMENT      ((psa_status_t)-135)
+#define PSA_ERROR_BAD_STATE             ((psa_status_t)-137)
+#define PSA_ERROR_BUFFER_TOO_SMALL      ((psa_status_t)-138)
+#define PSA_ERROR_DOES_NOT_EXIST        ((psa_status_t)-140)
+#define PSA_ERROR_INSUFFICIENT_MEMORY   ((psa_status_t)-141)
+#define PSA_ERROR_HARDWARE_FAILURE      ((psa_status_t)-147)
+#define PSA_ERROR_INVALID_SIGNATURE     ((psa_status_t)-149)
+
+#define PSA_ALG_SHA_256                 ((psa_algorithm_t)0x02000009)
+#define PSA_ALG_ANY_HASH                ((psa_algorithm_t)0x020000ff)
+#define PSA_ALG_ECDSA(hash_alg)         ((psa_algorithm_t)(0x06000600 | ((hash_alg) & 0xff)))
+#define PSA_ALG_IS_ECDSA(alg)           (((alg) & ~0x000001ffU) == 0x06000600)
+#define PSA_ALG_ECDH                    ((psa_algorithm_t)0x09020000)
+#define PSA_ALG_IS_ECDH(alg)            (((alg) & 0x7fff0000) == 0x09020000)
+
+#define PSA_ECC_FAMILY_SECP_R1          0x12
+#define PSA_KEY_TYPE_ECC_KEY_PAIR(curve)    ((psa_key_type_t)(0x7100 | (curve)))
+#define PSA_KEY_TYPE_ECC_PUBLIC_KEY(curve)  ((psa_key_type_t)(0x4100 | (curve)))
+#define PSA_KEY_TYPE_IS_ECC_KEY_PAIR(type)  (((type) & 0xff00) == 0x7100)
+#define PSA_KEY_TYPE_ECC_GET_FAMILY(type)   ((type) & 0xff)
+
+#define PSA_KEY_PERSISTENCE_VOLATILE    0x00
+#define PSA_KEY_PERSISTENCE_READ_ONLY   0xff
+#define PSA_KEY_LIFETIME_FROM_PERSISTENCE_AND_LOCATION(persistence, location) \
+    ((psa_key_lifetime_t)(((location) << 8) | (persistence)))
+#define PSA_KEY_LIFETIME_GET_LOCATION(lifetime)   ((psa_key_location_t)((lifetime) >> 8))
+
+#define PSA_KEY_USAGE_SIGN_HASH         ((psa_key_usage_t)0x1000)
+#define PSA_KEY_USAGE_VERIFY_HASH       ((psa_key_usage_t)0x2000)
+#define PSA_KEY_USAGE_DERIVE            ((psa_key_usage_t)0x4000)
+
+typedef struct psa_hash_operation_s {
+    uint32_t state[8];
+} psa_hash_operation_t;
+#define PSA_HASH_OPERATION_INIT         { { 0 } }
+
+typedef struct psa_key_attributes_s {
+    psa_key_type_t type;
+    size_t bits;
+    psa_key_lifetime_t lifetime;
+} psa_key_attributes_t;
+#define PSA_KEY_ATTRIBUTES_INIT         { 0, 0, 0 }
+
+psa_status_t psa_hash_compute(psa_algorithm_t alg, const uint8_t * input, size_t input_length, uint8_t * hash,
+                              size_t hash_size, size_t * hash_length);
+psa_status_t psa_hash_setup(psa_hash_operation_t * operation, psa_algorithm_t alg);
+psa_status_t psa_hash_update(psa_hash_operation_t * operation, const uint8_t * input, size_t input_length);
+psa_status_t psa_hash_finish(psa_hash_operation_t * operation, uint8_t * hash, size_t hash_size,
+                             size_t * hash_length);
+psa_status_t psa_hash_abort(psa_hash_operation_t * operation);
+
+psa_key_type_t psa_get_key_type(const psa_key_attributes_t * attributes);
+size_t psa_get_key_bits(const psa_key_attributes_t * attributes);
+void psa_set_key_type(psa_key_attributes_t * attributes, psa_key_type_t type);
+void psa_set_key_bits(psa_key_attributes_t * attributes, size_t bits);
+void psa_set_key_lifetime(psa_key_attributes_t * attributes, psa_key_lifetime_t lifetime);
+void psa_set_key_usage_flags(psa_key_attributes_t * attributes, psa_key_usage_t usage_flags);
+void psa_set_key_algorithm(psa_key_attributes_t * attributes, psa_algorithm_t alg);
+
+psa_status_t psa_import_key(const psa_key_attributes_t * attributes, const uint8_t * data, size_t data_length,
+                            mbedtls_svc_key_id_t * key);
+psa_status_t psa_destroy_key(mbedtls_svc_key_id_t key);
+psa_status_t psa_verify_hash(mbedtls_svc_key_id_t key, psa_algorithm_t alg, const uint8_t * hash,
+                             size_t hash_length, const uint8_t * signature, size_t signature_length);
+psa_status_t psa_generate_random(uint8_t * output, size_t output_size);
+
+#endif /* PSA_CRYPTO_H */
@@ -0,0 +1,7 @@
+/* Host stand-in for the Gecko SDK I2CSPM driver header, declares only what the unit tests use */
+#ifndef SL_I2CSPM_H
+#define SL_I2CSPM_H
+
+typedef struct sl_i2cspm sl_i2cspm_t;
+
+#endif /* SL_I2CSPM_H */
@@ -0,0 +1,9 @@
+/* Host stand-in for the FreeRTOS task header, declares only what the unit tests use */
+#ifndef INC_TASK_H
+#define INC_TASK_H
+
+#include "FreeRTOS.h"
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+#endif /* INC_TASK_H */
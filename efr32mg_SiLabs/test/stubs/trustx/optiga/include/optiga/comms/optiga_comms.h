@@ -0,0 +1,14 @@
+/* Host stand-in for the OPTIGA Trust X host library header, declares only what the unit tests use */
+#ifndef _OPTIGA_COMMS_H_
+#define _OPTIGA_COMMS_H_
+
+#include <stdint.h>
+
+typedef struct optiga_comms {
+    void* comms_ctx;
+    void* upper_layer_ctx;
+    void* upper_layer_handler;
+    uint8_t state;
+} optiga_comms_t;
+
+#endif /* _OPTIGA_COMMS_H_ */
@@ -0,0 +1,19 @@
+/* Host stand-in for the OPTIGA Trust X host library header, declares only what the unit tests use */
+#ifndef _IFXI2C_CONFIG_H_
+#define _IFXI2C_CONFIG_H_
+
+#include "../pal/pal_gpio.h"
+#include "../pal/pal_i2c.h"
+
+#define DL_MAX_FRAME_SIZE       (0x0115)
+
+typedef struct ifx_i2c_context {
+    uint8_t slave_address;
+    uint16_t frequency;
+    uint16_t frame_size;
+    pal_gpio_t* p_slave_vdd_pin;
+    pal_gpio_t* p_slave_reset_pin;
+    pal_i2c_t* p_pal_i2c_ctx;
+} ifx_i2c_context_t;
+
+#endif /* _IFXI2C_CONFIG_H_ */
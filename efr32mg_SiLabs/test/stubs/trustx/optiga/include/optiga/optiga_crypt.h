@@ -0,0 +1,77 @@
+/* Host stand-in for the OPTIGA Trust X host library header, declares only what the unit tests use */
+#ifndef _OPTIGA_CRYPT_H_
+#define _OPTIGA_CRYPT_H_
+
+#include "optiga_util.h"
+
+typedef uint8_t bool_t;
+
+#define TRUE                            (1)
+#define FALSE                           (0)
+
+typedef enum optiga_rng_types {
+    OPTIGA_RNG_TYPE_TRNG = 0x00,
+    OPTIGA_RNG_TYPE_DRNG = 0x01
+} optiga_rng_types_t;
+
+typedef enum optiga_ecc_curve {
+    OPTIGA_ECC_NIST_P_256 = 0x03,
+    OPTIGA_ECC_NIST_P_384 = 0x04
+} optiga_ecc_curve_t;
+
+typedef enum optiga_key_usage {
+    OPTIGA_KEY_USAGE_AUTHENTICATION = 0x01,
+    OPTIGA_KEY_USAGE_SIGN = 0x10,
+    OPTIGA_KEY_USAGE_KEY_AGREEMENT = 0x20
+} optiga_key_usage_t;
+
+typedef enum optiga_key_id {
+    OPTIGA_KEY_STORE_ID_E0F0 = 0xE0F0,
+    OPTIGA_KEY_STORE_ID_E0F1 = 0xE0F1,
+    OPTIGA_KEY_STORE_ID_E0F2 = 0xE0F2,
+    OPTIGA_KEY_STORE_ID_E0F3 = 0xE0F3,
+    OPTIGA_SESSION_ID_E100 = 0xE100,
+    OPTIGA_SESSION_ID_E101 = 0xE101,
+    OPTIGA_SESSION_ID_E102 = 0xE102,
+    OPTIGA_SESSION_ID_E103 = 0xE103
+} optiga_key_id_t;
+
+#define OPTIGA_CRYPT_OID_DATA           (0x00)
+#define OPTIGA_CRYPT_HOST_DATA          (0x01)
+
+#define OPTIGA_HASH_TYPE_SHA_256        (0xE2)
+#define OPTIGA_HASH_CONTEXT_LENGTH_SHA_256  (209)
+
+typedef struct public_key_from_host {
+    uint8_t * public_key;
+    uint16_t length;
+    uint8_t curve;
+} public_key_from_host_t;
+
+typedef struct hash_data_from_host {
+    const uint8_t * buffer;
+    uint32_t length;
+} hash_data_from_host_t;
+
+typedef struct optiga_hash_context {
+    uint8_t * context_buffer;
+    uint16_t context_buffer_length;
+    uint8_t hash_algo;
+} optiga_hash_context_t;
+
+optiga_lib_status_t optiga_crypt_ecc_generate_keypair(optiga_ecc_curve_t curve_id, uint8_t key_usage,
+                                                      bool_t export_private_key, void * private_key,
+                                                      uint8_t * public_key, uint16_t * public_key_length);
+optiga_lib_status_t optiga_crypt_ecdsa_sign(uint8_t * digest, uint8_t digest_length, optiga_key_id_t private_key,
+                                            uint8_t * signature, uint16_t * signature_length);
+optiga_lib_status_t optiga_crypt_ecdsa_verify(uint8_t * digest, uint8_t digest_length, uint8_t * signature,
+                                              uint16_t signature_length, uint8_t public_key_source_type,
+                                              void * public_key);
+optiga_lib_status_t optiga_crypt_ecdh(optiga_key_id_t private_key, public_key_from_host_t * public_key,
+                                      bool_t export_to_host, uint8_t * shared_secret);
+optiga_lib_status_t optiga_crypt_hash_start(optiga_hash_context_t * hash_ctx);
+optiga_lib_status_t optiga_crypt_hash_update(optiga_hash_context_t * hash_ctx, uint8_t source_of_data_to_hash,
+                                             void * data_to_hash);
+optiga_lib_status_t optiga_crypt_hash_finalize(optiga_hash_context_t * hash_ctx, uint8_t * hash_output);
+
+#endif /* _OPTIGA_CRYPT_H_ */
@@ -0,0 +1,25 @@
+/* Host stand-in for the OPTIGA Trust X host library header, declares only what the unit tests use */
+#ifndef _OPTIGA_UTIL_H_
+#define _OPTIGA_UTIL_H_
+
+#include <stdint.h>
+
+#include "comms/optiga_comms.h"
+
+typedef int32_t optiga_lib_status_t;
+
+#define OPTIGA_LIB_SUCCESS              (0x0000)
+#define OPTIGA_LIB_ERROR                (0xFF)
+
+#define OPTIGA_UTIL_WRITE_ONLY          (0x00)
+#define OPTIGA_UTIL_ERASE_AND_WRITE     (0x40)
+
+optiga_lib_status_t optiga_util_open_application(optiga_comms_t * p_comms);
+optiga_lib_status_t optiga_util_read_data(uint16_t optiga_oid, uint16_t offset, uint8_t * buffer,
+                                          uint16_t * length);
+optiga_lib_status_t optiga_util_read_metadata(uint16_t optiga_oid, uint8_t * buffer, uint16_t * length);
+optiga_lib_status_t optiga_util_write_data(uint16_t optiga_oid, uint8_t write_type, uint16_t offset,
+                                           uint8_t * buffer, uint16_t length);
+optiga_lib_status_t optiga_util_write_metadata(uint16_t optiga_oid, uint8_t * buffer, uint8_t length);
+
+#endif /* _OPTIGA_UTIL_H_ */
@@ -0,0 +1,14 @@
+/* Host stand-in for the OPTIGA Trust X host library header, declares only what the unit tests use */
+#ifndef _PAL_H_
+#define _PAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint16_t pal_status_t;
+
+#define PAL_STATUS_SUCCESS      (0x0000)
+#define PAL_STATUS_FAILURE      (0x0001)
+#define PAL_STATUS_I2C_BUSY     (0x0002)
+
+#endif /* _PAL_H_ */
@@ -0,0 +1,14 @@
+/* Host stand-in for the OPTIGA Trust X host library header, declares only what the unit tests use */
+#ifndef _PAL_GPIO_H_
+#define _PAL_GPIO_H_
+
+#include "pal.h"
+
+typedef struct pal_gpio {
+    void* p_gpio_hw;
+} pal_gpio_t;
+
+void pal_gpio_set_high(const pal_gpio_t* p_gpio_context);
+void pal_gpio_set_low(const pal_gpio_t* p_gpio_context);
+
+#endif /* _PAL_GPIO_H_ */
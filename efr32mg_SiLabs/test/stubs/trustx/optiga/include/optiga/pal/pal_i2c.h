@@ -0,0 +1,23 @@
+/* Host stand-in for the OPTIGA Trust X host library header, declares only what the unit tests use */
+#ifndef _PAL_I2C_H_
+#define _PAL_I2C_H_
+
+#include "pal.h"
+
+#define PAL_I2C_EVENT_SUCCESS   (0x0000)
+#define PAL_I2C_EVENT_ERROR     (0x0001)
+#define PAL_I2C_EVENT_BUSY      (0x0002)
+
+typedef void (*app_event_handler_t)(void* upper_layer_ctx, uint16_t event);
+
+typedef struct pal_i2c {
+    void* p_i2c_hw_config;
+    uint8_t slave_address;
+    void* upper_layer_ctx;
+    void* upper_layer_event_handler;
+} pal_i2c_t;
+
+pal_status_t pal_i2c_write(pal_i2c_t* p_i2c_context, uint8_t* p_data, uint16_t length);
+pal_status_t pal_i2c_read(pal_i2c_t* p_i2c_context, uint8_t* p_data, uint16_t length);
+
+#endif /* _PAL_I2C_H_ */
@@ -0,0 +1,9 @@
+/* Host stand-in for the OPTIGA Trust X host library header, declares only what the unit tests use */
+#ifndef _PAL_OS_EVENT_H_
+#define _PAL_OS_EVENT_H_
+
+#include "pal.h"
+
+typedef void (*register_callback)(void*);
+
+#endif /* _PAL_OS_EVENT_H_ */
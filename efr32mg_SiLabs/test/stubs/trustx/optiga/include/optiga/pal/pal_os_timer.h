@@ -0,0 +1,11 @@
+/* Host stand-in for the OPTIGA Trust X host library header, declares only what the unit tests use */
+#ifndef _PAL_OS_TIMER_H_
+#define _PAL_OS_TIMER_H_
+
+#include "pal.h"
+
+uint32_t pal_os_timer_get_time_in_microseconds(void);
+uint32_t pal_os_timer_get_time_in_milliseconds(void);
+void pal_os_timer_delay_in_milliseconds(uint16_t milliseconds);
+
+#endif /* _PAL_OS_TIMER_H_ */
@@ -0,0 +1,33 @@
+/**
+ * \file
+ *
+ * \brief Minimal checks of the host unit tests: a failed check is reported and the test binary exits non zero.
+ */
+#ifndef _TEST_H_
+#define _TEST_H_
+
+#include <stdio.h>
+
+static unsigned int test_checks;
+static unsigned int test_failures;
+
+#define TEST_CHECK(cond)                                                            \
+    do {                                                                            \
+        test_checks++;                                                              \
+        if (!(cond)) {                                                              \
+            test_failures++;                                                        \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);         \
+        }                                                                           \
+    } while (0)
+
+#define TEST_RUN(test)                                                              \
+    do {                                                                            \
+        printf("  %s\n", #test);                                                    \
+        test();                                                                     \
+    } while (0)
+
+/* result of the test binary, to be returned from main */
+#define TEST_RESULT(name)                                                           \
+    (printf("%s: %u checks, %u failed\n", (name), test_checks, test_failures), (test_failures != 0))
+
+#endif /* _TEST_H_ */
@@ -0,0 +1,247 @@
+/**
+ * \file
+ *
+ * \brief Host tests of the Merkle trees of the attestation batches (optiga_attest_batch.c): the signed root against
+ * a reference tree, and the inclusion proof of every reading for all batch sizes.
+ */
+#include <string.h>
+
+#include "test.h"
+#include "optiga_attest_batch.h"
+
+#include "psa/crypto.h"
+#include <trustx/optiga/include/optiga/pal/pal_os_timer.h>
+
+#define READING_LENGTH  12
+
+static optiga_attest_batch_t g_signed;
+static unsigned int g_signed_count;
+static optiga_lib_status_t g_sign_status;
+
+/*********************************************************************************************************************
+ * OPTIGA and timer stand-ins
+ *********************************************************************************************************************/
+optiga_lib_status_t optiga_crypt_ecdsa_sign(uint8_t * digest, uint8_t digest_length, optiga_key_id_t private_key,
+                                            uint8_t * signature, uint16_t * signature_length)
+{
+    (void)private_key;
+    if (g_sign_status != OPTIGA_LIB_SUCCESS) {
+        return g_sign_status;
+    }
+    /* the digest stands in for the signature */
+    memcpy(signature, digest, digest_length);
+    *signature_length = digest_length;
+    return OPTIGA_LIB_SUCCESS;
+}
+
+uint32_t pal_os_timer_get_time_in_milliseconds(void)
+{
+    return 0;
+}
+
+static void batch_handler(const optiga_attest_batch_t * p_batch, void * p_ctx)
+{
+    (void)p_ctx;
+    g_signed = *p_batch;
+    g_signed_count++;
+}
+
+/*********************************************************************************************************************
+ * Reference tree
+ *********************************************************************************************************************/
+static void reading(uint16_t index, uint8_t value[READING_LENGTH])
+{
+    memset(value, 0, READING_LENGTH);
+    value[0] = 'r';
+    value[1] = (uint8_t)(index >> 8);
+    value[2] = (uint8_t)index;
+}
+
+static void hash(uint8_t prefix, const uint8_t * p_first, size_t first_length, const uint8_t * p_second,
+                 size_t second_length, uint8_t digest[OPTIGA_ATTEST_HASH_LENGTH])
+{
+    psa_hash_operation_t operation = PSA_HASH_OPERATION_INIT;
+    size_t length;
+
+    psa_hash_setup(&operation, PSA_ALG_SHA_256);
+    psa_hash_update(&operation, &prefix, 1);
+    psa_hash_update(&operation, p_first, first_length);
+    psa_hash_update(&operation, p_second, second_length);
+    psa_hash_finish(&operation, digest, OPTIGA_ATTEST_HASH_LENGTH, &length);
+}
+
+/* root over leaves 0x00 || reading and nodes 0x01 || left || right, an odd last node moves up unchanged */
+static void reference_root(uint16_t count, uint8_t root[OPTIGA_ATTEST_HASH_LENGTH])
+{
+    uint8_t level[OPTIGA_ATTEST_BATCH_MAX_LEAVES][OPTIGA_ATTEST_HASH_LENGTH];
+    uint8_t value[READING_LENGTH];
+    uint8_t node[OPTIGA_ATTEST_HASH_LENGTH];
+    uint16_t i;
+
+    for (i = 0; i < count; i++) {
+        reading(i, value);
+        hash(0x00, value, sizeof(value), NULL, 0, level[i]);
+    }
+    while (count > 1) {
+        for (i = 0; i < count; i += 2) {
+            if ((i + 1) < count) {
+                hash(0x01, level[i], OPTIGA_ATTEST_HASH_LENGTH, level[i + 1], OPTIGA_ATTEST_HASH_LENGTH, node);
+                memcpy(level[i / 2], node, OPTIGA_ATTEST_HASH_LENGTH);
+            } else {
+                memcpy(level[i / 2], level[i], OPTIGA_ATTEST_HASH_LENGTH);
+            }
+        }
+        count = (uint16_t)((count + 1) / 2);
+    }
+    memcpy(root, level[0], OPTIGA_ATTEST_HASH_LENGTH);
+}
+
+static void add_readings(uint16_t first, uint16_t count)
+{
+    uint8_t value[READING_LENGTH];
+    uint32_t batch_id;
+    uint16_t leaf_index;
+    uint16_t i;
+
+    for (i = first; i < (first + count); i++) {
+        reading(i, value);
+        TEST_CHECK(optiga_attest_batch_add(value, sizeof(value), &batch_id, &leaf_index) == PAL_STATUS_SUCCESS);
+        TEST_CHECK(leaf_index == i);
+    }
+}
+
+/*********************************************************************************************************************
+ * Tests
+ *********************************************************************************************************************/
+static void test_full_batch_is_signed(void)
+{
+    uint8_t root[OPTIGA_ATTEST_HASH_LENGTH];
+    uint8_t digest[OPTIGA_ATTEST_HASH_LENGTH];
+
+    g_signed_count = 0;
+    TEST_CHECK(optiga_attest_batch_init(OPTIGA_KEY_STORE_ID_E0F1, 5, 1000, batch_handler, NULL) ==
+               PAL_STATUS_SUCCESS);
+    add_readings(0, 4);
+    TEST_CHECK(g_signed_count == 0);
+    add_readings(4, 1);
+    TEST_CHECK(g_signed_count == 1);
+    TEST_CHECK(g_signed.batch_id == 0);
+    TEST_CHECK(g_signed.leaf_count == 5);
+
+    reference_root(5, root);
+    TEST_CHECK(memcmp(g_signed.root, root, sizeof(root)) == 0);
+    TEST_CHECK(optiga_attest_batch_signed_digest(&g_signed, digest) == PAL_STATUS_SUCCESS);
+    TEST_CHECK(g_signed.signature_length == OPTIGA_ATTEST_HASH_LENGTH);
+    TEST_CHECK(memcmp(g_signed.signature, digest, sizeof(digest)) == 0);
+}
+
+static void test_proofs_of_all_batch_sizes(void)
+{
+    optiga_attest_proof_t proof;
+    uint8_t value[READING_LENGTH];
+    uint8_t root[OPTIGA_ATTEST_HASH_LENGTH];
+    uint8_t proven[OPTIGA_ATTEST_HASH_LENGTH];
+    uint16_t count;
+    uint16_t i;
+
+    for (count = 1; count <= OPTIGA_ATTEST_BATCH_MAX_LEAVES; count++) {
+        TEST_CHECK(optiga_attest_batch_init(OPTIGA_KEY_STORE_ID_E0F1, OPTIGA_ATTEST_BATCH_MAX_LEAVES, 1000,
+                                            batch_handler, NULL) == PAL_STATUS_SUCCESS);
+        add_readings(0, count);
+        /* the last size fills the batch, which is then signed by the add */
+        if (count < OPTIGA_ATTEST_BATCH_MAX_LEAVES) {
+            TEST_CHECK(optiga_attest_batch_flush() == PAL_STATUS_SUCCESS);
+        }
+        reference_root(count, root);
+        TEST_CHECK(g_signed.leaf_count == count);
+        TEST_CHECK(memcmp(g_signed.root, root, sizeof(root)) == 0);
+
+        for (i = 0; i < count; i++) {
+            reading(i, value);
+            TEST_CHECK(optiga_attest_batch_proof(0, i, &proof) == PAL_STATUS_SUCCESS);
+            TEST_CHECK(optiga_attest_batch_root_from_proof(value, sizeof(value), &proof, proven) ==
+                       PAL_STATUS_SUCCESS);
+            TEST_CHECK(memcmp(proven, root, sizeof(root)) == 0);
+        }
+        TEST_CHECK(optiga_attest_batch_proof(0, count, &proof) == PAL_STATUS_FAILURE);
+        TEST_CHECK(optiga_attest_batch_proof(1, 0, &proof) == PAL_STATUS_FAILURE);
+    }
+}
+
+static void test_proof_depth(void)
+{
+    optiga_attest_proof_t proof;
+
+    /* five leaves: the fifth is promoted twice and only meets a sibling at the top */
+    TEST_CHECK(optiga_attest_batch_init(OPTIGA_KEY_STORE_ID_E0F1, 8, 1000, batch_handler, NULL) ==
+               PAL_STATUS_SUCCESS);
+    add_readings(0, 5);
+    TEST_CHECK(optiga_attest_batch_flush() == PAL_STATUS_SUCCESS);
+    TEST_CHECK(optiga_attest_batch_proof(0, 0, &proof) == PAL_STATUS_SUCCESS);
+    TEST_CHECK(proof.depth == 3);
+    TEST_CHECK(proof.left_mask == 0);
+    TEST_CHECK(optiga_attest_batch_proof(0, 3, &proof) == PAL_STATUS_SUCCESS);
+    TEST_CHECK(proof.depth == 3);
+    TEST_CHECK(proof.left_mask == 0x03);
+    TEST_CHECK(optiga_attest_batch_proof(0, 4, &proof) == PAL_STATUS_SUCCESS);
+    TEST_CHECK(proof.depth == 1);
+    TEST_CHECK(proof.left_mask == 0x01);
+}
+
+static void test_tampered_proof(void)
+{
+    optiga_attest_proof_t proof;
+    uint8_t value[READING_LENGTH];
+    uint8_t proven[OPTIGA_ATTEST_HASH_LENGTH];
+
+    TEST_CHECK(optiga_attest_batch_init(OPTIGA_KEY_STORE_ID_E0F1, 8, 1000, batch_handler, NULL) ==
+               PAL_STATUS_SUCCESS);
+    add_readings(0, 6);
+    TEST_CHECK(optiga_attest_batch_flush() == PAL_STATUS_SUCCESS);
+    TEST_CHECK(optiga_attest_batch_proof(0, 2, &proof) == PAL_STATUS_SUCCESS);
+
+    /* another reading */
+    reading(3, value);
+    TEST_CHECK(optiga_attest_batch_root_from_proof(value, sizeof(value), &proof, proven) == PAL_STATUS_SUCCESS);
+    TEST_CHECK(memcmp(proven, g_signed.root, sizeof(proven)) != 0);
+
+    /* the right reading on the wrong side */
+    reading(2, value);
+    proof.left_mask ^= 0x01;
+    TEST_CHECK(optiga_attest_batch_root_from_proof(value, sizeof(value), &proof, proven) == PAL_STATUS_SUCCESS);
+    TEST_CHECK(memcmp(proven, g_signed.root, sizeof(proven)) != 0);
+
+    proof.depth = OPTIGA_ATTEST_MAX_PROOF_DEPTH + 1;
+    TEST_CHECK(optiga_attest_batch_root_from_proof(value, sizeof(value), &proof, proven) == PAL_STATUS_FAILURE);
+}
+
+static void test_unsigned_batch_is_retried(void)
+{
+    optiga_attest_batch_stats_t stats;
+
+    g_signed_count = 0;
+    TEST_CHECK(optiga_attest_batch_init(OPTIGA_KEY_STORE_ID_E0F1, 8, 1000, batch_handler, NULL) ==
+               PAL_STATUS_SUCCESS);
+    add_readings(0, 3);
+    g_sign_status = OPTIGA_LIB_ERROR;
+    TEST_CHECK(optiga_attest_batch_flush() == PAL_STATUS_FAILURE);
+    g_sign_status = OPTIGA_LIB_SUCCESS;
+    TEST_CHECK(optiga_attest_batch_process() == PAL_STATUS_SUCCESS);
+    TEST_CHECK(g_signed_count == 1);
+    TEST_CHECK(g_signed.leaf_count == 3);
+
+    optiga_attest_batch_get_stats(&stats);
+    TEST_CHECK(stats.readings == 3);
+    TEST_CHECK(stats.sign_errors == 1);
+    TEST_CHECK(stats.batches_signed == 1);
+}
+
+int main(void)
+{
+    TEST_RUN(test_full_batch_is_signed);
+    TEST_RUN(test_proofs_of_all_batch_sizes);
+    TEST_RUN(test_proof_depth);
+    TEST_RUN(test_tampered_proof);
+    TEST_RUN(test_unsigned_batch_is_retried);
+    return TEST_RESULT("test_attest_batch");
+}
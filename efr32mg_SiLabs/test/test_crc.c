@@ -0,0 +1,86 @@
+/**
+ * \file
+ *
+ * \brief Host tests of the table driven CRC of the IFX I2C frames (pal_crc.c built without the GPCRC), against a
+ * bitwise CRC-16/KERMIT over all lengths and alignments of a frame.
+ */
+#include "test.h"
+#include "pal_efr32.h"
+
+#if (PAL_CRC_GPCRC != 0)
+#error "The tables are tested without the GPCRC"
+#endif
+
+#define FRAME_LENGTH    300
+
+/* CRC-16/CCITT reflected (polynomial 0x8408), initial value 0 */
+static uint16_t reference_crc16(const uint8_t * p_data, uint16_t length)
+{
+    uint16_t crc = 0;
+    uint8_t bit;
+
+    while (length--) {
+        crc ^= *p_data++;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ 0x8408) : (uint16_t)(crc >> 1);
+        }
+    }
+    return crc;
+}
+
+static void test_check_value(void)
+{
+    const uint8_t check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+
+    TEST_CHECK(reference_crc16(check, sizeof(check)) == 0x2189);
+    TEST_CHECK(pal_crc16(check, sizeof(check)) == 0x2189);
+    TEST_CHECK(pal_crc16(check, 0) == 0);
+}
+
+/* the slicing tables: entry b of table k is the CRC of b followed by k zero bytes */
+static void test_tables(void)
+{
+    uint8_t data[8] = { 0 };
+    unsigned int failures = 0;
+    uint16_t k;
+    uint16_t b;
+
+    for (k = 0; k < 8; k++) {
+        for (b = 0; b < 256; b++) {
+            data[0] = (uint8_t)b;
+            if (pal_crc16(data, (uint16_t)(k + 1)) != reference_crc16(data, (uint16_t)(k + 1))) {
+                failures++;
+            }
+        }
+    }
+    TEST_CHECK(failures == 0);
+}
+
+static void test_lengths_and_alignments(void)
+{
+    uint8_t frame[FRAME_LENGTH + 8];
+    unsigned int failures = 0;
+    uint16_t offset;
+    uint16_t length;
+    uint16_t i;
+
+    for (i = 0; i < sizeof(frame); i++) {
+        frame[i] = (uint8_t)((i * 167) ^ (i >> 3));
+    }
+    for (offset = 0; offset < 8; offset++) {
+        for (length = 0; length <= FRAME_LENGTH; length++) {
+            if (pal_crc16(&frame[offset], length) != reference_crc16(&frame[offset], length)) {
+                failures++;
+            }
+        }
+    }
+    TEST_CHECK(failures == 0);
+}
+
+int main(void)
+{
+    TEST_RUN(test_check_value);
+    TEST_RUN(test_tables);
+    TEST_RUN(test_lengths_and_alignments);
+    return TEST_RESULT("test_crc");
+}
@@ -0,0 +1,134 @@
+/**
+ * \file
+ *
+ * \brief Host tests of the governor policy (optiga_governor_decide): current limitation under bursts and idle, sleep
+ * activation delay and the hysteresis of both.
+ */
+#include "test.h"
+#include "optiga_governor.h"
+
+#include <trustx/optiga/include/optiga/optiga_util.h>
+#include <trustx/optiga/include/optiga/pal/pal_os_timer.h>
+
+#include "pal_efr32.h"
+
+static const optiga_governor_config_t g_config = {
+    .low_current_ma = 6,
+    .high_current_ma = 15,
+    .burst_interval_ms = 100,
+    .idle_time_ms = 5000
+};
+
+/*********************************************************************************************************************
+ * Services of the idle job, not reached by the policy
+ *********************************************************************************************************************/
+optiga_lib_status_t optiga_util_read_data(uint16_t optiga_oid, uint16_t offset, uint8_t * buffer, uint16_t * length)
+{
+    (void)optiga_oid;
+    (void)offset;
+    (void)buffer;
+    (void)length;
+    return OPTIGA_LIB_ERROR;
+}
+
+optiga_lib_status_t optiga_util_write_data(uint16_t optiga_oid, uint8_t write_type, uint16_t offset,
+                                           uint8_t * buffer, uint16_t length)
+{
+    (void)optiga_oid;
+    (void)write_type;
+    (void)offset;
+    (void)buffer;
+    (void)length;
+    return OPTIGA_LIB_ERROR;
+}
+
+uint8_t pal_os_idle_in_background(void)
+{
+    return 0;
+}
+
+pal_status_t pal_os_lock_register_observer(pal_os_lock_observer_t observer)
+{
+    (void)observer;
+    return PAL_STATUS_FAILURE;
+}
+
+uint32_t pal_os_timer_get_time_in_milliseconds(void)
+{
+    return 0;
+}
+
+/*********************************************************************************************************************
+ * Tests
+ *********************************************************************************************************************/
+static optiga_governor_output_t decide(uint32_t inter_arrival_ms, uint32_t since_last_request_ms, uint8_t on_battery,
+                                       uint8_t applied_current_ma, uint8_t applied_sleep_delay_ms)
+{
+    optiga_governor_input_t input;
+    optiga_governor_output_t output;
+
+    input.inter_arrival_ms = inter_arrival_ms;
+    input.since_last_request_ms = since_last_request_ms;
+    input.on_battery = on_battery;
+    input.applied.current_ma = applied_current_ma;
+    input.applied.sleep_delay_ms = applied_sleep_delay_ms;
+    optiga_governor_decide(&g_config, &input, &output);
+    return output;
+}
+
+static void test_current_follows_bursts(void)
+{
+    TEST_CHECK(decide(50, 10, 0, 6, 0).current_ma == 15);
+    TEST_CHECK(decide(100, 10, 0, 6, 0).current_ma == 15);
+    TEST_CHECK(decide(101, 10, 0, 6, 0).current_ma == 6);
+}
+
+static void test_current_hysteresis(void)
+{
+    /* the high current is kept up to twice the burst interval, the low current is not left before the interval */
+    TEST_CHECK(decide(150, 10, 0, 15, 0).current_ma == 15);
+    TEST_CHECK(decide(200, 10, 0, 15, 0).current_ma == 15);
+    TEST_CHECK(decide(201, 10, 0, 15, 0).current_ma == 6);
+    TEST_CHECK(decide(150, 10, 0, 6, 0).current_ma == 6);
+}
+
+static void test_current_idle_and_battery(void)
+{
+    TEST_CHECK(decide(50, 4999, 0, 15, 0).current_ma == 15);
+    TEST_CHECK(decide(50, 5000, 0, 15, 0).current_ma == 6);
+    TEST_CHECK(decide(50, 10, 1, 15, 0).current_ma == 6);
+}
+
+static void test_sleep_delay(void)
+{
+    /* a quarter above the typical gap */
+    TEST_CHECK(decide(80, 10, 0, 6, 0).sleep_delay_ms == 100);
+    /* clamped to the supported range */
+    TEST_CHECK(decide(10, 10, 0, 6, 0).sleep_delay_ms == OPTIGA_GOVERNOR_SLEEP_MIN_MS);
+    TEST_CHECK(decide(240, 10, 0, 6, 0).sleep_delay_ms == OPTIGA_GOVERNOR_SLEEP_MAX_MS);
+    /* gaps longer than the maximum delay or unknown: sleep early */
+    TEST_CHECK(decide(256, 10, 0, 6, 0).sleep_delay_ms == OPTIGA_GOVERNOR_SLEEP_MIN_MS);
+    TEST_CHECK(decide(0, 10, 0, 6, 0).sleep_delay_ms == OPTIGA_GOVERNOR_SLEEP_MIN_MS);
+    TEST_CHECK(decide(80, 10, 1, 6, 0).sleep_delay_ms == OPTIGA_GOVERNOR_SLEEP_MIN_MS);
+}
+
+static void test_sleep_hysteresis(void)
+{
+    /* 75 ms and 45 ms are within the hysteresis of the applied 62 ms, 100 ms and 25 ms are not */
+    TEST_CHECK(decide(60, 10, 0, 6, 62).sleep_delay_ms == 62);
+    TEST_CHECK(decide(36, 10, 0, 6, 62).sleep_delay_ms == 62);
+    TEST_CHECK(decide(80, 10, 0, 6, 62).sleep_delay_ms == 100);
+    TEST_CHECK(decide(20, 10, 0, 6, 62).sleep_delay_ms == 25);
+    /* going to sleep early on battery is always worth the write */
+    TEST_CHECK(decide(40, 10, 1, 6, 40).sleep_delay_ms == OPTIGA_GOVERNOR_SLEEP_MIN_MS);
+}
+
+int main(void)
+{
+    TEST_RUN(test_current_follows_bursts);
+    TEST_RUN(test_current_hysteresis);
+    TEST_RUN(test_current_idle_and_battery);
+    TEST_RUN(test_sleep_delay);
+    TEST_RUN(test_sleep_hysteresis);
+    return TEST_RESULT("test_governor");
+}
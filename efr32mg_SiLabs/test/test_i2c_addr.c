@@ -0,0 +1,267 @@
+/**
+ * \file
+ *
+ * \brief Host tests of the I2C address provisioning (optiga_i2c_addr.c) on a model of OPTIGA chips sharing a bus.
+ *
+ * Each chip of the model answers on its current address unless it is held in reset, a chip released from reset
+ * comes up on its persistent address (the default address until one is written). A transfer to an address several
+ * chips answer on is a collision.
+ */
+#include <string.h>
+
+#include "test.h"
+#include "optiga_i2c_addr.h"
+
+#if (PAL_OPTIGA_CHIP_COUNT != 3)
+#error "The bus model has three chips"
+#endif
+
+/* IFX I2C register of the base address: register, persistence, address */
+#define BASE_ADDR_REG           0x83
+#define BASE_ADDR_PERSISTENT    0x80
+
+typedef struct {
+    uint8_t present;
+    uint8_t in_reset;
+    uint8_t address;
+    uint8_t persistent_address;
+} chip_model_t;
+
+static chip_model_t g_chips[PAL_OPTIGA_CHIP_COUNT];
+static unsigned int g_collisions;
+static unsigned int g_base_address_writes;
+static uint32_t g_time_ms;
+
+/*********************************************************************************************************************
+ * Chip tables of the build under test
+ *********************************************************************************************************************/
+static pal_gpio_t g_reset_pins[PAL_OPTIGA_CHIP_COUNT] = {
+    { &g_chips[0] }, { &g_chips[1] }, { &g_chips[2] }
+};
+static pal_i2c_t g_i2c_contexts[PAL_OPTIGA_CHIP_COUNT];
+static ifx_i2c_context_t g_ifx_i2c_contexts[PAL_OPTIGA_CHIP_COUNT];
+
+pal_gpio_t * const optiga_reset_table[PAL_OPTIGA_CHIP_COUNT] = {
+    &g_reset_pins[0], &g_reset_pins[1], &g_reset_pins[2]
+};
+pal_i2c_t * const optiga_pal_i2c_table[PAL_OPTIGA_CHIP_COUNT] = {
+    &g_i2c_contexts[0], &g_i2c_contexts[1], &g_i2c_contexts[2]
+};
+ifx_i2c_context_t * const optiga_ifx_i2c_table[PAL_OPTIGA_CHIP_COUNT] = {
+    &g_ifx_i2c_contexts[0], &g_ifx_i2c_contexts[1], &g_ifx_i2c_contexts[2]
+};
+
+/*********************************************************************************************************************
+ * PAL of the model
+ *********************************************************************************************************************/
+void pal_gpio_set_low(const pal_gpio_t* p_gpio_context)
+{
+    ((chip_model_t *)p_gpio_context->p_gpio_hw)->in_reset = 1;
+}
+
+void pal_gpio_set_high(const pal_gpio_t* p_gpio_context)
+{
+    chip_model_t * p_chip = (chip_model_t *)p_gpio_context->p_gpio_hw;
+
+    if (p_chip->in_reset) {
+        p_chip->in_reset = 0;
+        p_chip->address = p_chip->persistent_address;
+    }
+}
+
+void pal_gpio_set_bulk(pal_gpio_t * const * pp_gpio_contexts, uint8_t count, uint8_t level)
+{
+    uint8_t i;
+
+    for (i = 0; i < count; i++) {
+        if (level) {
+            pal_gpio_set_high(pp_gpio_contexts[i]);
+        } else {
+            pal_gpio_set_low(pp_gpio_contexts[i]);
+        }
+    }
+}
+
+uint32_t pal_os_timer_get_time_in_milliseconds(void)
+{
+    return g_time_ms;
+}
+
+void pal_os_timer_delay_in_milliseconds(uint16_t milliseconds)
+{
+    g_time_ms += milliseconds;
+}
+
+// Returns the only chip answering on the address, NULL if none or several do
+static chip_model_t * bus_select(uint8_t address)
+{
+    chip_model_t * p_found = NULL;
+    unsigned int count = 0;
+    uint8_t i;
+
+    for (i = 0; i < PAL_OPTIGA_CHIP_COUNT; i++) {
+        if (g_chips[i].present && !g_chips[i].in_reset && (g_chips[i].address == address)) {
+            p_found = &g_chips[i];
+            count++;
+        }
+    }
+    if (count > 1) {
+        g_collisions++;
+        return NULL;
+    }
+    return p_found;
+}
+
+static pal_status_t bus_transfer(pal_i2c_t* p_i2c_context, const uint8_t* p_data, uint16_t length, uint8_t is_read)
+{
+    chip_model_t * p_chip = bus_select(p_i2c_context->slave_address);
+
+    if ((p_chip != NULL) && !is_read && (length == 3) && (p_data[0] == BASE_ADDR_REG)) {
+        g_base_address_writes++;
+        p_chip->address = p_data[2];
+        if (p_data[1] & BASE_ADDR_PERSISTENT) {
+            p_chip->persistent_address = p_data[2];
+        }
+    }
+    ((app_event_handler_t)p_i2c_context->upper_layer_event_handler)(p_i2c_context->upper_layer_ctx,
+        (p_chip != NULL) ? PAL_I2C_EVENT_SUCCESS : PAL_I2C_EVENT_ERROR);
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t pal_i2c_write(pal_i2c_t* p_i2c_context, uint8_t* p_data, uint16_t length)
+{
+    return bus_transfer(p_i2c_context, p_data, length, 0);
+}
+
+pal_status_t pal_i2c_read(pal_i2c_t* p_i2c_context, uint8_t* p_data, uint16_t length)
+{
+    return bus_transfer(p_i2c_context, p_data, length, 1);
+}
+
+/*********************************************************************************************************************
+ * Tests
+ *********************************************************************************************************************/
+static const uint8_t g_addresses[PAL_OPTIGA_CHIP_COUNT] = { OPTIGA_I2C_ADDR_DEFAULT, 0x31, 0x32 };
+
+// Chips as delivered, all on the default address and out of reset
+static void model_reset(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < PAL_OPTIGA_CHIP_COUNT; i++) {
+        g_chips[i].present = 1;
+        g_chips[i].in_reset = 0;
+        g_chips[i].address = OPTIGA_I2C_ADDR_DEFAULT;
+        g_chips[i].persistent_address = OPTIGA_I2C_ADDR_DEFAULT;
+        g_i2c_contexts[i].slave_address = OPTIGA_I2C_ADDR_DEFAULT;
+        g_ifx_i2c_contexts[i].slave_address = OPTIGA_I2C_ADDR_DEFAULT;
+    }
+    g_collisions = 0;
+    g_base_address_writes = 0;
+}
+
+// Releases all resets at once, as a bulk reset does
+static void model_bulk_reset(void)
+{
+    pal_gpio_set_bulk(optiga_reset_table, PAL_OPTIGA_CHIP_COUNT, 0);
+    pal_gpio_set_bulk(optiga_reset_table, PAL_OPTIGA_CHIP_COUNT, 1);
+}
+
+static void check_addresses(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < PAL_OPTIGA_CHIP_COUNT; i++) {
+        TEST_CHECK(!g_chips[i].in_reset);
+        TEST_CHECK(g_chips[i].address == g_addresses[i]);
+        TEST_CHECK(g_i2c_contexts[i].slave_address == g_addresses[i]);
+        TEST_CHECK(g_ifx_i2c_contexts[i].slave_address == g_addresses[i]);
+    }
+}
+
+static void test_restore_without_provisioning(void)
+{
+    model_reset();
+    TEST_CHECK(optiga_i2c_addr_restore() == PAL_STATUS_FAILURE);
+    TEST_CHECK(!optiga_i2c_addr_is_volatile());
+}
+
+static void test_invalid_addresses(void)
+{
+    const uint8_t duplicate[PAL_OPTIGA_CHIP_COUNT] = { OPTIGA_I2C_ADDR_DEFAULT, 0x31, 0x31 };
+    const uint8_t out_of_range[PAL_OPTIGA_CHIP_COUNT] = { OPTIGA_I2C_ADDR_DEFAULT, 0x31, 0x80 };
+    const uint8_t first_moved[PAL_OPTIGA_CHIP_COUNT] = { 0x33, 0x31, 0x32 };
+
+    model_reset();
+    TEST_CHECK(optiga_i2c_addr_provision(duplicate, OPTIGA_I2C_ADDR_PERSISTENT) == PAL_STATUS_FAILURE);
+    TEST_CHECK(optiga_i2c_addr_provision(out_of_range, OPTIGA_I2C_ADDR_PERSISTENT) == PAL_STATUS_FAILURE);
+    /* the host library resets the first chip when its session is opened */
+    TEST_CHECK(optiga_i2c_addr_provision(first_moved, OPTIGA_I2C_ADDR_VOLATILE) == PAL_STATUS_FAILURE);
+    TEST_CHECK(g_base_address_writes == 0);
+}
+
+static void test_volatile_provisioning(void)
+{
+    model_reset();
+    TEST_CHECK(optiga_i2c_addr_provision(g_addresses, OPTIGA_I2C_ADDR_VOLATILE) == PAL_STATUS_SUCCESS);
+    TEST_CHECK(g_collisions == 0);
+    TEST_CHECK(optiga_i2c_addr_is_volatile());
+    check_addresses();
+}
+
+static void test_volatile_restore_after_reset(void)
+{
+    model_reset();
+    TEST_CHECK(optiga_i2c_addr_provision(g_addresses, OPTIGA_I2C_ADDR_VOLATILE) == PAL_STATUS_SUCCESS);
+
+    /* the volatile addresses are dropped, all chips come up on the default address */
+    model_bulk_reset();
+    TEST_CHECK(bus_select(OPTIGA_I2C_ADDR_DEFAULT) == NULL);
+    TEST_CHECK(g_collisions == 1);
+
+    g_collisions = 0;
+    TEST_CHECK(optiga_i2c_addr_restore() == PAL_STATUS_SUCCESS);
+    TEST_CHECK(g_collisions == 0);
+    check_addresses();
+}
+
+static void test_persistent_provisioning(void)
+{
+    model_reset();
+    TEST_CHECK(optiga_i2c_addr_provision(g_addresses, OPTIGA_I2C_ADDR_PERSISTENT) == PAL_STATUS_SUCCESS);
+    TEST_CHECK(!optiga_i2c_addr_is_volatile());
+    TEST_CHECK(g_base_address_writes == 2);
+
+    /* kept across a bulk reset, and not written again by a second provisioning */
+    model_bulk_reset();
+    check_addresses();
+    g_base_address_writes = 0;
+    TEST_CHECK(optiga_i2c_addr_provision(g_addresses, OPTIGA_I2C_ADDR_PERSISTENT) == PAL_STATUS_SUCCESS);
+    TEST_CHECK(g_base_address_writes == 0);
+    TEST_CHECK(g_collisions == 0);
+    check_addresses();
+}
+
+static void test_absent_chip(void)
+{
+    model_reset();
+    g_chips[1].present = 0;
+    TEST_CHECK(optiga_i2c_addr_provision(g_addresses, OPTIGA_I2C_ADDR_VOLATILE) == PAL_STATUS_FAILURE);
+    TEST_CHECK(g_collisions == 0);
+    /* held in reset, the chips after it are provisioned nonetheless */
+    TEST_CHECK(g_chips[1].in_reset);
+    TEST_CHECK(g_chips[0].address == g_addresses[0]);
+    TEST_CHECK(g_chips[2].address == g_addresses[2]);
+    TEST_CHECK(g_i2c_contexts[2].slave_address == g_addresses[2]);
+}
+
+int main(void)
+{
+    TEST_RUN(test_restore_without_provisioning);
+    TEST_RUN(test_invalid_addresses);
+    TEST_RUN(test_volatile_provisioning);
+    TEST_RUN(test_volatile_restore_after_reset);
+    TEST_RUN(test_persistent_provisioning);
+    TEST_RUN(test_absent_chip);
+    return TEST_RESULT("test_i2c_addr");
+}
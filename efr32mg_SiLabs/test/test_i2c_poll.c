@@ -0,0 +1,217 @@
+/**
+ * \file
+ *
+ * \brief Host tests of the poll predictor (pal_i2c_poll.c): the command durations learned from the observed
+ * transfers, the first poll before the predicted completion, the backoff after it and the tick rounding of both.
+ * Built with a 2 ms tick so that the rounding to ticks shows.
+ */
+#include "test.h"
+#include "pal_efr32.h"
+
+#include <trustx/optiga/include/optiga/pal/pal_os_timer.h>
+
+#if (PAL_I2C_POLL_PREDICTOR != 1) || (PAL_OS_TICK_US != 2000)
+#error "The tests need the predictor and a 2 ms tick"
+#endif
+
+#define DATA_REG            0x80
+#define STATE_REG           0x82
+#define STATE_BUSY          0x80
+#define STATE_RESP_RDY      0x40
+
+#define COMMAND_SIGN        0xB1
+#define COMMAND_VERIFY      0xB2
+#define COMMAND_US          20000
+
+static uint32_t g_time_us;
+static int g_upper_layer;
+static int g_other_layer;
+static pal_i2c_t g_i2c = { NULL, 0x30, &g_upper_layer, NULL };
+
+uint32_t pal_os_timer_get_time_in_microseconds(void)
+{
+    return g_time_us;
+}
+
+uint32_t pal_os_timer_get_time_in_milliseconds(void)
+{
+    return g_time_us / 1000;
+}
+
+/*********************************************************************************************************************
+ * Transfers of the data link layer
+ *********************************************************************************************************************/
+/* frame written to the data register: register, FCTR, LEN, PCTR, command, parameter */
+static void send_command(uint8_t command, uint16_t payload_length)
+{
+    uint8_t frame[] = { DATA_REG, 0x00, (uint8_t)(payload_length >> 8), (uint8_t)payload_length, 0x00, command, 0 };
+
+    pal_i2c_poll_observe(&g_i2c, 0, 0, frame, sizeof(frame));
+}
+
+/* status register read: flags, reserved, length of the frame to read */
+static void poll_state(uint8_t flags, uint16_t frame_length)
+{
+    uint8_t address = STATE_REG;
+    uint8_t state[4] = { flags, 0x00, (uint8_t)(frame_length >> 8), (uint8_t)frame_length };
+
+    pal_i2c_poll_observe(&g_i2c, 0, 0, &address, 1);
+    pal_i2c_poll_observe(&g_i2c, 1, 0, state, sizeof(state));
+}
+
+/* acknowledge of the frame (control frame of 5 bytes) */
+static void acknowledge(void)
+{
+    poll_state(STATE_RESP_RDY, 5);
+}
+
+/* the physical layer polls again after its poll interval, returns the delay the timer applies */
+static uint32_t poll_busy(void)
+{
+    poll_state(STATE_BUSY, 0);
+    return pal_i2c_poll_adjust_delay(&g_upper_layer, PAL_I2C_POLL_INTERVAL_US);
+}
+
+/* delay of the predicted first poll, whatever the durations learned so far */
+static uint8_t is_predicted(uint32_t delay_us)
+{
+    return (delay_us != PAL_I2C_POLL_INTERVAL_US) && ((delay_us % PAL_OS_TICK_US) == 0);
+}
+
+static void respond(void)
+{
+    poll_state(STATE_RESP_RDY, 40);
+}
+
+/* a command of COMMAND_US, polled busy halfway */
+static void learn(uint8_t command, uint16_t payload_length)
+{
+    uint32_t start_us = g_time_us;
+
+    send_command(command, payload_length);
+    acknowledge();
+    g_time_us = start_us + COMMAND_US / 2;
+    TEST_CHECK(poll_busy() == PAL_I2C_POLL_INTERVAL_US);
+    g_time_us = start_us + COMMAND_US;
+    respond();
+    g_time_us += 100000;
+}
+
+/*********************************************************************************************************************
+ * Tests
+ *********************************************************************************************************************/
+static void test_prediction(void)
+{
+    pal_i2c_poll_stats_t stats;
+    uint32_t start_us;
+
+    /* mean 20 ms, deviation 5.625 ms after two samples of 20 ms */
+    learn(COMMAND_SIGN, 40);
+    learn(COMMAND_SIGN, 40);
+
+    start_us = g_time_us;
+    send_command(COMMAND_SIGN, 40);
+    acknowledge();
+    g_time_us = start_us + 1000;
+    /* 13.375 ms to the predicted 14.375 ms, rounded down to ticks */
+    TEST_CHECK(poll_busy() == 12000);
+    g_time_us = start_us + 13000;
+    /* less than a tick to go */
+    TEST_CHECK(poll_busy() == 2000);
+    g_time_us = start_us + 15000;
+    /* backoff of 1, 2 and 4 ms, rounded up to ticks */
+    TEST_CHECK(poll_busy() == 2000);
+    g_time_us += 2000;
+    TEST_CHECK(poll_busy() == 2000);
+    g_time_us += 2000;
+    TEST_CHECK(poll_busy() == 4000);
+    g_time_us += 4000;
+    TEST_CHECK(poll_busy() == PAL_I2C_POLL_BACKOFF_MAX_US);
+    respond();
+
+    pal_i2c_poll_get_stats(&stats);
+    TEST_CHECK(stats.commands == 3);
+    /* acknowledge, busy and response polls */
+    TEST_CHECK(stats.polls == (2 * 3) + (1 + 6 + 1));
+    TEST_CHECK(stats.early_polls == 2 + 6);
+    /* the physical layer interval takes a tick: 5 polls saved by the first delay, 1 by the last one */
+    TEST_CHECK(stats.polls_avoided == 5 + 1 + 1);
+    TEST_CHECK(stats.latency_saved_us == 0);
+}
+
+static void test_unknown_commands(void)
+{
+    uint32_t start_us = g_time_us;
+
+    /* another command, and the same command in another payload size class */
+    send_command(COMMAND_VERIFY, 40);
+    acknowledge();
+    g_time_us = start_us + 1000;
+    TEST_CHECK(poll_busy() == PAL_I2C_POLL_INTERVAL_US);
+    respond();
+
+    send_command(COMMAND_SIGN, 200);
+    acknowledge();
+    g_time_us = start_us + 1000;
+    TEST_CHECK(poll_busy() == PAL_I2C_POLL_INTERVAL_US);
+    respond();
+    g_time_us += 100000;
+}
+
+static void test_other_timers(void)
+{
+    uint8_t address = STATE_REG + 2;
+    uint32_t start_us = g_time_us;
+
+    send_command(COMMAND_SIGN, 40);
+    acknowledge();
+    g_time_us = start_us + 1000;
+
+    /* another interval or another context */
+    poll_state(STATE_BUSY, 0);
+    TEST_CHECK(pal_i2c_poll_adjust_delay(&g_upper_layer, 5000) == 5000);
+    poll_state(STATE_BUSY, 0);
+    TEST_CHECK(pal_i2c_poll_adjust_delay(&g_other_layer, PAL_I2C_POLL_INTERVAL_US) == PAL_I2C_POLL_INTERVAL_US);
+
+    /* a timer not started right after the busy poll */
+    poll_state(STATE_BUSY, 0);
+    pal_i2c_poll_observe(&g_i2c, 0, 0, &address, 1);
+    TEST_CHECK(pal_i2c_poll_adjust_delay(&g_upper_layer, PAL_I2C_POLL_INTERVAL_US) == PAL_I2C_POLL_INTERVAL_US);
+
+    /* only the first timer after the busy poll */
+    poll_state(STATE_BUSY, 0);
+    TEST_CHECK(is_predicted(pal_i2c_poll_adjust_delay(&g_upper_layer, PAL_I2C_POLL_INTERVAL_US)));
+    TEST_CHECK(pal_i2c_poll_adjust_delay(&g_upper_layer, PAL_I2C_POLL_INTERVAL_US) == PAL_I2C_POLL_INTERVAL_US);
+    respond();
+    g_time_us += 100000;
+}
+
+static void test_nacked_poll(void)
+{
+    pal_i2c_poll_stats_t before;
+    pal_i2c_poll_stats_t after;
+    uint8_t address = STATE_REG;
+    uint32_t start_us = g_time_us;
+
+    send_command(COMMAND_SIGN, 40);
+    acknowledge();
+    g_time_us = start_us + 1000;
+
+    /* OPTIGA NACKs the status register address while it executes the command */
+    pal_i2c_poll_get_stats(&before);
+    pal_i2c_poll_observe(&g_i2c, 0, 1, &address, 1);
+    TEST_CHECK(is_predicted(pal_i2c_poll_adjust_delay(&g_upper_layer, PAL_I2C_POLL_INTERVAL_US)));
+    pal_i2c_poll_get_stats(&after);
+    TEST_CHECK(after.polls == before.polls + 1);
+    TEST_CHECK(after.early_polls == before.early_polls + 1);
+    respond();
+}
+
+int main(void)
+{
+    TEST_RUN(test_prediction);
+    TEST_RUN(test_unknown_commands);
+    TEST_RUN(test_other_timers);
+    TEST_RUN(test_nacked_poll);
+    return TEST_RESULT("test_i2c_poll");
+}
@@ -0,0 +1,212 @@
+/**
+ * \file
+ *
+ * \brief Host tests of the conversion of the OPTIGA signatures to the raw r||s format of PSA
+ * (optiga_psa_signature_to_raw): SEQUENCE header, sign padding, short coordinates and malformed encodings.
+ */
+#include <string.h>
+
+#include "test.h"
+#include "optiga_psa_driver.h"
+#include "optiga_cache.h"
+#include "optiga_ecdhe_pool.h"
+
+#define P256_SIZE   32
+#define P384_SIZE   48
+
+/*********************************************************************************************************************
+ * Services of the driver entry points, not reached by the conversion
+ *********************************************************************************************************************/
+optiga_lib_status_t optiga_cache_read_data(uint16_t optiga_oid, uint16_t offset, uint8_t * buffer, uint16_t * length)
+{
+    (void)optiga_oid;
+    (void)offset;
+    (void)buffer;
+    (void)length;
+    return OPTIGA_LIB_ERROR;
+}
+
+optiga_lib_status_t optiga_ecdhe_pool_acquire(optiga_key_id_t * p_key_id, uint16_t * p_lease, uint8_t * public_key,
+                                              uint16_t * public_key_length)
+{
+    (void)p_key_id;
+    (void)p_lease;
+    (void)public_key;
+    (void)public_key_length;
+    return OPTIGA_LIB_ERROR;
+}
+
+void optiga_ecdhe_pool_release(optiga_key_id_t key_id, uint16_t lease)
+{
+    (void)key_id;
+    (void)lease;
+}
+
+optiga_lib_status_t optiga_crypt_ecdsa_sign(uint8_t * digest, uint8_t digest_length, optiga_key_id_t private_key,
+                                            uint8_t * signature, uint16_t * signature_length)
+{
+    (void)digest;
+    (void)digest_length;
+    (void)private_key;
+    (void)signature;
+    (void)signature_length;
+    return OPTIGA_LIB_ERROR;
+}
+
+optiga_lib_status_t optiga_crypt_ecdh(optiga_key_id_t private_key, public_key_from_host_t * public_key,
+                                      bool_t export_to_host, uint8_t * shared_secret)
+{
+    (void)private_key;
+    (void)public_key;
+    (void)export_to_host;
+    (void)shared_secret;
+    return OPTIGA_LIB_ERROR;
+}
+
+psa_key_type_t psa_get_key_type(const psa_key_attributes_t * attributes)
+{
+    return attributes->type;
+}
+
+size_t psa_get_key_bits(const psa_key_attributes_t * attributes)
+{
+    return attributes->bits;
+}
+
+void psa_set_key_type(psa_key_attributes_t * attributes, psa_key_type_t type)
+{
+    attributes->type = type;
+}
+
+void psa_set_key_bits(psa_key_attributes_t * attributes, size_t bits)
+{
+    attributes->bits = bits;
+}
+
+void psa_set_key_lifetime(psa_key_attributes_t * attributes, psa_key_lifetime_t lifetime)
+{
+    attributes->lifetime = lifetime;
+}
+
+void psa_set_key_usage_flags(psa_key_attributes_t * attributes, psa_key_usage_t usage_flags)
+{
+    (void)attributes;
+    (void)usage_flags;
+}
+
+void psa_set_key_algorithm(psa_key_attributes_t * attributes, psa_algorithm_t alg)
+{
+    (void)attributes;
+    (void)alg;
+}
+
+/*********************************************************************************************************************
+ * Encoding helpers
+ *********************************************************************************************************************/
+/* appends an INTEGER of length bytes of value, preceded by padding zero bytes */
+static uint16_t put_integer(uint8_t * p_der, uint8_t padding, uint8_t length, uint8_t value)
+{
+    p_der[0] = 0x02;
+    p_der[1] = (uint8_t)(padding + length);
+    memset(&p_der[2], 0, padding);
+    memset(&p_der[2 + padding], value, length);
+    return (uint16_t)(2 + padding + length);
+}
+
+static uint8_t is_filled(const uint8_t * p_data, uint8_t length, uint8_t value)
+{
+    uint8_t i;
+
+    for (i = 0; i < length; i++) {
+        if (p_data[i] != value) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*********************************************************************************************************************
+ * Tests
+ *********************************************************************************************************************/
+static void test_integer_pair(void)
+{
+    uint8_t der[2 * (2 + P256_SIZE)];
+    uint8_t raw[2 * P256_SIZE];
+    uint16_t length;
+
+    length = put_integer(der, 0, P256_SIZE, 0x11);
+    length += put_integer(&der[length], 0, P256_SIZE, 0x22);
+    TEST_CHECK(optiga_psa_signature_to_raw(der, length, P256_SIZE, raw) == PSA_SUCCESS);
+    TEST_CHECK(is_filled(raw, P256_SIZE, 0x11));
+    TEST_CHECK(is_filled(&raw[P256_SIZE], P256_SIZE, 0x22));
+}
+
+static void test_sequence_header(void)
+{
+    uint8_t der[2 + 2 * (2 + P256_SIZE)];
+    uint8_t raw[2 * P256_SIZE];
+    uint16_t length = 2;
+
+    length += put_integer(&der[length], 0, P256_SIZE, 0x33);
+    length += put_integer(&der[length], 0, P256_SIZE, 0x44);
+    der[0] = 0x30;
+    der[1] = (uint8_t)(length - 2);
+    TEST_CHECK(optiga_psa_signature_to_raw(der, length, P256_SIZE, raw) == PSA_SUCCESS);
+    TEST_CHECK(is_filled(raw, P256_SIZE, 0x33));
+    TEST_CHECK(is_filled(&raw[P256_SIZE], P256_SIZE, 0x44));
+}
+
+static void test_sign_padding_and_short_coordinates(void)
+{
+    uint8_t der[2 * (3 + P384_SIZE)];
+    uint8_t raw[2 * P384_SIZE];
+    uint16_t length;
+
+    /* r with the high bit set carries a zero byte, s has leading zero bytes dropped by the encoding */
+    length = put_integer(der, 1, P256_SIZE, 0x81);
+    length += put_integer(&der[length], 0, P256_SIZE - 3, 0x55);
+    TEST_CHECK(optiga_psa_signature_to_raw(der, length, P256_SIZE, raw) == PSA_SUCCESS);
+    TEST_CHECK(is_filled(raw, P256_SIZE, 0x81));
+    TEST_CHECK(is_filled(&raw[P256_SIZE], 3, 0x00));
+    TEST_CHECK(is_filled(&raw[P256_SIZE + 3], P256_SIZE - 3, 0x55));
+
+    length = put_integer(der, 0, 1, 0x01);
+    length += put_integer(&der[length], 1, P384_SIZE, 0xF0);
+    TEST_CHECK(optiga_psa_signature_to_raw(der, length, P384_SIZE, raw) == PSA_SUCCESS);
+    TEST_CHECK(is_filled(raw, P384_SIZE - 1, 0x00));
+    TEST_CHECK(raw[P384_SIZE - 1] == 0x01);
+    TEST_CHECK(is_filled(&raw[P384_SIZE], P384_SIZE, 0xF0));
+}
+
+static void test_malformed_signatures(void)
+{
+    uint8_t der[2 * (3 + P256_SIZE)];
+    uint8_t raw[2 * P256_SIZE];
+    uint16_t length;
+
+    /* wrong tag of s */
+    length = put_integer(der, 0, P256_SIZE, 0x11);
+    length += put_integer(&der[length], 0, P256_SIZE, 0x22);
+    der[2 + P256_SIZE] = 0x04;
+    TEST_CHECK(optiga_psa_signature_to_raw(der, length, P256_SIZE, raw) == PSA_ERROR_HARDWARE_FAILURE);
+
+    /* s truncated, or missing */
+    der[2 + P256_SIZE] = 0x02;
+    TEST_CHECK(optiga_psa_signature_to_raw(der, length - 1, P256_SIZE, raw) == PSA_ERROR_HARDWARE_FAILURE);
+    TEST_CHECK(optiga_psa_signature_to_raw(der, 2 + P256_SIZE, P256_SIZE, raw) == PSA_ERROR_HARDWARE_FAILURE);
+    TEST_CHECK(optiga_psa_signature_to_raw(der, 0, P256_SIZE, raw) == PSA_ERROR_HARDWARE_FAILURE);
+
+    /* r longer than the coordinate without being padding */
+    length = put_integer(der, 0, P256_SIZE + 1, 0x11);
+    length += put_integer(&der[length], 0, P256_SIZE, 0x22);
+    TEST_CHECK(optiga_psa_signature_to_raw(der, length, P256_SIZE, raw) == PSA_ERROR_HARDWARE_FAILURE);
+}
+
+int main(void)
+{
+    TEST_RUN(test_integer_pair);
+    TEST_RUN(test_sequence_header);
+    TEST_RUN(test_sign_padding_and_short_coordinates);
+    TEST_RUN(test_malformed_signatures);
+    return TEST_RESULT("test_psa_signature");
+}
@@ -0,0 +1,323 @@
+/**
+ * \file
+ *
+ * \brief Host tests of the cost model of the router (optiga_router.c): the joint fit of base and unit cost, the
+ * engine selection around the crossover, the probes and the failure penalty. The SHA-256 engines of the test advance
+ * a simulated clock by a linear cost.
+ */
+#include <string.h>
+
+#include "test.h"
+#include "optiga_router.h"
+#include "optiga_rng_pool.h"
+
+#include "psa/crypto.h"
+#include <trustx/optiga/include/optiga/pal/pal_os_timer.h>
+
+/* simulated costs of the SHA-256 engines in microseconds: base + unit * (length / 256) */
+#define HOST_BASE_US        200
+#define HOST_UNIT_US        400
+#define OPTIGA_BASE_US      5000
+#define OPTIGA_UNIT_US      10
+
+#define UNIT                OPTIGA_ROUTER_COST_UNIT_SIZE
+
+static uint32_t g_time_us;
+static psa_status_t g_host_status;
+
+/*********************************************************************************************************************
+ * Engines and clock
+ *********************************************************************************************************************/
+uint32_t pal_os_timer_get_time_in_microseconds(void)
+{
+    return g_time_us;
+}
+
+psa_status_t psa_hash_compute(psa_algorithm_t alg, const uint8_t * input, size_t input_length, uint8_t * hash,
+                              size_t hash_size, size_t * hash_length)
+{
+    (void)alg;
+    (void)input;
+    (void)hash;
+    (void)hash_size;
+    g_time_us += HOST_BASE_US + HOST_UNIT_US * (uint32_t)(input_length / UNIT);
+    *hash_length = 32;
+    return g_host_status;
+}
+
+optiga_lib_status_t optiga_crypt_hash_start(optiga_hash_context_t * hash_ctx)
+{
+    (void)hash_ctx;
+    g_time_us += OPTIGA_BASE_US;
+    return OPTIGA_LIB_SUCCESS;
+}
+
+optiga_lib_status_t optiga_crypt_hash_update(optiga_hash_context_t * hash_ctx, uint8_t source_of_data_to_hash,
+                                             void * data_to_hash)
+{
+    (void)hash_ctx;
+    (void)source_of_data_to_hash;
+    g_time_us += OPTIGA_UNIT_US * (((hash_data_from_host_t *)data_to_hash)->length / UNIT);
+    return OPTIGA_LIB_SUCCESS;
+}
+
+optiga_lib_status_t optiga_crypt_hash_finalize(optiga_hash_context_t * hash_ctx, uint8_t * hash_output)
+{
+    (void)hash_ctx;
+    (void)hash_output;
+    return OPTIGA_LIB_SUCCESS;
+}
+
+/*********************************************************************************************************************
+ * Services of the other operations, not reached by the tests
+ *********************************************************************************************************************/
+optiga_lib_status_t optiga_crypt_ecdsa_verify(uint8_t * digest, uint8_t digest_length, uint8_t * signature,
+                                              uint16_t signature_length, uint8_t public_key_source_type,
+                                              void * public_key)
+{
+    (void)digest;
+    (void)digest_length;
+    (void)signature;
+    (void)signature_length;
+    (void)public_key_source_type;
+    (void)public_key;
+    return OPTIGA_LIB_ERROR;
+}
+
+optiga_lib_status_t optiga_util_read_data(uint16_t optiga_oid, uint16_t offset, uint8_t * buffer, uint16_t * length)
+{
+    (void)optiga_oid;
+    (void)offset;
+    (void)buffer;
+    (void)length;
+    return OPTIGA_LIB_ERROR;
+}
+
+optiga_lib_status_t optiga_rng_pool_get(uint8_t * random_data, uint16_t random_data_length)
+{
+    (void)random_data;
+    (void)random_data_length;
+    return OPTIGA_LIB_ERROR;
+}
+
+psa_status_t psa_generate_random(uint8_t * output, size_t output_size)
+{
+    (void)output;
+    (void)output_size;
+    return PSA_ERROR_NOT_SUPPORTED;
+}
+
+void psa_set_key_type(psa_key_attributes_t * attributes, psa_key_type_t type)
+{
+    attributes->type = type;
+}
+
+void psa_set_key_bits(psa_key_attributes_t * attributes, size_t bits)
+{
+    attributes->bits = bits;
+}
+
+void psa_set_key_usage_flags(psa_key_attributes_t * attributes, psa_key_usage_t usage_flags)
+{
+    (void)attributes;
+    (void)usage_flags;
+}
+
+void psa_set_key_algorithm(psa_key_attributes_t * attributes, psa_algorithm_t alg)
+{
+    (void)attributes;
+    (void)alg;
+}
+
+psa_status_t psa_import_key(const psa_key_attributes_t * attributes, const uint8_t * data, size_t data_length,
+                            mbedtls_svc_key_id_t * key)
+{
+    (void)attributes;
+    (void)data;
+    (void)data_length;
+    (void)key;
+    return PSA_ERROR_NOT_SUPPORTED;
+}
+
+psa_status_t psa_verify_hash(mbedtls_svc_key_id_t key, psa_algorithm_t alg, const uint8_t * hash,
+                             size_t hash_length, const uint8_t * signature, size_t signature_length)
+{
+    (void)key;
+    (void)alg;
+    (void)hash;
+    (void)hash_length;
+    (void)signature;
+    (void)signature_length;
+    return PSA_ERROR_NOT_SUPPORTED;
+}
+
+psa_status_t psa_destroy_key(mbedtls_svc_key_id_t key)
+{
+    (void)key;
+    return PSA_ERROR_NOT_SUPPORTED;
+}
+
+/*********************************************************************************************************************
+ * Tests
+ *********************************************************************************************************************/
+static uint8_t g_data[32 * UNIT];
+
+static const optiga_router_engine_stats_t * sha256_engine(optiga_router_stats_t * p_stats,
+                                                          optiga_router_engine_t engine)
+{
+    optiga_router_get_stats(p_stats);
+    return &p_stats->engines[OPTIGA_ROUTER_OP_SHA256][engine];
+}
+
+/* hashes payloads of 0 to 15 units, plus a partial unit, on the engine the policy allows */
+static void train(uint8_t allowed, unsigned int rounds)
+{
+    uint8_t digest[32];
+    unsigned int i;
+
+    TEST_CHECK(optiga_router_set_policy(OPTIGA_ROUTER_OP_SHA256, allowed) == PAL_STATUS_SUCCESS);
+    for (i = 0; i < rounds; i++) {
+        TEST_CHECK(optiga_router_sha256(g_data, (i % 16) * UNIT + (i % 3) * 50, digest) == PAL_STATUS_SUCCESS);
+    }
+}
+
+static uint32_t distance(uint32_t value, uint32_t expected)
+{
+    return (value > expected) ? (value - expected) : (expected - value);
+}
+
+static void test_untried_engines_first(void)
+{
+    optiga_router_stats_t stats;
+    uint8_t digest[32];
+
+    optiga_router_init();
+    TEST_CHECK(optiga_router_select(OPTIGA_ROUTER_OP_SHA256, UNIT) == OPTIGA_ROUTER_ENGINE_OPTIGA);
+    TEST_CHECK(optiga_router_sha256(g_data, UNIT, digest) == PAL_STATUS_SUCCESS);
+    TEST_CHECK(optiga_router_select(OPTIGA_ROUTER_OP_SHA256, UNIT) == OPTIGA_ROUTER_ENGINE_HOST);
+    TEST_CHECK(optiga_router_sha256(g_data, UNIT, digest) == PAL_STATUS_SUCCESS);
+
+    /* a single sample is all base cost */
+    TEST_CHECK(sha256_engine(&stats, OPTIGA_ROUTER_ENGINE_OPTIGA)->base_cost_us == OPTIGA_BASE_US + OPTIGA_UNIT_US);
+    TEST_CHECK(sha256_engine(&stats, OPTIGA_ROUTER_ENGINE_HOST)->base_cost_us == HOST_BASE_US + HOST_UNIT_US);
+    TEST_CHECK(sha256_engine(&stats, OPTIGA_ROUTER_ENGINE_HOST)->unit_cost_us == 0);
+}
+
+static void test_constant_payload(void)
+{
+    optiga_router_stats_t stats;
+    uint8_t digest[32];
+    unsigned int i;
+
+    /* without variation of the payload size the whole cost is taken as base cost */
+    optiga_router_init();
+    TEST_CHECK(optiga_router_set_policy(OPTIGA_ROUTER_OP_SHA256, OPTIGA_ROUTER_ALLOW_HOST) == PAL_STATUS_SUCCESS);
+    for (i = 0; i < 50; i++) {
+        TEST_CHECK(optiga_router_sha256(g_data, 4 * UNIT, digest) == PAL_STATUS_SUCCESS);
+    }
+    TEST_CHECK(sha256_engine(&stats, OPTIGA_ROUTER_ENGINE_HOST)->base_cost_us == HOST_BASE_US + 4 * HOST_UNIT_US);
+    TEST_CHECK(stats.engines[OPTIGA_ROUTER_OP_SHA256][OPTIGA_ROUTER_ENGINE_HOST].unit_cost_us == 0);
+    TEST_CHECK(stats.engines[OPTIGA_ROUTER_OP_SHA256][OPTIGA_ROUTER_ENGINE_HOST].operations == 50);
+}
+
+static void test_joint_fit(void)
+{
+    const optiga_router_engine_stats_t * p_engine;
+    optiga_router_stats_t stats;
+
+    optiga_router_init();
+    train(OPTIGA_ROUTER_ALLOW_HOST, 200);
+    train(OPTIGA_ROUTER_ALLOW_OPTIGA, 200);
+
+    p_engine = sha256_engine(&stats, OPTIGA_ROUTER_ENGINE_HOST);
+    TEST_CHECK(distance(p_engine->base_cost_us, HOST_BASE_US) <= 2);
+    TEST_CHECK(distance(p_engine->unit_cost_us, HOST_UNIT_US) <= 1);
+    p_engine = sha256_engine(&stats, OPTIGA_ROUTER_ENGINE_OPTIGA);
+    TEST_CHECK(distance(p_engine->base_cost_us, OPTIGA_BASE_US) <= 2);
+    TEST_CHECK(distance(p_engine->unit_cost_us, OPTIGA_UNIT_US) <= 1);
+    TEST_CHECK(stats.optiga_outstanding == 0);
+}
+
+static void test_crossover(void)
+{
+    unsigned int optiga = 0;
+    unsigned int i;
+
+    /* the engines break even at about 12 units */
+    optiga_router_init();
+    train(OPTIGA_ROUTER_ALLOW_HOST, 200);
+    train(OPTIGA_ROUTER_ALLOW_OPTIGA, 200);
+    TEST_CHECK(optiga_router_set_policy(OPTIGA_ROUTER_OP_SHA256,
+                                        OPTIGA_ROUTER_ALLOW_OPTIGA | OPTIGA_ROUTER_ALLOW_HOST) == PAL_STATUS_SUCCESS);
+    TEST_CHECK(optiga_router_select(OPTIGA_ROUTER_OP_SHA256, 0) == OPTIGA_ROUTER_ENGINE_HOST);
+    TEST_CHECK(optiga_router_select(OPTIGA_ROUTER_OP_SHA256, 11 * UNIT) == OPTIGA_ROUTER_ENGINE_HOST);
+    TEST_CHECK(optiga_router_select(OPTIGA_ROUTER_OP_SHA256, 13 * UNIT) == OPTIGA_ROUTER_ENGINE_OPTIGA);
+    TEST_CHECK(optiga_router_select(OPTIGA_ROUTER_OP_SHA256, 32 * UNIT) == OPTIGA_ROUTER_ENGINE_OPTIGA);
+
+    /* one decision in OPTIGA_ROUTER_PROBE_INTERVAL goes to the slower engine */
+    optiga_router_init();
+    train(OPTIGA_ROUTER_ALLOW_HOST, 50);
+    train(OPTIGA_ROUTER_ALLOW_OPTIGA, 50);
+    TEST_CHECK(optiga_router_set_policy(OPTIGA_ROUTER_OP_SHA256,
+                                        OPTIGA_ROUTER_ALLOW_OPTIGA | OPTIGA_ROUTER_ALLOW_HOST) == PAL_STATUS_SUCCESS);
+    for (i = 1; i <= 2 * OPTIGA_ROUTER_PROBE_INTERVAL; i++) {
+        if (optiga_router_select(OPTIGA_ROUTER_OP_SHA256, 0) == OPTIGA_ROUTER_ENGINE_OPTIGA) {
+            optiga++;
+            TEST_CHECK((i % OPTIGA_ROUTER_PROBE_INTERVAL) == 0);
+        }
+    }
+    TEST_CHECK(optiga == 2);
+}
+
+static void test_failure_penalty(void)
+{
+    const optiga_router_engine_stats_t * p_engine;
+    optiga_router_stats_t stats;
+    uint8_t digest[32];
+
+    optiga_router_init();
+    train(OPTIGA_ROUTER_ALLOW_HOST, 50);
+    train(OPTIGA_ROUTER_ALLOW_OPTIGA, 50);
+    TEST_CHECK(optiga_router_set_policy(OPTIGA_ROUTER_OP_SHA256,
+                                        OPTIGA_ROUTER_ALLOW_OPTIGA | OPTIGA_ROUTER_ALLOW_HOST) == PAL_STATUS_SUCCESS);
+
+    /* a failure moves the traffic away from the host without touching its cost model */
+    g_host_status = PSA_ERROR_HARDWARE_FAILURE;
+    TEST_CHECK(optiga_router_sha256(g_data, UNIT, digest) == PAL_STATUS_FAILURE);
+    g_host_status = PSA_SUCCESS;
+    p_engine = sha256_engine(&stats, OPTIGA_ROUTER_ENGINE_HOST);
+    TEST_CHECK(p_engine->errors == 1);
+    TEST_CHECK(p_engine->penalty_us == OPTIGA_ROUTER_FAILURE_PENALTY_US);
+    TEST_CHECK(distance(p_engine->base_cost_us, HOST_BASE_US) <= 2);
+    TEST_CHECK(optiga_router_select(OPTIGA_ROUTER_OP_SHA256, 0) == OPTIGA_ROUTER_ENGINE_OPTIGA);
+
+    /* each success halves the penalty, until the host is the faster engine again */
+    train(OPTIGA_ROUTER_ALLOW_HOST, 1);
+    TEST_CHECK(sha256_engine(&stats, OPTIGA_ROUTER_ENGINE_HOST)->penalty_us == OPTIGA_ROUTER_FAILURE_PENALTY_US / 2);
+    train(OPTIGA_ROUTER_ALLOW_HOST, 5);
+    TEST_CHECK(sha256_engine(&stats, OPTIGA_ROUTER_ENGINE_HOST)->penalty_us == OPTIGA_ROUTER_FAILURE_PENALTY_US / 64);
+    TEST_CHECK(optiga_router_set_policy(OPTIGA_ROUTER_OP_SHA256,
+                                        OPTIGA_ROUTER_ALLOW_OPTIGA | OPTIGA_ROUTER_ALLOW_HOST) == PAL_STATUS_SUCCESS);
+    TEST_CHECK(optiga_router_select(OPTIGA_ROUTER_OP_SHA256, 0) == OPTIGA_ROUTER_ENGINE_HOST);
+}
+
+static void test_policy(void)
+{
+    optiga_router_init();
+    TEST_CHECK(optiga_router_set_policy(OPTIGA_ROUTER_OP_SHA256, 0) == PAL_STATUS_FAILURE);
+    TEST_CHECK(optiga_router_set_policy(OPTIGA_ROUTER_OP_COUNT, OPTIGA_ROUTER_ALLOW_HOST) == PAL_STATUS_FAILURE);
+    TEST_CHECK(optiga_router_set_policy(OPTIGA_ROUTER_OP_RANDOM, OPTIGA_ROUTER_ALLOW_HOST) == PAL_STATUS_SUCCESS);
+    TEST_CHECK(optiga_router_select(OPTIGA_ROUTER_OP_RANDOM, 16) == OPTIGA_ROUTER_ENGINE_HOST);
+    TEST_CHECK(optiga_router_select(OPTIGA_ROUTER_OP_COUNT, 16) == OPTIGA_ROUTER_ENGINE_OPTIGA);
+}
+
+int main(void)
+{
+    TEST_RUN(test_untried_engines_first);
+    TEST_RUN(test_constant_payload);
+    TEST_RUN(test_joint_fit);
+    TEST_RUN(test_crossover);
+    TEST_RUN(test_failure_penalty);
+    TEST_RUN(test_policy);
+    return TEST_RESULT("test_router");
+}